@@ -1,10 +1,12 @@
 #include "context_analysis.h"
 
+#include "precompiled_header.h"
 #include "symbol_table.h"
 
 #include "ctinfo.h"
 #include "dbug.h"
 #include "free.h"
+#include "location.h"
 #include "memory.h"
 #include "str.h"
 #include "traverse.h"
@@ -41,12 +43,21 @@ extern node *CAprogram(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("CAprogram");
 
-    node *symbol_table = TBmakeSymboltable(0, NULL, NULL);
+    node *symbol_table = TBmakeSymboltable(0, NULL, NULL, NULL);
 
     INFO_SYMBOL_TABLE(arg_info) = symbol_table;
-    PROGRAM_SYMBOLTABLE(arg_node) = symbol_table;
+    L_PROGRAM_SYMBOLTABLE(arg_node, symbol_table);
 
-    PROGRAM_DECLS(arg_node) = TRAVopt(PROGRAM_DECLS(arg_node), arg_info);
+    /* Precompiled headers come with their symbol table entries already. */
+    node *header_decls = PCHloadRequested(symbol_table);
+
+    L_PROGRAM_DECLS(arg_node, TRAVopt(PROGRAM_DECLS(arg_node), arg_info));
+
+    if (header_decls)
+    {
+        TBsplice(PROGRAM_DECLS(arg_node), 0, header_decls);
+        FREEdoFreeTree(header_decls);
+    }
 
     DBUG_RETURN(arg_node);
 }
@@ -56,7 +67,7 @@ node *CAglobdecl(node *arg_node, info *arg_info)
     DBUG_ENTER("CAglobdecl");
 
     node *symbol_table = INFO_SYMBOL_TABLE(arg_info);
-    node *entry = TBmakeSymboltableentry(STRcpy(GLOBDECL_NAME(arg_node)), GLOBDECL_TYPE(arg_node), arg_node, NULL, NULL);
+    node *entry = TBmakeSymboltableentry(GLOBDECL_NAME(arg_node), GLOBDECL_TYPE(arg_node), arg_node, NULL, NULL);
 
     SYMBOLTABLEENTRY_ISFUNCTION(entry) = FALSE;
     SYMBOLTABLEENTRY_ISEXPORT(entry) = FALSE;
@@ -72,7 +83,7 @@ node *CAglobdef(node *arg_node, info *arg_info)
     DBUG_ENTER("CAglobdef");
 
     node *symbol_table = INFO_SYMBOL_TABLE(arg_info);
-    node *entry = TBmakeSymboltableentry(STRcpy(GLOBDEF_NAME(arg_node)), GLOBDEF_TYPE(arg_node), arg_node, NULL, NULL);
+    node *entry = TBmakeSymboltableentry(GLOBDEF_NAME(arg_node), GLOBDEF_TYPE(arg_node), arg_node, NULL, NULL);
 
     SYMBOLTABLEENTRY_ISFUNCTION(entry) = FALSE;
     SYMBOLTABLEENTRY_ISEXPORT(entry) = FALSE;
@@ -88,16 +99,19 @@ node *CAparam(node *arg_node, info *arg_info)
     DBUG_ENTER("CAparam");
 
     node *symbol_table = INFO_SYMBOL_TABLE(arg_info);
-    node *entry = TBmakeSymboltableentry(STRcpy(PARAM_NAME(arg_node)), PARAM_TYPE(arg_node), arg_node, NULL, NULL);
 
-    SYMBOLTABLEENTRY_DEPTH(entry) = 1;
-    SYMBOLTABLEENTRY_ISFUNCTION(entry) = FALSE;
-    SYMBOLTABLEENTRY_ISEXPORT(entry) = FALSE;
-    SYMBOLTABLEENTRY_ISPARAMETER(entry) = TRUE;
+    // Parameter lists are walked in a loop rather than by recursion
+    for (node *param = arg_node; param != NULL; param = PARAM_NEXT(param))
+    {
+        node *entry = TBmakeSymboltableentry(PARAM_NAME(param), PARAM_TYPE(param), param, NULL, NULL);
 
-    STinsert(symbol_table, entry);
+        SYMBOLTABLEENTRY_DEPTH(entry) = 1;
+        SYMBOLTABLEENTRY_ISFUNCTION(entry) = FALSE;
+        SYMBOLTABLEENTRY_ISEXPORT(entry) = FALSE;
+        SYMBOLTABLEENTRY_ISPARAMETER(entry) = TRUE;
 
-    PARAM_NEXT(arg_node) = TRAVopt(PARAM_NEXT(arg_node), arg_info);
+        STinsert(symbol_table, entry);
+    }
 
     DBUG_RETURN(arg_node);
 }
@@ -109,12 +123,12 @@ node *CAfundecl(node *arg_node, info *arg_info)
     node *parent_table = INFO_SYMBOL_TABLE(arg_info);
 
     info *fundef_info = MakeInfo();
-    node *fundef_table = TBmakeSymboltable(SYMBOLTABLE_NESTINGLEVEL(parent_table) + 1, parent_table, NULL);
+    node *fundef_table = TBmakeSymboltable(SYMBOLTABLE_NESTINGLEVEL(parent_table) + 1, parent_table, NULL, NULL);
 
     INFO_SYMBOL_TABLE(fundef_info) = fundef_table;
     FUNDECL_SYMBOLTABLE(arg_node) = fundef_table;
 
-    node *entry = TBmakeSymboltableentry(STRcpy(FUNDECL_NAME(arg_node)), FUNDECL_TYPE(arg_node), arg_node, fundef_table, NULL);
+    node *entry = TBmakeSymboltableentry(FUNDECL_NAME(arg_node), FUNDECL_TYPE(arg_node), arg_node, fundef_table, NULL);
 
     SYMBOLTABLEENTRY_ISFUNCTION(entry) = TRUE;
     SYMBOLTABLEENTRY_ISEXPORT(entry) = FALSE;
@@ -122,7 +136,8 @@ node *CAfundecl(node *arg_node, info *arg_info)
 
     STinsert(parent_table, entry);
 
-    FUNDECL_PARAMS(arg_node) = TRAVopt(FUNDECL_PARAMS(arg_node), fundef_info);
+    L_FUNDECL_PARAMS(arg_node, TRAVopt(FUNDECL_PARAMS(arg_node), fundef_info));
+    STsign(entry);
     fundef_info = FreeInfo(fundef_info);
 
     DBUG_RETURN(arg_node);
@@ -135,12 +150,12 @@ node *CAfundef(node *arg_node, info *arg_info)
     node *parent_table = INFO_SYMBOL_TABLE(arg_info);
 
     info *fundef_info = MakeInfo();
-    node *fundef_table = TBmakeSymboltable(SYMBOLTABLE_NESTINGLEVEL(parent_table) + 1, parent_table, NULL);
+    node *fundef_table = TBmakeSymboltable(SYMBOLTABLE_NESTINGLEVEL(parent_table) + 1, parent_table, NULL, NULL);
 
     INFO_SYMBOL_TABLE(fundef_info) = fundef_table;
     FUNDEF_SYMBOLTABLE(arg_node) = fundef_table;
 
-    node *entry = TBmakeSymboltableentry(STRcpy(FUNDEF_NAME(arg_node)), FUNDEF_TYPE(arg_node), arg_node, fundef_table, NULL);
+    node *entry = TBmakeSymboltableentry(FUNDEF_NAME(arg_node), FUNDEF_TYPE(arg_node), arg_node, fundef_table, NULL);
 
     SYMBOLTABLEENTRY_ISFUNCTION(entry) = TRUE;
     SYMBOLTABLEENTRY_ISEXPORT(entry) = FUNDEF_ISEXPORT(arg_node);
@@ -148,8 +163,10 @@ node *CAfundef(node *arg_node, info *arg_info)
 
     STinsert(parent_table, entry);
 
-    FUNDEF_PARAMS(arg_node) = TRAVopt(FUNDEF_PARAMS(arg_node), fundef_info);
-    FUNDEF_FUNBODY(arg_node) = TRAVopt(FUNDEF_FUNBODY(arg_node), fundef_info);
+    L_FUNDEF_PARAMS(arg_node, TRAVopt(FUNDEF_PARAMS(arg_node), fundef_info));
+    STsign(entry);
+
+    L_FUNDEF_FUNBODY(arg_node, TRAVopt(FUNDEF_FUNBODY(arg_node), fundef_info));
 
     fundef_info = FreeInfo(fundef_info);
 
@@ -162,18 +179,20 @@ node *CAvardecl(node *arg_node, info *arg_info)
 
     node *symbol_table = INFO_SYMBOL_TABLE(arg_info);
 
-    VARDECL_INIT(arg_node) = TRAVopt(VARDECL_INIT(arg_node), arg_info);
-
-    node *entry = TBmakeSymboltableentry(STRcpy(VARDECL_NAME(arg_node)), VARDECL_TYPE(arg_node), arg_node, NULL, NULL);
+    // Declaration lists are walked in a loop rather than by recursion
+    for (node *vardecl = arg_node; vardecl != NULL; vardecl = VARDECL_NEXT(vardecl))
+    {
+        L_VARDECL_INIT(vardecl, TRAVopt(VARDECL_INIT(vardecl), arg_info));
 
-    SYMBOLTABLEENTRY_DEPTH(entry) = 1;
-    SYMBOLTABLEENTRY_ISFUNCTION(entry) = FALSE;
-    SYMBOLTABLEENTRY_ISEXPORT(entry) = FALSE;
-    SYMBOLTABLEENTRY_ISPARAMETER(entry) = FALSE;
+        node *entry = TBmakeSymboltableentry(VARDECL_NAME(vardecl), VARDECL_TYPE(vardecl), vardecl, NULL, NULL);
 
-    STinsert(symbol_table, entry);
+        SYMBOLTABLEENTRY_DEPTH(entry) = 1;
+        SYMBOLTABLEENTRY_ISFUNCTION(entry) = FALSE;
+        SYMBOLTABLEENTRY_ISEXPORT(entry) = FALSE;
+        SYMBOLTABLEENTRY_ISPARAMETER(entry) = FALSE;
 
-    VARDECL_NEXT(arg_node) = TRAVopt(VARDECL_NEXT(arg_node), arg_info);
+        STinsert(symbol_table, entry);
+    }
 
     DBUG_RETURN(arg_node);
 }
@@ -186,10 +205,11 @@ node *CAvarlet(node *arg_node, info *arg_info)
 
     if (!varlet_entry)
     {
-        CTIerrorLine(NODE_LINE(arg_node) + 1, "Undeclared var: %s\n", VAR_NAME(arg_node));
+        CTIerrorLine(LOCline(NODE_OFFSET(arg_node)), "Undeclared var: %s\n", VAR_NAME(arg_node));
     }
 
     VARLET_DECL(arg_node) = SYMBOLTABLEENTRY_DECLARATION(varlet_entry);
+    VARLET_ENTRY(arg_node) = varlet_entry;
 
     DBUG_RETURN(arg_node);
 }
@@ -202,11 +222,26 @@ node *CAvar(node *arg_node, info *arg_info)
 
     if (!var_entry)
     {
-        CTIerrorLine(NODE_LINE(arg_node) + 1, "Undeclared var: %s\n", VAR_NAME(arg_node));
+        CTIerrorLine(LOCline(NODE_OFFSET(arg_node)), "Undeclared var: %s\n", VAR_NAME(arg_node));
+    }
+
+    node *decl = SYMBOLTABLEENTRY_DECLARATION(var_entry);
+    node *table = INFO_SYMBOL_TABLE(arg_info);
+
+    /*
+     * A shared var is resolved in place as long as that holds for all its
+     * uses: FLVI makes it with its declaration, and it is only used within
+     * one function, so only the symbol table and entry are filled in.
+     * Anything else resolves a private copy.
+     */
+    if (TBisShared(arg_node) && (VAR_DECL(arg_node) != decl || (VAR_SYMBOLTABLE(arg_node) != NULL && VAR_SYMBOLTABLE(arg_node) != table)))
+    {
+        arg_node = TBunshare(arg_node);
     }
 
-    VAR_DECL(arg_node) = SYMBOLTABLEENTRY_DECLARATION(var_entry);
-    VAR_SYMBOLTABLE(arg_node) = INFO_SYMBOL_TABLE(arg_info);
+    VAR_DECL(arg_node) = decl;
+    VAR_SYMBOLTABLE(arg_node) = table;
+    VAR_ENTRY(arg_node) = var_entry;
 
     DBUG_RETURN(arg_node);
 }
@@ -1,10 +1,11 @@
 #include "for_loop_variable_initialisation.h"
 
-#include "copy.h"
 #include "ctinfo.h"
 #include "dbug.h"
 #include "free.h"
 #include "memory.h"
+#include "myglobals.h"
+#include "names.h"
 #include "str.h"
 #include "types.h"
 #include "tree_basic.h"
@@ -14,34 +15,46 @@ struct INFO
 {
     unsigned int for_loop_counter;
     node *induction_variables;
+    node *last_induction_variable;
 
     node *variable_declarations;
+    node *last_variable_declaration;
     node *statements;
 };
 
 #define INFO_FOR_LOOP_COUNTER(n) ((n)->for_loop_counter)
 #define INFO_INDUCTION_VARIABLES(n) ((n)->induction_variables)
+#define INFO_LAST_INDUCTION_VARIABLE(n) ((n)->last_induction_variable)
 
 #define INFO_VARDECLS(n) ((n)->variable_declarations)
+#define INFO_LAST_VARDECL(n) ((n)->last_variable_declaration)
 #define INFO_STATEMENTS(n) ((n)->statements)
 
-node *IVLadd(node *list, node *new_link)
+/*
+ * The variables and constants of the generated loop conditions and
+ * increments are the same in every use, so with -hashcons they are shared.
+ */
+#define MAKE_VAR(vardecl) \
+    (myglobal.hashcons ? TBshareVar(VARDECL_NAME(vardecl), vardecl, NULL) : TBmakeVar(VARDECL_NAME(vardecl), vardecl, NULL))
+#define MAKE_NUM(value) (myglobal.hashcons ? TBshareNum(value) : TBmakeNum(value))
+#define MAKE_BINOP(op, left, right) (myglobal.hashcons ? TBshareBinop(op, left, right) : TBmakeBinop(op, left, right))
+
+/**
+ * Appends to the list of induction variables after its last link, which
+ * the caller keeps, so an append does not walk the list.
+ */
+void IVLadd(node **list, node **last, node *new_link)
 {
-    if (list == NULL)
+    if (*list == NULL)
     {
-        list = new_link;
-        return list;
+        *list = new_link;
     }
-
-    node *cursor = list;
-    while (LINKEDVALUE_NEXT(cursor))
+    else
     {
-        cursor = LINKEDVALUE_NEXT(cursor);
+        L_LINKEDVALUE_NEXT(*last, new_link);
     }
 
-    LINKEDVALUE_NEXT(cursor) = new_link;
-
-    return list;
+    *last = new_link;
 }
 
 node *IVLfind(node *list, const char *old_name)
@@ -50,7 +63,7 @@ node *IVLfind(node *list, const char *old_name)
     node *cursor = list;
     while (cursor)
     {
-        if (STReq(LINKEDVALUE_KEY(cursor), old_name))
+        if (LINKEDVALUE_KEY(cursor) == old_name)
         {
             return cursor;
         }
@@ -70,8 +83,10 @@ static info *MakeInfo()
     result = (info *)MEMmalloc(sizeof(info));
 
     INFO_VARDECLS(result) = NULL;
+    INFO_LAST_VARDECL(result) = NULL;
     INFO_STATEMENTS(result) = NULL;
     INFO_INDUCTION_VARIABLES(result) = NULL;
+    INFO_LAST_INDUCTION_VARIABLE(result) = NULL;
     INFO_FOR_LOOP_COUNTER(result) = 0;
 
     DBUG_RETURN(result);
@@ -92,26 +107,16 @@ node *add_to_vardecls(node *decls, node *new_decl)
     {
         return new_decl;
     }
-    else
-    {
-        VARDECL_NEXT(decls) = add_to_vardecls(VARDECL_NEXT(decls), new_decl);
-    }
 
-    return decls;
-}
-
-node *add_to_stmts(node *stmts, node *new_stmt)
-{
-    if (!stmts)
-    {
-        return new_stmt;
-    }
-    else
+    node *last = decls;
+    while (VARDECL_NEXT(last))
     {
-        STMTS_NEXT(stmts) = add_to_stmts(STMTS_NEXT(stmts), new_stmt);
+        last = VARDECL_NEXT(last);
     }
 
-    return stmts;
+    L_VARDECL_NEXT(last, new_decl);
+
+    return decls;
 }
 
 node *FLVIfunbody(node *arg_node, info *arg_info)
@@ -120,13 +125,13 @@ node *FLVIfunbody(node *arg_node, info *arg_info)
 
     info *funbody_info = MakeInfo();
 
-    FUNBODY_STMTS(arg_node) = TRAVopt(FUNBODY_STMTS(arg_node), funbody_info);
+    L_FUNBODY_STMTS(arg_node, TRAVopt(FUNBODY_STMTS(arg_node), funbody_info));
 
     if (INFO_VARDECLS(funbody_info))
     {
         if (!FUNBODY_VARDECLS(arg_node))
         {
-            FUNBODY_VARDECLS(arg_node) = INFO_VARDECLS(funbody_info);
+            L_FUNBODY_VARDECLS(arg_node, INFO_VARDECLS(funbody_info));
         }
         else
         {
@@ -142,22 +147,23 @@ node *FLVIstmts(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("NFLstmts");
 
-    nodetype type = NODE_TYPE(STMTS_STMT(arg_node));
-
-    STMTS_STMT(arg_node) = TRAVdo(STMTS_STMT(arg_node), arg_info);
-
-    if (type == N_for)
+    for (int i = 0; i < STMTS_COUNT(arg_node); i++)
     {
-        node *oldnode = arg_node;
-        add_to_stmts(INFO_STATEMENTS(arg_info), arg_node);
-        arg_node = INFO_STATEMENTS(arg_info);
-        INFO_STATEMENTS(arg_info) = NULL;
+        nodetype type = NODE_TYPE(STMTS_STMT(arg_node, i));
 
-        STMTS_NEXT(oldnode) = TRAVopt(STMTS_NEXT(oldnode), arg_info);
-    }
-    else
-    {
-        STMTS_NEXT(arg_node) = TRAVopt(STMTS_NEXT(arg_node), arg_info);
+        L_STMTS_STMT(arg_node, i, TRAVdo(STMTS_STMT(arg_node, i), arg_info));
+
+        if (type == N_for)
+        {
+            // The initialisation statements go in front of the loop
+            node *statements = INFO_STATEMENTS(arg_info);
+            INFO_STATEMENTS(arg_info) = NULL;
+
+            int count = STMTS_COUNT(statements);
+            TBsplice(arg_node, i, statements);
+            FREEdoFreeTree(statements);
+            i += count;
+        }
     }
 
     DBUG_RETURN(arg_node);
@@ -168,15 +174,26 @@ node *FLVIfor(node *arg_node, info *arg_info)
     DBUG_ENTER("FLVIfor");
 
     // Generate a new induction variable base name
-    char *induction_basename = STRcatn(4, "_for_", STRitoa(INFO_FOR_LOOP_COUNTER(arg_info)), "_", FOR_LOOPVAR(arg_node));
+    char *counter = STRitoa(INFO_FOR_LOOP_COUNTER(arg_info));
+    char *basename = STRcatn(4, "_for_", counter, "_", FOR_LOOPVAR(arg_node));
+    char *step_name = STRcat(basename, "_step");
+    char *stop_name = STRcat(basename, "_stop");
     INFO_FOR_LOOP_COUNTER(arg_info)++;
 
-    INFO_INDUCTION_VARIABLES(arg_info) = IVLadd(INFO_INDUCTION_VARIABLES(arg_info), TBmakeLinkedvalue(FOR_LOOPVAR(arg_node), induction_basename, NULL));
+    char *induction_basename = NAMEintern(basename);
+
+    IVLadd(&INFO_INDUCTION_VARIABLES(arg_info), &INFO_LAST_INDUCTION_VARIABLE(arg_info),
+           TBmakeLinkedvalue(FOR_LOOPVAR(arg_node), induction_basename, NULL));
 
     // Create var decls for the for-loop
-    node *vardecl_step = TBmakeVardecl(STRcat(induction_basename, "_step"), T_int, NULL, NULL, NULL);
-    node *vardecl_stop = TBmakeVardecl(STRcat(induction_basename, "_stop"), T_int, NULL, NULL, vardecl_step);
-    node *vardecl_start = TBmakeVardecl(STRcpy(induction_basename), T_int, NULL, NULL, vardecl_stop);
+    node *vardecl_step = TBmakeVardecl(NAMEintern(step_name), T_int, NULL, NULL, NULL);
+    node *vardecl_stop = TBmakeVardecl(NAMEintern(stop_name), T_int, NULL, NULL, vardecl_step);
+    node *vardecl_start = TBmakeVardecl(induction_basename, T_int, NULL, NULL, vardecl_stop);
+
+    MEMfree(counter);
+    MEMfree(basename);
+    MEMfree(step_name);
+    MEMfree(stop_name);
 
     if (INFO_VARDECLS(arg_info) == NULL)
     {
@@ -184,46 +201,45 @@ node *FLVIfor(node *arg_node, info *arg_info)
     }
     else
     {
-        add_to_vardecls(INFO_VARDECLS(arg_info), vardecl_start);
+        L_VARDECL_NEXT(INFO_LAST_VARDECL(arg_info), vardecl_start);
     }
+    INFO_LAST_VARDECL(arg_info) = vardecl_step;
 
     // Create the for-loop's statements
-    FOR_BLOCK(arg_node) = TRAVopt(FOR_BLOCK(arg_node), arg_info);
+    L_FOR_BLOCK(arg_node, TRAVopt(FOR_BLOCK(arg_node), arg_info));
 
-    node *induction_step = TBmakeNum(1);
-    if (FOR_STEP(arg_node))
+    // The expressions and the block move out of the for-loop, which is freed below
+    node *induction_step = TBdetachSon(arg_node, FOR_STEP(arg_node));
+    if (!induction_step)
     {
-        induction_step = COPYdoCopy(FOR_STEP(arg_node));
+        induction_step = MAKE_NUM(1);
     }
 
-    node *induction_step_stmt = TBmakeStmts(TBmakeAssign(TBmakeVarlet(STRcpy(VARDECL_NAME(vardecl_step)), vardecl_step, NULL), induction_step), NULL);
-    node *stop_stmt = TBmakeStmts(TBmakeAssign(TBmakeVarlet(STRcpy(VARDECL_NAME(vardecl_stop)), vardecl_stop, NULL), COPYdoCopy(FOR_STOP(arg_node))), induction_step_stmt);
-    node *start_stmt = TBmakeStmts(TBmakeAssign(TBmakeVarlet(STRcpy(VARDECL_NAME(vardecl_start)), vardecl_start, NULL), COPYdoCopy(FOR_START(arg_node))), stop_stmt);
+    node *statements = TBmakeStmts();
+    TBappend(statements, TBmakeAssign(TBmakeVarlet(VARDECL_NAME(vardecl_start), vardecl_start, NULL), TBdetachSon(arg_node, FOR_START(arg_node))));
+    TBappend(statements, TBmakeAssign(TBmakeVarlet(VARDECL_NAME(vardecl_stop), vardecl_stop, NULL), TBdetachSon(arg_node, FOR_STOP(arg_node))));
+    TBappend(statements, TBmakeAssign(TBmakeVarlet(VARDECL_NAME(vardecl_step), vardecl_step, NULL), induction_step));
 
-    INFO_STATEMENTS(arg_info) = start_stmt;
+    INFO_STATEMENTS(arg_info) = statements;
 
-    node *block = COPYdoCopy(FOR_BLOCK(arg_node));
+    node *block = TBdetachSon(arg_node, FOR_BLOCK(arg_node));
 
-    node *assign = TBmakeAssign(TBmakeVarlet(STRcpy(VARDECL_NAME(vardecl_start)), vardecl_start, NULL),
-                                TBmakeBinop(BO_add, TBmakeVar(STRcpy(VARDECL_NAME(vardecl_start)), vardecl_start, NULL),
-                                            TBmakeVar(STRcpy(VARDECL_NAME(vardecl_step)), vardecl_step, NULL)));
+    node *assign = TBmakeAssign(TBmakeVarlet(VARDECL_NAME(vardecl_start), vardecl_start, NULL),
+                                MAKE_BINOP(BO_add, MAKE_VAR(vardecl_start), MAKE_VAR(vardecl_step)));
 
     if (!block)
     {
-        block = TBmakeStmts(assign, NULL);
-    }
-    else
-    {
-        add_to_stmts(block, TBmakeStmts(assign, NULL));
+        block = TBmakeStmts();
     }
+    TBappend(block, assign);
 
     FREEdoFreeTree(arg_node);
 
     // Create a new while loop and return it to replace the for-loop
     node *while_expr = TBmakeTernary(
-        TBmakeBinop(BO_gt, TBmakeVar(STRcpy(VARDECL_NAME(vardecl_step)), vardecl_step, NULL), TBmakeNum(0)),
-        TBmakeBinop(BO_lt, TBmakeVar(STRcpy(VARDECL_NAME(vardecl_start)), vardecl_start, NULL), TBmakeVar(STRcpy(VARDECL_NAME(vardecl_stop)), vardecl_stop, NULL)),
-        TBmakeBinop(BO_gt, TBmakeVar(STRcpy(VARDECL_NAME(vardecl_start)), vardecl_start, NULL), TBmakeVar(STRcpy(VARDECL_NAME(vardecl_stop)), vardecl_stop, NULL)));
+        MAKE_BINOP(BO_gt, MAKE_VAR(vardecl_step), MAKE_NUM(0)),
+        MAKE_BINOP(BO_lt, MAKE_VAR(vardecl_start), MAKE_VAR(vardecl_stop)),
+        MAKE_BINOP(BO_gt, MAKE_VAR(vardecl_start), MAKE_VAR(vardecl_stop)));
 
     DBUG_RETURN(TBmakeWhile(while_expr, block));
 }
@@ -236,7 +252,7 @@ node *FLVIvarlet(node *arg_node, info *arg_info)
 
     if (node)
     {
-        VARLET_NAME(arg_node) = STRcpy(LINKEDVALUE_VALUE(node));
+        VARLET_NAME(arg_node) = LINKEDVALUE_VALUE(node);
     }
 
     DBUG_RETURN(arg_node);
@@ -250,7 +266,8 @@ node *FLVIvar(node *arg_node, info *arg_info)
 
     if (node)
     {
-        VAR_NAME(arg_node) = STRcpy(LINKEDVALUE_VALUE(node));
+        arg_node = TBunshare(arg_node);
+        VAR_NAME(arg_node) = LINKEDVALUE_VALUE(node);
     }
 
     DBUG_RETURN(arg_node);
@@ -1,10 +1,12 @@
 #include "global_variable_initialisation.h"
 
 #include "ctinfo.h"
-#include "copy.h"
 #include "dbug.h"
 #include "free.h"
+#include "local_variable_initialisation.h"
 #include "memory.h"
+#include "myglobals.h"
+#include "names.h"
 #include "str.h"
 #include "symbol_table.h"
 #include "traverse.h"
@@ -14,11 +16,11 @@
 struct INFO
 {
     node *init_function;
-    node *last_statement;
+    node *statements;
 };
 
 #define INFO_INIT_FUNCTION(n) ((n)->init_function)
-#define INFO_LAST_STATEMENT(n) ((n)->last_statement)
+#define INFO_STATEMENTS(n) ((n)->statements)
 
 static info *MakeInfo(void)
 {
@@ -29,7 +31,7 @@ static info *MakeInfo(void)
     result = (info *)MEMmalloc(sizeof(info));
 
     INFO_INIT_FUNCTION(result) = NULL;
-    INFO_LAST_STATEMENT(result) = NULL;
+    INFO_STATEMENTS(result) = NULL;
 
     DBUG_RETURN(result);
 }
@@ -48,24 +50,27 @@ node *GVIprogram(node *arg_node, info *arg_info)
     DBUG_ENTER("GVIprogram");
 
     node *init_body = TBmakeFunbody(NULL, NULL, NULL);
-    node *init_function = TBmakeFundef(T_void, STRcpy("__init"), init_body, NULL);
-    node *init_symbol_table = TBmakeSymboltable(1, PROGRAM_SYMBOLTABLE(arg_node), NULL);
+    node *init_function = TBmakeFundef(T_void, NAMEintern("__init"), init_body, NULL);
+    node *init_symbol_table = TBmakeSymboltable(1, PROGRAM_SYMBOLTABLE(arg_node), NULL, NULL);
     
     INFO_INIT_FUNCTION(arg_info) = init_function;
-    node *entry = TBmakeSymboltableentry(STRcpy(FUNDEF_NAME(init_function)), FUNDEF_TYPE(init_function), arg_node, init_symbol_table, NULL);
+    node *entry = TBmakeSymboltableentry(FUNDEF_NAME(init_function), FUNDEF_TYPE(init_function), arg_node, init_symbol_table, NULL);
+
+    FUNDEF_SYMBOLTABLE(init_function) = init_symbol_table;
+    FUNDEF_ISEXPORT(init_function) = TRUE;
 
     SYMBOLTABLEENTRY_ISFUNCTION(entry) = TRUE;
     SYMBOLTABLEENTRY_ISEXPORT(entry) = FUNDEF_ISEXPORT(init_function);
     SYMBOLTABLEENTRY_ISPARAMETER(entry) = FALSE;
 
-    FUNDEF_SYMBOLTABLE(init_function) = init_symbol_table;
-    FUNDEF_ISEXPORT(init_function) = TRUE;
+    STsign(entry);
 
     node *declarations = TRAVdo(PROGRAM_DECLS(arg_node), arg_info);
 
-    if (INFO_LAST_STATEMENT(arg_info))
+    if (INFO_STATEMENTS(arg_info))
     {
-        PROGRAM_DECLS(arg_node) = TBmakeDecls(init_function, declarations);
+        L_PROGRAM_DECLS(arg_node, TBsplice(TBappend(TBmakeDecls(), init_function), 1, declarations));
+        FREEdoFreeTree(declarations);
     }
     else
     {
@@ -81,42 +86,35 @@ node *GVIglobdef(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("GVIglobdef");
 
-    node *globdef_init = GLOBDEF_INIT(arg_node);
-    globdef_init = TRAVopt(globdef_init, arg_info);
+    // The initialisation moves into the init function
+    node *globdef_init = TRAVopt(TBdetachSon(arg_node, GLOBDEF_INIT(arg_node)), arg_info);
 
     if (globdef_init)
     {
         node *init_function = INFO_INIT_FUNCTION(arg_info);
 
-        node *globdef_varlet = TBmakeVarlet(STRcpy(GLOBDEF_NAME(arg_node)), arg_node, NULL);
-        node *globdef_assign = TBmakeAssign(globdef_varlet, COPYdoCopy(globdef_init));
-
-        node *new_statement = TBmakeStmts(globdef_assign, NULL);
+        node *globdef_varlet = TBmakeVarlet(GLOBDEF_NAME(arg_node), arg_node, NULL);
+        node *globdef_assign = TBmakeAssign(globdef_varlet, globdef_init);
 
-        node *last_statement = INFO_LAST_STATEMENT(arg_info);
-        if (!last_statement)
-        {
-            FUNBODY_STMTS(FUNDEF_FUNBODY(init_function)) = new_statement;
-        }
-        else
+        if (!INFO_STATEMENTS(arg_info))
         {
-            STMTS_NEXT(last_statement) = new_statement;
+            INFO_STATEMENTS(arg_info) = TBmakeStmts();
+            L_FUNBODY_STMTS(FUNDEF_FUNBODY(init_function), INFO_STATEMENTS(arg_info));
         }
 
-        INFO_LAST_STATEMENT(arg_info) = new_statement;
-        GLOBDEF_INIT(arg_node) = NULL;
+        TBappend(INFO_STATEMENTS(arg_info), globdef_assign);
     }
 
     DBUG_RETURN(arg_node);
 }
 
-node *GVIinitializeGlobalVariables(node *syntaxtree)
+static node *InitializeGlobalVariables(node *syntaxtree, trav_t traversal)
 {
-    DBUG_ENTER("GVIinitializeGlobalVariables");
+    DBUG_ENTER("InitializeGlobalVariables");
 
     info *info = MakeInfo();
 
-    TRAVpush(TR_gvi);
+    TRAVpush(traversal);
     syntaxtree = TRAVdo(syntaxtree, info);
     TRAVpop();
 
@@ -124,3 +122,33 @@ node *GVIinitializeGlobalVariables(node *syntaxtree)
 
     DBUG_RETURN(syntaxtree);
 }
+
+node *GVIinitializeGlobalVariables(node *syntaxtree)
+{
+    DBUG_ENTER("GVIinitializeGlobalVariables");
+
+    syntaxtree = InitializeGlobalVariables(syntaxtree, TR_gvi);
+
+    DBUG_RETURN(syntaxtree);
+}
+
+/**
+ * Runs GVI and LVI one after the other, or with -traversals=fused in a
+ * single walk of the fused traversal VI.
+ */
+node *GVIinitializeVariables(node *syntaxtree)
+{
+    DBUG_ENTER("GVIinitializeVariables");
+
+    if (myglobal.fuse_traversals)
+    {
+        syntaxtree = InitializeGlobalVariables(syntaxtree, TR_vi);
+    }
+    else
+    {
+        syntaxtree = GVIinitializeGlobalVariables(syntaxtree);
+        syntaxtree = LVIinitializeLocalVariables(syntaxtree);
+    }
+
+    DBUG_RETURN(syntaxtree);
+}
@@ -7,5 +7,6 @@ extern node *GVIprogram(node *arg_node, info *arg_info);
 extern node *GVIglobdef(node *arg_node, info *arg_info);
 
 extern node *GVIinitializeGlobalVariables(node *syntaxtree);
+extern node *GVIinitializeVariables(node *syntaxtree);
 
 #endif
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "local_variable_initialisation.h"
 
-#include "copy.h"
 #include "ctinfo.h"
 #include "dbug.h"
 #include "free.h"
@@ -12,17 +11,15 @@
 #include "traverse.h"
 
 /**
- * Information structure to track the first and last statements
- * in a given code block or function body
+ * Information structure to collect the initialisation statements
+ * of a function body
  */
 struct INFO
 {
-    node *first_statement;
-    node *last_statement;
+    node *statements;
 };
 
-#define INFO_FIRST_STATEMENT(n) ((n)->first_statement)
-#define INFO_LAST_STATEMENT(n) ((n)->last_statement)
+#define INFO_STATEMENTS(n) ((n)->statements)
 
 static info *MakeInfo(void)
 {
@@ -32,8 +29,7 @@ static info *MakeInfo(void)
 
     result = (info *)MEMmalloc(sizeof(info));
 
-    INFO_LAST_STATEMENT(result) = NULL;
-    INFO_FIRST_STATEMENT(result) = NULL;
+    INFO_STATEMENTS(result) = NULL;
 
     DBUG_RETURN(result);
 }
@@ -60,11 +56,18 @@ node *LVIfunbody(node *arg_node, info *arg_info)
     // Traverse variable declarations inside the function body
     TRAVopt(FUNBODY_VARDECLS(arg_node), funbody_info);
 
-    // If there's a last statement in the funbody_info, update the statement pointers
-    if (INFO_LAST_STATEMENT(funbody_info))
+    // Put the initialisation statements in front of the body
+    if (INFO_STATEMENTS(funbody_info))
     {
-        STMTS_NEXT(INFO_LAST_STATEMENT(funbody_info)) = FUNBODY_STMTS(arg_node);
-        FUNBODY_STMTS(arg_node) = INFO_FIRST_STATEMENT(funbody_info);
+        if (FUNBODY_STMTS(arg_node))
+        {
+            TBsplice(FUNBODY_STMTS(arg_node), 0, INFO_STATEMENTS(funbody_info));
+            FREEdoFreeTree(INFO_STATEMENTS(funbody_info));
+        }
+        else
+        {
+            L_FUNBODY_STMTS(arg_node, INFO_STATEMENTS(funbody_info));
+        }
     }
 
     funbody_info = FreeInfo(funbody_info);
@@ -80,41 +83,26 @@ node *LVIvardecl(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("LVIvardecl");
 
-    node *vardecl_init = VARDECL_INIT(arg_node);
-
-    // If no variable initialization is found, continue traversing to next declaration
-    if (!vardecl_init)
-    {
-        VARDECL_NEXT(arg_node) = TRAVopt(VARDECL_NEXT(arg_node), arg_info);
-        DBUG_RETURN(arg_node);
-    }
-
-    // Create a new assignment node to assign the initialization value to the variable
-    node *vardecl_varlet = TBmakeVarlet(STRcpy(VARDECL_NAME(arg_node)), arg_node, NULL);
-    node *vardecl_assign = TBmakeAssign(vardecl_varlet, COPYdoCopy(vardecl_init));
-
-    // Free the memory of the initial value as it's no longer needed
-    // and set the initialization of variable declaration to NULL
-    FREEdoFreeTree(vardecl_init);
-    VARDECL_INIT(arg_node) = NULL;
-
-    // Create a new statement node for the assignment
-    node *node = TBmakeStmts(vardecl_assign, NULL);
-
-    // Update the INFO structure fields to keep track of the statements
-    if (INFO_FIRST_STATEMENT(arg_info) == NULL)
+    // Walk the declarations in a loop, so long lists take no stack
+    for (node *vardecl = arg_node; vardecl != NULL; vardecl = VARDECL_NEXT(vardecl))
     {
-        INFO_FIRST_STATEMENT(arg_info) = node;
-        INFO_LAST_STATEMENT(arg_info) = node;
+        // If no variable initialization is found, continue with the next declaration
+        if (!VARDECL_INIT(vardecl))
+        {
+            continue;
+        }
+
+        // Move the initial value into an assignment to the variable
+        node *vardecl_varlet = TBmakeVarlet(VARDECL_NAME(vardecl), vardecl, NULL);
+        node *vardecl_assign = TBmakeAssign(vardecl_varlet, TBdetachSon(vardecl, VARDECL_INIT(vardecl)));
+
+        // Collect the assignment in the INFO structure
+        if (INFO_STATEMENTS(arg_info) == NULL)
+        {
+            INFO_STATEMENTS(arg_info) = TBmakeStmts();
+        }
+        TBappend(INFO_STATEMENTS(arg_info), vardecl_assign);
     }
-    else
-    {
-        STMTS_NEXT(INFO_LAST_STATEMENT(arg_info)) = node;
-        INFO_LAST_STATEMENT(arg_info) = node;
-    }
-
-    // Continue traversal for the next variable declaration
-    VARDECL_NEXT(arg_node) = TRAVopt(VARDECL_NEXT(arg_node), arg_info);
 
     DBUG_RETURN(arg_node);
 }
@@ -0,0 +1,733 @@
+/*
+ * Precompiled headers for headers that only declare external variables and
+ * functions, such as include/stdio.cvh.
+ *
+ * Compiling a header with -emit-pch <file> runs the analysis up to context
+ * analysis and then writes its GlobDecl and FunDecl nodes, together with
+ * what their symbol table entries hold, to <file> and stops.
+ *
+ * With -pch=use, when the built-in preprocessor includes a header next to
+ * which an up to date <header>.pch exists, it does not read the header but
+ * asks for the precompiled file instead. Context analysis maps the requested files and
+ * builds the declarations and symbol table entries directly, ahead of those
+ * of the program itself. Macros defined by a header are not recorded, so
+ * only headers without them should be precompiled.
+ *
+ * File layout, in host byte order:
+ *
+ *   header   magic "CPCH", version, modification time and size of the
+ *            header it was made from, number of record words, number of
+ *            name bytes
+ *   records  one per declaration, as 32-bit words:
+ *              GlobDecl: kind, type, name, dims
+ *              FunDecl:  kind, type, name, parameter count,
+ *                        then per parameter: type, name, dims
+ *            where dims is a count followed by that many names, and names
+ *            are offsets into the name area
+ *   names    NUL-terminated strings
+ *
+ * Symbol table offsets follow from the order of the records.
+ */
+
+#include "precompiled_header.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ctinfo.h"
+#include "dbug.h"
+#include "globals.h"
+#include "location.h"
+#include "memory.h"
+#include "myglobals.h"
+#include "names.h"
+#include "str.h"
+#include "symbol_table.h"
+#include "traverse.h"
+#include "tree_basic.h"
+
+#define PCH_VERSION 1
+
+typedef enum
+{
+    PCH_globdecl,
+    PCH_fundecl
+} pchkind;
+
+typedef struct PCH_HEADER
+{
+    char magic[4];
+    int32_t version;
+    int64_t source_mtime;
+    int64_t source_size;
+    int32_t record_words;
+    int32_t name_bytes;
+} pch_header;
+
+/*
+ * A precompiled header asked for by the preprocessor, to be loaded by
+ * context analysis.
+ */
+typedef struct REQUEST
+{
+    char *path;
+    struct REQUEST *next;
+} request;
+
+static request *requests = NULL;
+
+struct INFO
+{
+    int32_t *words;
+    int word_count;
+    int word_capacity;
+    char *names;
+    int name_size;
+    int name_capacity;
+};
+
+#define INFO_WORDS(n) ((n)->words)
+#define INFO_WORD_COUNT(n) ((n)->word_count)
+#define INFO_NAMES(n) ((n)->names)
+#define INFO_NAME_SIZE(n) ((n)->name_size)
+
+static info *MakeInfo(void)
+{
+    info *result;
+
+    DBUG_ENTER("MakeInfo");
+
+    result = (info *)MEMmalloc(sizeof(info));
+
+    result->word_capacity = 256;
+    result->name_capacity = 1024;
+    INFO_WORDS(result) = MEMmalloc(result->word_capacity * sizeof(int32_t));
+    INFO_WORD_COUNT(result) = 0;
+    INFO_NAMES(result) = MEMmalloc(result->name_capacity);
+
+    /* Starts the name area with an empty name, so it is never empty. */
+    INFO_NAMES(result)[0] = '\0';
+    INFO_NAME_SIZE(result) = 1;
+
+    DBUG_RETURN(result);
+}
+
+static info *FreeInfo(info *info)
+{
+    DBUG_ENTER("FreeInfo");
+
+    MEMfree(INFO_WORDS(info));
+    MEMfree(INFO_NAMES(info));
+    info = MEMfree(info);
+
+    DBUG_RETURN(info);
+}
+
+static void PutWord(info *arg_info, int32_t word)
+{
+    int32_t *grown;
+
+    if (arg_info->word_count == arg_info->word_capacity)
+    {
+        arg_info->word_capacity *= 2;
+        grown = MEMmalloc(arg_info->word_capacity * sizeof(int32_t));
+        memcpy(grown, arg_info->words, arg_info->word_count * sizeof(int32_t));
+        MEMfree(arg_info->words);
+        arg_info->words = grown;
+    }
+
+    arg_info->words[arg_info->word_count++] = word;
+}
+
+static void PutName(info *arg_info, const char *name)
+{
+    int length = (int)strlen(name) + 1;
+    char *grown;
+
+    PutWord(arg_info, arg_info->name_size);
+
+    if (arg_info->name_size + length > arg_info->name_capacity)
+    {
+        while (arg_info->name_size + length > arg_info->name_capacity)
+        {
+            arg_info->name_capacity *= 2;
+        }
+        grown = MEMmalloc(arg_info->name_capacity);
+        memcpy(grown, arg_info->names, arg_info->name_size);
+        MEMfree(arg_info->names);
+        arg_info->names = grown;
+    }
+
+    memcpy(arg_info->names + arg_info->name_size, name, length);
+    arg_info->name_size += length;
+}
+
+static void PutDims(info *arg_info, node *ids)
+{
+    node *id;
+    int count = 0;
+
+    for (id = ids; id != NULL; id = IDS_NEXT(id))
+    {
+        count++;
+    }
+
+    PutWord(arg_info, count);
+    for (id = ids; id != NULL; id = IDS_NEXT(id))
+    {
+        PutName(arg_info, IDS_NAME(id));
+    }
+}
+
+/**
+ * Writes the collected records, preceded by the file header, to the
+ * -emit-pch output file.
+ */
+static void WriteFile(info *arg_info)
+{
+    pch_header hdr;
+    struct stat st;
+    FILE *file;
+    bool ok;
+
+    memset(&hdr, 0, sizeof(pch_header));
+    memcpy(hdr.magic, "CPCH", 4);
+    hdr.version = PCH_VERSION;
+    if (stat(global.infile, &st) == 0)
+    {
+        hdr.source_mtime = (int64_t)st.st_mtime;
+        hdr.source_size = (int64_t)st.st_size;
+    }
+    hdr.record_words = INFO_WORD_COUNT(arg_info);
+    hdr.name_bytes = INFO_NAME_SIZE(arg_info);
+
+    file = fopen(myglobal.pch_output, "wb");
+    if (file == NULL)
+    {
+        CTIabort("Cannot write precompiled header %s", myglobal.pch_output);
+    }
+
+    ok = fwrite(&hdr, sizeof(pch_header), 1, file) == 1;
+    ok = ok && fwrite(INFO_WORDS(arg_info), sizeof(int32_t), INFO_WORD_COUNT(arg_info), file)
+                   == (size_t)INFO_WORD_COUNT(arg_info);
+    ok = ok && fwrite(INFO_NAMES(arg_info), 1, INFO_NAME_SIZE(arg_info), file)
+                   == (size_t)INFO_NAME_SIZE(arg_info);
+    ok = fclose(file) == 0 && ok;
+
+    if (!ok)
+    {
+        remove(myglobal.pch_output);
+        CTIabort("Cannot write precompiled header %s", myglobal.pch_output);
+    }
+}
+
+node *PCHprogram(node *arg_node, info *arg_info)
+{
+    DBUG_ENTER("PCHprogram");
+
+    L_PROGRAM_DECLS(arg_node, TRAVopt(PROGRAM_DECLS(arg_node), arg_info));
+
+    WriteFile(arg_info);
+
+    DBUG_RETURN(arg_node);
+}
+
+node *PCHglobdecl(node *arg_node, info *arg_info)
+{
+    DBUG_ENTER("PCHglobdecl");
+
+    PutWord(arg_info, PCH_globdecl);
+    PutWord(arg_info, GLOBDECL_TYPE(arg_node));
+    PutName(arg_info, GLOBDECL_NAME(arg_node));
+    PutDims(arg_info, GLOBDECL_DIMS(arg_node));
+
+    DBUG_RETURN(arg_node);
+}
+
+node *PCHglobdef(node *arg_node, info *arg_info)
+{
+    DBUG_ENTER("PCHglobdef");
+
+    CTIabortLine(LOCline(NODE_OFFSET(arg_node)),
+                 "Only declarations can be precompiled, '%s' is defined here",
+                 GLOBDEF_NAME(arg_node));
+
+    DBUG_RETURN(arg_node);
+}
+
+node *PCHfundecl(node *arg_node, info *arg_info)
+{
+    node *param;
+    int count = 0;
+
+    DBUG_ENTER("PCHfundecl");
+
+    for (param = FUNDECL_PARAMS(arg_node); param != NULL; param = PARAM_NEXT(param))
+    {
+        count++;
+    }
+
+    PutWord(arg_info, PCH_fundecl);
+    PutWord(arg_info, FUNDECL_TYPE(arg_node));
+    PutName(arg_info, FUNDECL_NAME(arg_node));
+    PutWord(arg_info, count);
+
+    for (param = FUNDECL_PARAMS(arg_node); param != NULL; param = PARAM_NEXT(param))
+    {
+        PutWord(arg_info, PARAM_TYPE(param));
+        PutName(arg_info, PARAM_NAME(param));
+        PutDims(arg_info, PARAM_DIMS(param));
+    }
+
+    DBUG_RETURN(arg_node);
+}
+
+node *PCHfundef(node *arg_node, info *arg_info)
+{
+    DBUG_ENTER("PCHfundef");
+
+    CTIabortLine(LOCline(NODE_OFFSET(arg_node)),
+                 "Only declarations can be precompiled, '%s' is defined here",
+                 FUNDEF_NAME(arg_node));
+
+    DBUG_RETURN(arg_node);
+}
+
+/**
+ * Writes the precompiled header requested with -emit-pch and stops the
+ * compiler after this subphase, as -b does; the header itself has no code
+ * to generate. Does nothing without -emit-pch.
+ */
+node *PCHdoEmit(node *syntaxtree)
+{
+    info *arg_info;
+
+    DBUG_ENTER("PCHdoEmit");
+
+    if (myglobal.pch_output == NULL)
+    {
+        DBUG_RETURN(syntaxtree);
+    }
+
+    arg_info = MakeInfo();
+
+    TRAVpush(TR_pch);
+    syntaxtree = TRAVdo(syntaxtree, arg_info);
+    TRAVpop();
+
+    arg_info = FreeInfo(arg_info);
+
+    global.break_after_subphase = global.compiler_subphase;
+
+    DBUG_RETURN(syntaxtree);
+}
+
+/**
+ * Reads the file header of a precompiled header.
+ *
+ * @return TRUE if the file starts with a header of the current version.
+ */
+static bool ReadHeader(const char *path, pch_header *hdr)
+{
+    FILE *file;
+    bool ok;
+
+    file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return FALSE;
+    }
+
+    ok = fread(hdr, sizeof(pch_header), 1, file) == 1
+         && memcmp(hdr->magic, "CPCH", 4) == 0
+         && hdr->version == PCH_VERSION;
+    fclose(file);
+
+    return ok;
+}
+
+/**
+ * Checks for an up to date precompiled version of an include file and, if
+ * there is one, records it for context analysis to load. Each precompiled
+ * header is loaded only once, however often it is included.
+ *
+ * @param header_path Path of the include file.
+ * @return TRUE if the precompiled header is used instead of the file.
+ */
+bool PCHuse(const char *header_path)
+{
+    pch_header hdr;
+    struct stat st;
+    request *req;
+    request **tail;
+    char *path;
+    char *real;
+
+    DBUG_ENTER("PCHuse");
+
+    path = STRcat(header_path, ".pch");
+
+    if (stat(header_path, &st) != 0 || !ReadHeader(path, &hdr)
+        || hdr.source_mtime != (int64_t)st.st_mtime
+        || hdr.source_size != (int64_t)st.st_size
+        || (real = realpath(path, NULL)) == NULL)
+    {
+        MEMfree(path);
+        DBUG_RETURN(FALSE);
+    }
+    MEMfree(path);
+
+    for (tail = &requests; *tail != NULL; tail = &(*tail)->next)
+    {
+        if (strcmp((*tail)->path, real) == 0)
+        {
+            free(real);
+            DBUG_RETURN(TRUE);
+        }
+    }
+
+    req = MEMmalloc(sizeof(request));
+    req->path = STRcpy(real);
+    req->next = NULL;
+    *tail = req;
+    free(real);
+
+    DBUG_RETURN(TRUE);
+}
+
+/*
+ * Position in the records of a mapped precompiled header.
+ */
+typedef struct READER
+{
+    const char *path;
+    const int32_t *words;
+    int count;
+    int pos;
+    const char *names;
+    int name_bytes;
+} reader;
+
+static void Corrupt(const reader *rd)
+{
+    CTIabort("%s: Corrupt precompiled header", rd->path);
+}
+
+static int32_t ReadWord(reader *rd)
+{
+    if (rd->pos >= rd->count)
+    {
+        Corrupt(rd);
+    }
+
+    return rd->words[rd->pos++];
+}
+
+static int ReadCount(reader *rd)
+{
+    int32_t count = ReadWord(rd);
+
+    if (count < 0 || count > rd->count - rd->pos)
+    {
+        Corrupt(rd);
+    }
+
+    return count;
+}
+
+static type ReadType(reader *rd)
+{
+    int32_t word = ReadWord(rd);
+
+    if (word < T_void || word >= T_unknown)
+    {
+        Corrupt(rd);
+    }
+
+    return (type)word;
+}
+
+static char *ReadName(reader *rd)
+{
+    int32_t offset = ReadWord(rd);
+
+    if (offset < 0 || offset >= rd->name_bytes)
+    {
+        Corrupt(rd);
+    }
+
+    return NAMEintern(rd->names + offset);
+}
+
+static node *ReadDims(reader *rd)
+{
+    node *dims = NULL;
+    node *last = NULL;
+    node *id;
+    int count = ReadCount(rd);
+
+    while (count-- > 0)
+    {
+        id = TBmakeIds(ReadName(rd), NULL);
+        if (last == NULL)
+        {
+            dims = id;
+        }
+        else
+        {
+            L_IDS_NEXT(last, id);
+        }
+        last = id;
+    }
+
+    return dims;
+}
+
+/**
+ * Builds a GlobDecl node and its symbol table entry from a record.
+ *
+ * @return The entry; its declaration is the new node.
+ */
+static node *LoadGlobdecl(reader *rd)
+{
+    node *decl;
+    node *entry;
+    type decl_type = ReadType(rd);
+    char *name = ReadName(rd);
+
+    decl = TBmakeGlobdecl(decl_type, name, ReadDims(rd));
+    entry = TBmakeSymboltableentry(name, decl_type, decl, NULL, NULL);
+
+    SYMBOLTABLEENTRY_ISFUNCTION(entry) = FALSE;
+    SYMBOLTABLEENTRY_ISEXPORT(entry) = FALSE;
+    SYMBOLTABLEENTRY_ISPARAMETER(entry) = FALSE;
+
+    return entry;
+}
+
+/**
+ * Builds a FunDecl node with its parameters, its symbol table and its entry
+ * in the given table from a record, as CAfundecl would.
+ *
+ * @return The entry; its declaration is the new node.
+ */
+static node *LoadFundecl(reader *rd, node *symbol_table)
+{
+    node *decl;
+    node *entry;
+    node *table;
+    node *params = NULL;
+    node *last_param = NULL;
+    node *last_entry = NULL;
+    node *param;
+    node *param_entry;
+    type decl_type = ReadType(rd);
+    char *name = ReadName(rd);
+    type param_type;
+    char *param_name;
+    int count = ReadCount(rd);
+    int i;
+
+    table = TBmakeSymboltable(SYMBOLTABLE_NESTINGLEVEL(symbol_table) + 1, symbol_table, NULL, NULL);
+
+    for (i = 0; i < count; i++)
+    {
+        param_type = ReadType(rd);
+        param_name = ReadName(rd);
+        param = TBmakeParam(param_name, param_type, ReadDims(rd), NULL);
+        param_entry = TBmakeSymboltableentry(param_name, param_type, param, NULL, NULL);
+
+        SYMBOLTABLEENTRY_OFFSET(param_entry) = i;
+        SYMBOLTABLEENTRY_DEPTH(param_entry) = 1;
+        SYMBOLTABLEENTRY_ISFUNCTION(param_entry) = FALSE;
+        SYMBOLTABLEENTRY_ISEXPORT(param_entry) = FALSE;
+        SYMBOLTABLEENTRY_ISPARAMETER(param_entry) = TRUE;
+
+        if (last_param == NULL)
+        {
+            params = param;
+            L_SYMBOLTABLE_ENTRIES(table, param_entry);
+        }
+        else
+        {
+            L_PARAM_NEXT(last_param, param);
+            L_SYMBOLTABLEENTRY_NEXT(last_entry, param_entry);
+        }
+        last_param = param;
+        last_entry = param_entry;
+    }
+
+    decl = TBmakeFundecl(decl_type, name, params);
+    FUNDECL_SYMBOLTABLE(decl) = table;
+
+    entry = TBmakeSymboltableentry(name, decl_type, decl, table, NULL);
+
+    SYMBOLTABLEENTRY_ISFUNCTION(entry) = TRUE;
+    SYMBOLTABLEENTRY_ISEXPORT(entry) = FALSE;
+    SYMBOLTABLEENTRY_ISPARAMETER(entry) = FALSE;
+
+    STsign(entry);
+
+    return entry;
+}
+
+/**
+ * Maps a precompiled header and adds its declarations to the symbol table
+ * and to decls. The offsets of the new entries continue those already in
+ * the table.
+ */
+static void LoadFile(const char *path, node *symbol_table, node *decls)
+{
+    pch_header hdr;
+    struct stat st;
+    reader rd;
+    void *base;
+    node *last = NULL;
+    node *entry;
+    bool check_duplicates;
+    int globdecls = 0;
+    int fundecls = 0;
+    int fd;
+
+    DBUG_ENTER("LoadFile");
+
+    rd.path = path;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        CTIabort("Cannot read precompiled header %s", path);
+    }
+
+    if (st.st_size < (off_t)sizeof(pch_header))
+    {
+        Corrupt(&rd);
+    }
+
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        CTIabort("Cannot read precompiled header %s", path);
+    }
+
+    memcpy(&hdr, base, sizeof(pch_header));
+    rd.words = (const int32_t *)((const char *)base + sizeof(pch_header));
+    rd.count = hdr.record_words;
+    rd.pos = 0;
+    rd.names = (const char *)(rd.words + hdr.record_words);
+    rd.name_bytes = hdr.name_bytes;
+
+    if (memcmp(hdr.magic, "CPCH", 4) != 0 || hdr.version != PCH_VERSION
+        || hdr.record_words < 0 || hdr.name_bytes < 1
+        || (off_t)sizeof(pch_header) + (off_t)hdr.record_words * 4 + hdr.name_bytes != st.st_size
+        || rd.names[rd.name_bytes - 1] != '\0')
+    {
+        Corrupt(&rd);
+    }
+
+    for (entry = SYMBOLTABLE_ENTRIES(symbol_table); entry != NULL; entry = SYMBOLTABLEENTRY_NEXT(entry))
+    {
+        if (NODE_TYPE(SYMBOLTABLEENTRY_DECLARATION(entry)) == N_globdecl)
+        {
+            globdecls++;
+        }
+        else if (NODE_TYPE(SYMBOLTABLEENTRY_DECLARATION(entry)) == N_fundecl)
+        {
+            fundecls++;
+        }
+        last = entry;
+    }
+
+    /* A single precompiled header was checked when it was made. */
+    check_duplicates = last != NULL;
+
+    while (rd.pos < rd.count)
+    {
+        switch (ReadWord(&rd))
+        {
+        case PCH_globdecl:
+            entry = LoadGlobdecl(&rd);
+            SYMBOLTABLEENTRY_OFFSET(entry) = globdecls;
+            break;
+        case PCH_fundecl:
+            entry = LoadFundecl(&rd, symbol_table);
+            SYMBOLTABLEENTRY_OFFSET(entry) = fundecls;
+            break;
+        default:
+            Corrupt(&rd);
+            entry = NULL;
+            break;
+        }
+
+        if (check_duplicates && STfind(symbol_table, SYMBOLTABLEENTRY_NAME(entry)) != NULL)
+        {
+            CTIerror("%s: Variable/Function '%s' is already defined.", path, SYMBOLTABLEENTRY_NAME(entry));
+            continue;
+        }
+
+        if (NODE_TYPE(SYMBOLTABLEENTRY_DECLARATION(entry)) == N_globdecl)
+        {
+            globdecls++;
+        }
+        else
+        {
+            fundecls++;
+        }
+
+        if (last == NULL)
+        {
+            L_SYMBOLTABLE_ENTRIES(symbol_table, entry);
+        }
+        else
+        {
+            L_SYMBOLTABLEENTRY_NEXT(last, entry);
+        }
+        last = entry;
+
+        TBappend(decls, SYMBOLTABLEENTRY_DECLARATION(entry));
+    }
+
+    munmap(base, st.st_size);
+
+    DBUG_VOID_RETURN;
+}
+
+/**
+ * Loads the precompiled headers the preprocessor asked for, in the order
+ * they were first included, into the program's symbol table.
+ *
+ * @param symbol_table The global symbol table.
+ * @return The Decls list of all loaded declarations, or NULL if no header
+ *         was requested.
+ */
+node *PCHloadRequested(node *symbol_table)
+{
+    node *decls = NULL;
+    request *req;
+
+    DBUG_ENTER("PCHloadRequested");
+
+    while ((req = requests) != NULL)
+    {
+        requests = req->next;
+
+        if (decls == NULL)
+        {
+            decls = TBmakeDecls();
+        }
+
+        LoadFile(req->path, symbol_table, decls);
+
+        MEMfree(req->path);
+        MEMfree(req);
+    }
+
+    DBUG_RETURN(decls);
+}
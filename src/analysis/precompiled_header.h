@@ -0,0 +1,17 @@
+#ifndef _PRECOMPILED_HEADER_H_
+#define _PRECOMPILED_HEADER_H_
+
+#include "types.h"
+
+extern node *PCHprogram(node *arg_node, info *arg_info);
+extern node *PCHglobdecl(node *arg_node, info *arg_info);
+extern node *PCHglobdef(node *arg_node, info *arg_info);
+extern node *PCHfundecl(node *arg_node, info *arg_info);
+extern node *PCHfundef(node *arg_node, info *arg_info);
+
+extern node *PCHdoEmit(node *syntaxtree);
+
+extern bool PCHuse(const char *header_path);
+extern node *PCHloadRequested(node *symbol_table);
+
+#endif
@@ -1,75 +1,473 @@
 #include "symbol_table.h"
 
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
 #include "ctinfo.h"
 #include "dbug.h"
+#include "helpers.h"
+#include "location.h"
 #include "memory.h"
-#include "str.h"
+#include "names.h"
 #include "types.h"
 #include "tree_basic.h"
 #include "traverse.h"
 
-/**
- * Counts the number of symbol table entries that match the given node type.
+/*
+ * Every symbol table has a hash index of its entries, so that the lookups
+ * below take constant time however many entries the table has. The Index
+ * attribute of a table is a handle into indexes, 0 while it has none; the
+ * index is made on first use. Two open-addressed hash tables with linear
+ * probing map an entry name, and the node type and name of a declaration,
+ * to the first entry with that key. The index also keeps the last entry,
+ * to which STinsert appends, and running counts of the entries per
+ * declaration type and of the parameters. These give the offset of a new
+ * entry and the results of STcountParams and STcountVarDecls without a
+ * walk of the chain.
+ *
+ * STinsert adds to the index. Entries appended to the chain directly, as
+ * by the precompiled header loader, are added on the next lookup, as the
+ * index remembers the last entry it holds. Entries are never removed.
+ * The indexes live as long as the tree: resetting the node arena calls
+ * STfreeIndexes, which frees them all.
+ *
+ * A copy or a snapshot of a table carries the handle of the original. As
+ * an index records its table, such a handle is not trusted and the table
+ * gets an index of its own.
  *
- * @param entry Start of the symbol table entry list.
- * @param node_type The node type to be matched against.
- * @return The count of symbol table entries of the specified type.
+ * Once context analysis and variable initialisation have made all entries,
+ * STdoFreeze freezes the tables with the FRZ traversal, which visits only
+ * the symbol tables: each index is caught up with its chain, rehashed into
+ * one block of the smallest size that keeps the load at most one half, and
+ * marked frozen. A lookup in a frozen table reads the index and the
+ * entries and writes nothing, so any number of threads may look up in
+ * frozen tables at the same time without locks, provided the DBUG macros
+ * are compiled out and no thread indexes a table that is not frozen
+ * meanwhile, as that may move the array of indexes. Inserting into a
+ * frozen table, or changing its chain, aborts the compiler, in release
+ * builds as well.
+ */
+#define INDEX_INITIAL_SLOTS 16
+
+/*
+ * A slot holds its key next to the entry, so that a probe does not touch
+ * the entry. The type is 0 in the slots of the name table.
+ */
+typedef struct
+{
+    char *name;
+    nodetype type;
+    node *entry;
+} st_slot;
+
+typedef struct
+{
+    node *table;
+    node *first;
+    node *last;
+    unsigned int count;
+    unsigned int params;
+    unsigned int slots;
+    st_slot *names;
+    st_slot *decls;
+    bool frozen;
+    unsigned int types[MAX_NODES + 1];
+} st_index;
+
+static st_index **indexes = NULL;
+static int index_count = 0;
+static int index_size = 0;
+
+/**
+ * Returns the name of a declaration, or NULL if the node does not declare
+ * a name.
  */
-unsigned int STcountByType(node *entry, nodetype node_type)
+static char *DeclName(node *decl)
 {
-    if (entry == NULL)
+    switch (NODE_TYPE(decl))
     {
-        return 0;
+    case N_globdef:
+        return GLOBDEF_NAME(decl);
+    case N_globdecl:
+        return GLOBDECL_NAME(decl);
+    case N_fundef:
+        return FUNDEF_NAME(decl);
+    case N_fundecl:
+        return FUNDECL_NAME(decl);
+    case N_vardecl:
+        return VARDECL_NAME(decl);
+    case N_param:
+        return PARAM_NAME(decl);
+    default:
+        return NULL;
     }
+}
 
-    if (NODE_TYPE(SYMBOLTABLEENTRY_DECLARATION(entry)) == node_type)
+/**
+ * Returns the slot with the given key in one of the tables of an index,
+ * or the empty slot where it belongs. Names are interned, so the pointer
+ * is hashed; the high bits of the product select the slot.
+ */
+static st_slot *FindSlot(st_slot *table, unsigned int slots, char *name, nodetype type)
+{
+    uint64_t hash = ((uint64_t)(uintptr_t)name + (uint64_t)type) * 0x9E3779B97F4A7C15ull;
+    unsigned int mask = slots - 1;
+    unsigned int i;
+
+    for (i = (unsigned int)(hash >> 32) & mask; table[i].entry != NULL; i = (i + 1) & mask)
     {
-        return 1 + STcountByType(SYMBOLTABLEENTRY_NEXT(entry), node_type);
+        if (table[i].name == name && table[i].type == type)
+        {
+            break;
+        }
     }
 
-    return STcountByType(SYMBOLTABLEENTRY_NEXT(entry), node_type);
+    return &table[i];
 }
 
 /**
- * Counts the number of parameters in the symbol table entries.
- *
- * @param entry Start of the symbol table entry list.
- * @return The count of parameters in the symbol table.
+ * Fills the slot with the given key, unless it is taken: an entry with the
+ * same key comes later in the chain and is not found.
+ */
+static void PutSlot(st_slot *table, unsigned int slots, char *name, nodetype type, node *entry)
+{
+    st_slot *slot = FindSlot(table, slots, name, type);
+
+    if (slot->entry == NULL)
+    {
+        slot->name = name;
+        slot->type = type;
+        slot->entry = entry;
+    }
+}
+
+/**
+ * Doubles the number of slots of an index and rehashes its entries.
  */
-unsigned int STcountParams(node *entry)
+static void GrowIndex(st_index *index)
 {
-    if (!entry)
+    st_slot *names = index->names;
+    st_slot *decls = index->decls;
+    unsigned int slots = index->slots;
+    unsigned int i;
+
+    index->slots = 2 * slots;
+    index->names = MEMmalloc(index->slots * sizeof(st_slot));
+    index->decls = MEMmalloc(index->slots * sizeof(st_slot));
+    memset(index->names, 0, index->slots * sizeof(st_slot));
+    memset(index->decls, 0, index->slots * sizeof(st_slot));
+
+    for (i = 0; i < slots; i++)
     {
-        return 0;
+        if (names[i].entry != NULL)
+        {
+            PutSlot(index->names, index->slots, names[i].name, names[i].type, names[i].entry);
+        }
+        if (decls[i].entry != NULL)
+        {
+            PutSlot(index->decls, index->slots, decls[i].name, decls[i].type, decls[i].entry);
+        }
     }
 
+    names = MEMfree(names);
+    decls = MEMfree(decls);
+}
+
+/**
+ * Adds an entry at the end of the chain to the index.
+ */
+static void IndexEntry(st_index *index, node *entry)
+{
+    node *decl = SYMBOLTABLEENTRY_DECLARATION(entry);
+
+    if (2 * (index->count + 1) > index->slots)
+    {
+        GrowIndex(index);
+    }
+
+    PutSlot(index->names, index->slots, SYMBOLTABLEENTRY_NAME(entry), 0, entry);
+
+    if (DeclName(decl) != NULL)
+    {
+        PutSlot(index->decls, index->slots, DeclName(decl), NODE_TYPE(decl), entry);
+    }
+
+    index->types[NODE_TYPE(decl)]++;
     if (SYMBOLTABLEENTRY_ISPARAMETER(entry))
     {
-        return 1 + STcountParams(SYMBOLTABLEENTRY_NEXT(entry));
+        index->params++;
     }
+    index->count++;
+    index->last = entry;
+}
 
-    return STcountParams(SYMBOLTABLEENTRY_NEXT(entry));
+/**
+ * Empties an index and makes it start at the first entry of its table.
+ */
+static void ClearIndex(st_index *index)
+{
+    memset(index->names, 0, index->slots * sizeof(st_slot));
+    memset(index->decls, 0, index->slots * sizeof(st_slot));
+    memset(index->types, 0, sizeof(index->types));
+    index->first = SYMBOLTABLE_ENTRIES(index->table);
+    index->last = NULL;
+    index->count = 0;
+    index->params = 0;
 }
 
 /**
- * Counts the number of variable declarations in the symbol table entries.
- *
- * @param entry Start of the symbol table entry list.
- * @return The count of variable declarations in the symbol table.
+ * Makes a new, empty index for the given table and sets its handle.
  */
-unsigned int STcountVarDecls(node *entry)
+static st_index *NewIndex(node *symbol_table)
 {
-    if (!entry)
+    st_index **grown;
+    st_index *index;
+
+    if (index_count == index_size)
+    {
+        index_size = index_size == 0 ? INDEX_INITIAL_SLOTS : 2 * index_size;
+        grown = MEMmalloc(index_size * sizeof(st_index *));
+        if (index_count == 0)
+        {
+            // Handle 0 stands for no index
+            grown[index_count++] = NULL;
+        }
+        else
+        {
+            memcpy(grown, indexes, index_count * sizeof(st_index *));
+            indexes = MEMfree(indexes);
+        }
+        indexes = grown;
+    }
+
+    index = MEMmalloc(sizeof(st_index));
+    index->table = symbol_table;
+    index->frozen = FALSE;
+    index->slots = INDEX_INITIAL_SLOTS;
+    index->names = MEMmalloc(index->slots * sizeof(st_slot));
+    index->decls = MEMmalloc(index->slots * sizeof(st_slot));
+    ClearIndex(index);
+
+    SYMBOLTABLE_INDEX(symbol_table) = index_count;
+    indexes[index_count++] = index;
+
+    return index;
+}
+
+/**
+ * Frees the indexes of all tables. Called when the node arena is reset,
+ * which frees the tables themselves.
+ */
+void STfreeIndexes(void)
+{
+    int i;
+
+    DBUG_ENTER("STfreeIndexes");
+
+    for (i = 1; i < index_count; i++)
+    {
+        // A frozen index holds both hash tables in the block of names
+        if (!indexes[i]->frozen)
+        {
+            MEMfree(indexes[i]->decls);
+        }
+        MEMfree(indexes[i]->names);
+        MEMfree(indexes[i]);
+    }
+
+    if (indexes != NULL)
+    {
+        indexes = MEMfree(indexes);
+    }
+    index_count = 0;
+    index_size = 0;
+
+    DBUG_VOID_RETURN;
+}
+
+/**
+ * Returns the index of a table, up to date with its chain of entries.
+ */
+static st_index *IndexOf(node *symbol_table)
+{
+    int handle = SYMBOLTABLE_INDEX(symbol_table);
+    st_index *index;
+    node *entry;
+
+    if (handle > 0 && handle < index_count && indexes[handle]->table == symbol_table)
+    {
+        index = indexes[handle];
+
+        if (index->frozen)
+        {
+            if (index->first != SYMBOLTABLE_ENTRIES(symbol_table) || (index->last != NULL && SYMBOLTABLEENTRY_NEXT(index->last) != NULL))
+            {
+                CTIabort("The chain of a frozen symbol table was changed");
+            }
+            return index;
+        }
+    }
+    else
+    {
+        index = NewIndex(symbol_table);
+    }
+
+    if (index->first != SYMBOLTABLE_ENTRIES(symbol_table))
+    {
+        ClearIndex(index);
+    }
+
+    entry = index->last == NULL ? index->first : SYMBOLTABLEENTRY_NEXT(index->last);
+    for (; entry != NULL; entry = SYMBOLTABLEENTRY_NEXT(entry))
+    {
+        IndexEntry(index, entry);
+    }
+
+    return index;
+}
+
+/**
+ * Freezes a table and, nested to any depth, the tables of its functions.
+ * The entries are walked here rather than traversed, so a long chain does
+ * not recurse.
+ */
+node *FRZsymboltable(node *arg_node, info *arg_info)
+{
+    st_index *index;
+    st_slot *block;
+    unsigned int slots = 2;
+    node *entry;
+
+    DBUG_ENTER("FRZsymboltable");
+
+    index = IndexOf(arg_node);
+
+    if (!index->frozen)
     {
-        return 0;
+        while (slots < 2 * index->count)
+        {
+            slots = 2 * slots;
+        }
+
+        // Both hash tables go into one block, and the old ones are dropped
+        block = MEMmalloc(2 * slots * sizeof(st_slot));
+        memset(block, 0, 2 * slots * sizeof(st_slot));
+
+        for (entry = index->first; entry != NULL; entry = SYMBOLTABLEENTRY_NEXT(entry))
+        {
+            node *decl = SYMBOLTABLEENTRY_DECLARATION(entry);
+
+            PutSlot(block, slots, SYMBOLTABLEENTRY_NAME(entry), 0, entry);
+
+            if (DeclName(decl) != NULL)
+            {
+                PutSlot(block + slots, slots, DeclName(decl), NODE_TYPE(decl), entry);
+            }
+        }
+
+        MEMfree(index->names);
+        MEMfree(index->decls);
+        index->names = block;
+        index->decls = block + slots;
+        index->slots = slots;
+        index->frozen = TRUE;
     }
 
-    if (!SYMBOLTABLEENTRY_ISPARAMETER(entry))
+    for (entry = index->first; entry != NULL; entry = SYMBOLTABLEENTRY_NEXT(entry))
     {
-        return 1 + STcountVarDecls(SYMBOLTABLEENTRY_NEXT(entry));
+        L_SYMBOLTABLEENTRY_TABLE(entry, TRAVopt(SYMBOLTABLEENTRY_TABLE(entry), arg_info));
     }
 
-    return STcountVarDecls(SYMBOLTABLEENTRY_NEXT(entry));
+    DBUG_RETURN(arg_node);
+}
+
+/**
+ * Counts the number of parameters in the symbol table.
+ *
+ * @param symbol_table The symbol table to count in.
+ * @return The count of parameters in the symbol table.
+ */
+unsigned int STcountParams(node *symbol_table)
+{
+    return IndexOf(symbol_table)->params;
+}
+
+/**
+ * Counts the number of entries in the symbol table that are not parameters.
+ *
+ * @param symbol_table The symbol table to count in.
+ * @return The count of variable declarations in the symbol table.
+ */
+unsigned int STcountVarDecls(node *symbol_table)
+{
+    st_index *index = IndexOf(symbol_table);
+
+    return index->count - index->params;
+}
+
+/**
+ * Makes the signature of the function of the given entry from the
+ * parameters in its table, and stores it in that table. For a FunDecl it
+ * renders the text of the .import, for an exported function that of the
+ * .export, so code generation need not walk the parameters again.
+ *
+ * @param entry The entry of the function, once its parameters are in its table.
+ * @return The signature.
+ */
+node *STsign(node *entry)
+{
+    DBUG_ENTER("STsign");
+
+    node *table = SYMBOLTABLEENTRY_TABLE(entry);
+    node *decl = SYMBOLTABLEENTRY_DECLARATION(entry);
+    char *name = SYMBOLTABLEENTRY_NAME(entry);
+    char *return_type = HprintType(SYMBOLTABLEENTRY_TYPE(entry));
+    node *signature = TBmakeSignature(STcountParams(table), SYMBOLTABLEENTRY_TYPE(entry));
+
+    bool is_import = NODE_TYPE(decl) == N_fundecl;
+    bool is_export = SYMBOLTABLEENTRY_ISEXPORT(entry);
+
+    if (is_import || is_export)
+    {
+        // The text is sized first, so that it is written in one pass
+        size_t length = 2 * strlen(name) + strlen(return_type) + 10;
+
+        for (node *param = SYMBOLTABLE_ENTRIES(table); param != NULL; param = SYMBOLTABLEENTRY_NEXT(param))
+        {
+            if (SYMBOLTABLEENTRY_ISPARAMETER(param))
+            {
+                length += strlen(HprintType(SYMBOLTABLEENTRY_TYPE(param))) + 1;
+            }
+        }
+
+        char *text = MEMmalloc(length);
+        char *end = text + sprintf(text, "fun \"%s\" %s ", name, return_type);
+
+        for (node *param = SYMBOLTABLE_ENTRIES(table); param != NULL; param = SYMBOLTABLEENTRY_NEXT(param))
+        {
+            if (SYMBOLTABLEENTRY_ISPARAMETER(param))
+            {
+                end += sprintf(end, " %s", HprintType(SYMBOLTABLEENTRY_TYPE(param)));
+            }
+        }
+
+        if (is_import)
+        {
+            SIGNATURE_IMPORT(signature) = NAMEinternN(text, end - text);
+        }
+        else
+        {
+            end += sprintf(end, " %s", name);
+            SIGNATURE_EXPORT(signature) = NAMEinternN(text, end - text);
+        }
+
+        MEMfree(text);
+    }
+
+    L_SYMBOLTABLE_SIGNATURE(table, signature);
+
+    DBUG_RETURN(signature);
 }
 
 /**
@@ -84,25 +482,33 @@ node *STinsert(node *symbol_table, node *entry)
 {
     DBUG_ENTER("STinsert");
 
-    if (STfind(symbol_table, SYMBOLTABLEENTRY_NAME(entry)) != NULL)
+    st_index *index = IndexOf(symbol_table);
+
+    if (index->frozen)
     {
-        CTIerrorLine(NODE_LINE(entry) + 1, "Variable/Function '%s' is already defined.", SYMBOLTABLEENTRY_NAME(entry));
-        return NULL;
+        CTIabort("Cannot insert '%s' into a frozen symbol table", SYMBOLTABLEENTRY_NAME(entry));
     }
 
-    SYMBOLTABLEENTRY_OFFSET(entry) = STcountByType(SYMBOLTABLE_ENTRIES(symbol_table), NODE_TYPE(SYMBOLTABLEENTRY_DECLARATION(entry)));
+    if (FindSlot(index->names, index->slots, SYMBOLTABLEENTRY_NAME(entry), 0)->entry != NULL)
+    {
+        CTIerrorLine(LOCline(NODE_OFFSET(entry)), "Variable/Function '%s' is already defined.", SYMBOLTABLEENTRY_NAME(entry));
+        DBUG_RETURN(NULL);
+    }
 
-    node *last = STlast(symbol_table);
+    SYMBOLTABLEENTRY_OFFSET(entry) = index->types[NODE_TYPE(SYMBOLTABLEENTRY_DECLARATION(entry))];
 
-    if (!last)
+    if (!index->last)
     {
-        SYMBOLTABLE_ENTRIES(symbol_table) = entry;
+        L_SYMBOLTABLE_ENTRIES(symbol_table, entry);
+        index->first = entry;
     }
     else
     {
-        SYMBOLTABLEENTRY_NEXT(last) = entry;
+        L_SYMBOLTABLEENTRY_NEXT(index->last, entry);
     }
 
+    IndexEntry(index, entry);
+
     DBUG_RETURN(entry);
 }
 
@@ -110,32 +516,23 @@ node *STinsert(node *symbol_table, node *entry)
  * Searches for a symbol table entry with the given name.
  *
  * @param symbol_table The symbol table to search within.
- * @param name The name of the entry to search for.
+ * @param name The interned name of the entry to search for.
  * @return The found entry if exists, otherwise NULL.
  */
 node *STfind(node *symbol_table, char *name)
 {
     DBUG_ENTER("STfind");
-    node *entry = SYMBOLTABLE_ENTRIES(symbol_table);
 
-    while (entry)
-    {
-        if (STReq(SYMBOLTABLEENTRY_NAME(entry), name))
-        {
-            DBUG_RETURN(entry);
-        }
+    st_index *index = IndexOf(symbol_table);
 
-        entry = SYMBOLTABLEENTRY_NEXT(entry);
-    }
-
-    DBUG_RETURN(NULL);
+    DBUG_RETURN(FindSlot(index->names, index->slots, name, 0)->entry);
 }
 
 /**
  * Searches for a symbol table entry with the given name, including parent tables.
  *
  * @param symbol_table The symbol table to start the search from.
- * @param name The name of the entry to search for.
+ * @param name The interned name of the entry to search for.
  * @return The found entry if exists, otherwise NULL.
  */
 node *STfindInParents(node *symbol_table, char *name)
@@ -161,22 +558,19 @@ node *STfindInParents(node *symbol_table, char *name)
  * Searches for a function entry with the given name in the symbol table.
  *
  * @param symbol_table The symbol table to search within.
- * @param name The name of the function entry to search for.
+ * @param name The interned name of the function entry to search for.
  * @return The found function entry if exists, otherwise NULL.
  */
 node *STfindFunc(node *symbol_table, char *name)
 {
     DBUG_ENTER("STfindFunc");
-    node *entry = SYMBOLTABLE_ENTRIES(symbol_table);
 
-    while (entry)
-    {
-        if (SYMBOLTABLEENTRY_ISFUNCTION(entry) && STReq(SYMBOLTABLEENTRY_NAME(entry), name))
-        {
-            DBUG_RETURN(entry);
-        }
+    // Names are unique within a table, so there is no later function entry
+    node *entry = STfind(symbol_table, name);
 
-        entry = SYMBOLTABLEENTRY_NEXT(entry);
+    if (entry && SYMBOLTABLEENTRY_ISFUNCTION(entry))
+    {
+        DBUG_RETURN(entry);
     }
 
     DBUG_RETURN(NULL);
@@ -186,7 +580,7 @@ node *STfindFunc(node *symbol_table, char *name)
  * Searches for a function entry with the given name in the symbol table, including parent tables.
  *
  * @param symbol_table The symbol table to start the search from.
- * @param name The name of the function entry to search for.
+ * @param name The interned name of the function entry to search for.
  * @return The found function entry if exists, otherwise NULL.
  */
 node *STfindFuncInParents(node *symbol_table, char *name)
@@ -218,44 +612,17 @@ node *STfindFuncInParents(node *symbol_table, char *name)
 node *STfindByDecl(node *symbol_table, node *decl)
 {
     DBUG_ENTER("STfindByDecl");
-    node *entry = SYMBOLTABLE_ENTRIES(symbol_table);
 
-    while (entry)
-    {
-        node *entry_decl = SYMBOLTABLEENTRY_DECLARATION(entry);
+    char *name = DeclName(decl);
 
-        if (NODE_TYPE(entry_decl) == NODE_TYPE(decl))
-        {
-            if (NODE_TYPE(entry_decl) == N_globdef && STReq(GLOBDEF_NAME(entry_decl), GLOBDEF_NAME(decl)))
-            {
-                DBUG_RETURN(entry);
-            }
-            if (NODE_TYPE(entry_decl) == N_globdecl && STReq(GLOBDECL_NAME(entry_decl), GLOBDECL_NAME(decl)))
-            {
-                DBUG_RETURN(entry);
-            }
-            if (NODE_TYPE(entry_decl) == N_fundef && STReq(FUNDEF_NAME(entry_decl), FUNDEF_NAME(decl)))
-            {
-                DBUG_RETURN(entry);
-            }
-            if (NODE_TYPE(entry_decl) == N_fundecl && STReq(FUNDECL_NAME(entry_decl), FUNDECL_NAME(decl)))
-            {
-                DBUG_RETURN(entry);
-            }
-            if (NODE_TYPE(entry_decl) == N_vardecl && STReq(VARDECL_NAME(entry_decl), VARDECL_NAME(decl)))
-            {
-                DBUG_RETURN(entry);
-            }
-            if (NODE_TYPE(entry_decl) == N_param && STReq(PARAM_NAME(entry_decl), PARAM_NAME(decl)))
-            {
-                DBUG_RETURN(entry);
-            }
-        }
-
-        entry = SYMBOLTABLEENTRY_NEXT(entry);
+    if (name == NULL)
+    {
+        DBUG_RETURN(NULL);
     }
 
-    DBUG_RETURN(NULL);
+    st_index *index = IndexOf(symbol_table);
+
+    DBUG_RETURN(FindSlot(index->decls, index->slots, name, NODE_TYPE(decl))->entry);
 }
 
 /**
@@ -294,17 +661,23 @@ node *STlast(node *symbol_table)
 {
     DBUG_ENTER("STlast");
 
-    if (!SYMBOLTABLE_ENTRIES(symbol_table))
-    {
-        DBUG_RETURN(NULL);
-    }
+    DBUG_RETURN(IndexOf(symbol_table)->last);
+}
 
-    node *entry = SYMBOLTABLE_ENTRIES(symbol_table);
+/**
+ * Freezes the symbol table of the program and those of its functions, so
+ * that lookups in them write nothing and are safe from several threads.
+ *
+ * @param syntaxtree The program, after variable initialisation.
+ * @return The program.
+ */
+node *STdoFreeze(node *syntaxtree)
+{
+    DBUG_ENTER("STdoFreeze");
 
-    while (SYMBOLTABLEENTRY_NEXT(entry))
-    {
-        entry = SYMBOLTABLEENTRY_NEXT(entry);
-    }
+    TRAVpush(TR_frz);
+    L_PROGRAM_SYMBOLTABLE(syntaxtree, TRAVopt(PROGRAM_SYMBOLTABLE(syntaxtree), NULL));
+    TRAVpop();
 
-    DBUG_RETURN(entry);
+    DBUG_RETURN(syntaxtree);
 }
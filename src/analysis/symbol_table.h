@@ -3,8 +3,10 @@
 
 #include "types.h"
 
-extern unsigned int STcountParams(node *entry);
-extern unsigned int STcountVarDecls(node *entry);
+extern unsigned int STcountParams(node *symbol_table);
+extern unsigned int STcountVarDecls(node *symbol_table);
+
+extern node *STsign(node *entry);
 
 extern node *STinsert(node *symbol_table, node *entry);
 
@@ -19,4 +21,8 @@ extern node *STfindByDeclInParents(node *symbol_table, node *decl);
 
 extern node *STlast(node *symbol_table);
 
+extern node *STdoFreeze(node *syntaxtree);
+extern void STfreeIndexes(void);
+extern node *FRZsymboltable(node *arg_node, info *arg_info);
+
 #endif
\ No newline at end of file
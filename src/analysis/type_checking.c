@@ -6,11 +6,14 @@
 #include "ctinfo.h"
 #include "dbug.h"
 #include "free.h"
+#include "location.h"
 #include "memory.h"
+#include "myglobals.h"
 #include "str.h"
 #include "types.h"
 #include "tree_basic.h"
 #include "traverse.h"
+#include "traverse_tables.h"
 
 // Structure to store type checking information.
 struct INFO
@@ -24,6 +27,12 @@ struct INFO
 #define INFO_TYPE(n) ((n)->type)
 #define INFO_RETURN_TYPE(n) ((n)->return_type)
 
+// Sons are traversed through the dispatcher of TC with -dispatch=direct.
+#define TRAV_DO(n, info) \
+    (myglobal.direct_dispatch ? TRAVdispatchTC(n, info) : TRAVdo(n, info))
+#define TRAV_OPT(n, info) \
+    (myglobal.direct_dispatch ? TRAVdispatchTC(n, info) : TRAVopt(n, info))
+
 /**
  * Create and initialize a new type checking info structure.
  *
@@ -59,17 +68,12 @@ static info *FreeInfo(info *info)
 /**
  * Count the number of arguments in a given expression node.
  *
- * @param arg_node The argument node to start counting from.
+ * @param arg_node The Exprs node of the arguments, or NULL.
  * @return The number of arguments.
  */
 unsigned int TCcountArguments(node *arg_node)
 {
-    if (!arg_node)
-    {
-        return 0;
-    }
-
-    return 1 + TCcountArguments(EXPRS_NEXT(arg_node));
+    return arg_node == NULL ? 0 : EXPRS_COUNT(arg_node);
 }
 
 /**
@@ -78,6 +82,7 @@ unsigned int TCcountArguments(node *arg_node)
 node *TCnum(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("TCnum");
+    NUM_TYPE(arg_node) = T_int;
     INFO_TYPE(arg_info) = T_int;
     DBUG_RETURN(arg_node);
 }
@@ -88,6 +93,7 @@ node *TCnum(node *arg_node, info *arg_info)
 node *TCfloat(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("TCfloat");
+    FLOAT_TYPE(arg_node) = T_float;
     INFO_TYPE(arg_info) = T_float;
     DBUG_RETURN(arg_node);
 }
@@ -98,6 +104,7 @@ node *TCfloat(node *arg_node, info *arg_info)
 node *TCbool(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("TCbool");
+    BOOL_TYPE(arg_node) = T_bool;
     INFO_TYPE(arg_info) = T_bool;
     DBUG_RETURN(arg_node);
 }
@@ -107,7 +114,7 @@ node *TCprogram(node *arg_node, info *arg_info)
     DBUG_ENTER("TCprogram");
 
     INFO_SYMBOL_TABLE(arg_info) = PROGRAM_SYMBOLTABLE(arg_node);
-    PROGRAM_DECLS(arg_node) = TRAVdo(PROGRAM_DECLS(arg_node), arg_info);
+    L_PROGRAM_DECLS(arg_node, TRAV_DO(PROGRAM_DECLS(arg_node), arg_info));
 
     DBUG_RETURN(arg_node);
 }
@@ -122,7 +129,7 @@ node *TCfundef(node *arg_node, info *arg_info)
     INFO_SYMBOL_TABLE(arg_info) = FUNDEF_SYMBOLTABLE(arg_node);
     INFO_RETURN_TYPE(arg_info) = FUNDEF_TYPE(arg_node);
 
-    FUNDEF_FUNBODY(arg_node) = TRAVdo(FUNDEF_FUNBODY(arg_node), arg_info);
+    L_FUNDEF_FUNBODY(arg_node, TRAV_DO(FUNDEF_FUNBODY(arg_node), arg_info));
 
     INFO_SYMBOL_TABLE(arg_info) = symbol_table;
     INFO_RETURN_TYPE(arg_info) = return_type;
@@ -134,21 +141,22 @@ node *TCvardecl(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("TCvardecl");
 
-    if (VARDECL_INIT(arg_node))
+    for (node *vardecl = arg_node; vardecl != NULL; vardecl = VARDECL_NEXT(vardecl))
     {
-        VARDECL_INIT(arg_node) = TRAVdo(VARDECL_INIT(arg_node), arg_info);
+        if (VARDECL_INIT(vardecl))
+        {
+            L_VARDECL_INIT(vardecl, TRAV_DO(VARDECL_INIT(vardecl), arg_info));
 
-        type vardecl_expected_type = VARDECL_TYPE(arg_node);
-        type vardecl_actual_type = INFO_TYPE(arg_info);
+            type vardecl_expected_type = VARDECL_TYPE(vardecl);
+            type vardecl_actual_type = INFO_TYPE(arg_info);
 
-        if (vardecl_actual_type != vardecl_expected_type)
-        {
-            CTIerrorLine(NODE_LINE(arg_node) + 1, "Expected type '%s' but actual '%s'", HprintType(vardecl_expected_type), HprintType(vardecl_actual_type));
+            if (vardecl_actual_type != vardecl_expected_type)
+            {
+                CTIerrorLine(LOCline(NODE_OFFSET(vardecl)), "Expected type '%s' but actual '%s'", HprintType(vardecl_expected_type), HprintType(vardecl_actual_type));
+            }
         }
     }
 
-    VARDECL_NEXT(arg_node) = TRAVopt(VARDECL_NEXT(arg_node), arg_info);
-
     DBUG_RETURN(arg_node);
 }
 
@@ -156,7 +164,15 @@ node *TCvarlet(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("TCvarlet");
 
-    node *entry = STfindInParents(INFO_SYMBOL_TABLE(arg_info), VARLET_NAME(arg_node));
+    node *entry = VARLET_ENTRY(arg_node);
+
+    // Assignments made by variable initialisation are bound here
+    if (!entry)
+    {
+        entry = STfindInParents(INFO_SYMBOL_TABLE(arg_info), VARLET_NAME(arg_node));
+        VARLET_ENTRY(arg_node) = entry;
+    }
+
     INFO_TYPE(arg_info) = SYMBOLTABLEENTRY_TYPE(entry);
 
     DBUG_RETURN(arg_node);
@@ -166,15 +182,15 @@ node *TCassign(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("TCassign");
 
-    ASSIGN_LET(arg_node) = TRAVdo(ASSIGN_LET(arg_node), arg_info);
+    L_ASSIGN_LET(arg_node, TRAV_DO(ASSIGN_LET(arg_node), arg_info));
     type assign_expected_type = INFO_TYPE(arg_info);
 
-    ASSIGN_EXPR(arg_node) = TRAVdo(ASSIGN_EXPR(arg_node), arg_info);
+    L_ASSIGN_EXPR(arg_node, TRAV_DO(ASSIGN_EXPR(arg_node), arg_info));
     type assign_actual_type = INFO_TYPE(arg_info);
 
     if (assign_actual_type != assign_expected_type)
     {
-        CTIerrorLine(NODE_LINE(arg_node) + 1, "Expected type '%s' but actual type '%s'", HprintType(assign_expected_type), HprintType(assign_actual_type));
+        CTIerrorLine(LOCline(NODE_OFFSET(arg_node)), "Expected type '%s' but actual type '%s'", HprintType(assign_expected_type), HprintType(assign_actual_type));
     }
 
     DBUG_RETURN(arg_node);
@@ -189,13 +205,13 @@ node *TCreturn(node *arg_node, info *arg_info)
 
     if (RETURN_EXPR(arg_node))
     {
-        RETURN_EXPR(arg_node) = TRAVdo(RETURN_EXPR(arg_node), arg_info);
+        L_RETURN_EXPR(arg_node, TRAV_DO(RETURN_EXPR(arg_node), arg_info));
         return_actual_type = INFO_TYPE(arg_info);
     }
 
     if (return_actual_type != return_expected_type)
     {
-        CTIerrorLine(NODE_LINE(arg_node) + 1, "Expected type '%s' but actual '%s'", HprintType(return_expected_type), HprintType(return_actual_type));
+        CTIerrorLine(LOCline(NODE_OFFSET(arg_node)), "Expected type '%s' but actual '%s'", HprintType(return_expected_type), HprintType(return_actual_type));
     }
 
     DBUG_RETURN(arg_node);
@@ -209,13 +225,20 @@ node *TCfuncall(node *arg_node, info *arg_info)
 
     if (!fundecl_entry)
     {
-        CTIerrorLine(NODE_LINE(arg_node) + 1, "Function '%s' called but is not declared", FUNCALL_NAME(arg_node));
+        CTIerrorLine(LOCline(NODE_OFFSET(arg_node)), "Function '%s' called but is not declared", FUNCALL_NAME(arg_node));
         DBUG_RETURN(arg_node);
     }
 
-    FUNCALL_ARGS(arg_node) = TRAVopt(FUNCALL_ARGS(arg_node), arg_info);
-    
-    INFO_TYPE(arg_info) = SYMBOLTABLEENTRY_TYPE(fundecl_entry);
+    /*
+     * Calls are bound here rather than in context analysis, since a call may
+     * precede the definition of the function it calls.
+     */
+    FUNCALL_ENTRY(arg_node) = fundecl_entry;
+
+    L_FUNCALL_ARGS(arg_node, TRAV_OPT(FUNCALL_ARGS(arg_node), arg_info));
+
+    FUNCALL_TYPE(arg_node) = SIGNATURE_RETURNTYPE(SYMBOLTABLE_SIGNATURE(SYMBOLTABLEENTRY_TABLE(fundecl_entry)));
+    INFO_TYPE(arg_info) = FUNCALL_TYPE(arg_node);
 
     DBUG_RETURN(arg_node);
 }
@@ -224,11 +247,11 @@ node *TCcast(node *arg_node, info *arg_info)
 {
     DBUG_ENTER("TCcast");
 
-    CAST_EXPR(arg_node) = TRAVdo(CAST_EXPR(arg_node), arg_info);
+    L_CAST_EXPR(arg_node, TRAV_DO(CAST_EXPR(arg_node), arg_info));
 
     if (INFO_TYPE(arg_info) == T_void)
     {
-        CTIerrorLine(NODE_LINE(arg_node), "Cannot cast '%s' to '%s'", HprintType(INFO_TYPE(arg_info)), HprintType(CAST_TYPE(arg_node)));
+        CTIerrorLine(LOCline(NODE_OFFSET(arg_node)), "Cannot cast '%s' to '%s'", HprintType(INFO_TYPE(arg_info)), HprintType(CAST_TYPE(arg_node)));
     }
 
     INFO_TYPE(arg_info) = CAST_TYPE(arg_node);
@@ -237,18 +260,73 @@ node *TCcast(node *arg_node, info *arg_info)
 }
 
 /**
- * Type check a binary operation.
+ * The type of a unary operation is that of its operand.
  */
-node *TCbinop(node *arg_node, info *arg_info)
+node *TCmonop(node *arg_node, info *arg_info)
 {
-    DBUG_ENTER("TCbinop");
+    DBUG_ENTER("TCmonop");
 
-    binop binop_op = BINOP_OP(arg_node);
+    L_MONOP_OPERAND(arg_node, TRAV_DO(MONOP_OPERAND(arg_node), arg_info));
+    MONOP_TYPE(arg_node) = INFO_TYPE(arg_info);
 
-    BINOP_LEFT(arg_node) = TRAVdo(BINOP_LEFT(arg_node), arg_info);
+    DBUG_RETURN(arg_node);
+}
+
+node *TCvar(node *arg_node, info *arg_info)
+{
+    DBUG_ENTER("TCvar");
+
+    L_VAR_INDICES(arg_node, TRAV_OPT(VAR_INDICES(arg_node), arg_info));
+
+    VAR_TYPE(arg_node) = SYMBOLTABLEENTRY_TYPE(VAR_ENTRY(arg_node));
+    INFO_TYPE(arg_info) = VAR_TYPE(arg_node);
+
+    DBUG_RETURN(arg_node);
+}
+
+/**
+ * The type of an array expression is that of its elements.
+ */
+node *TCarrexpr(node *arg_node, info *arg_info)
+{
+    DBUG_ENTER("TCarrexpr");
+
+    INFO_TYPE(arg_info) = T_unknown;
+    L_ARREXPR_EXPRS(arg_node, TRAV_OPT(ARREXPR_EXPRS(arg_node), arg_info));
+    ARREXPR_TYPE(arg_node) = INFO_TYPE(arg_info);
+
+    DBUG_RETURN(arg_node);
+}
+
+/**
+ * The type of a ternary is that of its branches.
+ */
+node *TCternary(node *arg_node, info *arg_info)
+{
+    DBUG_ENTER("TCternary");
+
+    L_TERNARY_COND(arg_node, TRAV_DO(TERNARY_COND(arg_node), arg_info));
+    L_TERNARY_THEN(arg_node, TRAV_OPT(TERNARY_THEN(arg_node), arg_info));
+    TERNARY_TYPE(arg_node) = INFO_TYPE(arg_info);
+
+    L_TERNARY_ELSE(arg_node, TRAV_OPT(TERNARY_ELSE(arg_node), arg_info));
+    INFO_TYPE(arg_info) = TERNARY_TYPE(arg_node);
+
+    DBUG_RETURN(arg_node);
+}
+
+/**
+ * Type check a binary operation whose left operand has been checked, with
+ * the type of the left operand in INFO_TYPE.
+ */
+static void CheckBinop(node *arg_node, info *arg_info)
+{
+    DBUG_ENTER("CheckBinop");
+
+    binop binop_op = BINOP_OP(arg_node);
     type binop_left_type = INFO_TYPE(arg_info);
 
-    BINOP_RIGHT(arg_node) = TRAVdo(BINOP_RIGHT(arg_node), arg_info);
+    L_BINOP_RIGHT(arg_node, TRAV_DO(BINOP_RIGHT(arg_node), arg_info));
     type binop_right_type = INFO_TYPE(arg_info);
 
     // Validate if the left and right operand types are the same type.
@@ -258,13 +336,13 @@ node *TCbinop(node *arg_node, info *arg_info)
        (binop_left_type != T_bool && binop_left_type != T_int) && 
        (binop_right_type != T_bool && binop_right_type != T_int))
     {
-        CTIerrorLine(NODE_LINE(arg_node) + 1, "Cannot apply operator '%s' to type '%s' and type '%s'", HprintBinOp(binop_op), HprintType(binop_left_type), HprintType(binop_right_type));
+        CTIerrorLine(LOCline(NODE_OFFSET(arg_node)), "Cannot apply operator '%s' to type '%s' and type '%s'", HprintBinOp(binop_op), HprintType(binop_left_type), HprintType(binop_right_type));
     }
 
     if (binop_op == BO_mod && binop_right_type != T_int)
     {
 
-        CTIerrorLine(NODE_LINE(arg_node) + 1, "Cannot apply operator '%s' to type '%s' and type '%s'", HprintBinOp(binop_op), HprintType(binop_left_type), HprintType(binop_right_type));
+        CTIerrorLine(LOCline(NODE_OFFSET(arg_node)), "Cannot apply operator '%s' to type '%s' and type '%s'", HprintBinOp(binop_op), HprintType(binop_left_type), HprintType(binop_right_type));
     }
 
     if (HisBooleanOperator(BINOP_OP(arg_node)))
@@ -272,6 +350,32 @@ node *TCbinop(node *arg_node, info *arg_info)
         INFO_TYPE(arg_info) = T_bool;
     }
 
+    BINOP_TYPE(arg_node) = INFO_TYPE(arg_info);
+
+    DBUG_VOID_RETURN;
+}
+
+/**
+ * Type check a binary operation.
+ * Chains nested through the left operand are checked innermost first in a
+ * loop, so that long chains such as a + b + ... + z do not recurse.
+ */
+node *TCbinop(node *arg_node, info *arg_info)
+{
+    DBUG_ENTER("TCbinop");
+
+    int count;
+    node **spine = HbinopSpine(arg_node, &count);
+
+    L_BINOP_LEFT(spine[count - 1], TRAV_DO(BINOP_LEFT(spine[count - 1]), arg_info));
+
+    for (int i = count - 1; i >= 0; i--)
+    {
+        CheckBinop(spine[i], arg_info);
+    }
+
+    spine = MEMfree(spine);
+
     DBUG_RETURN(arg_node);
 }
 
@@ -289,7 +393,7 @@ node *TCdoTypeChecking(node *syntaxtree)
     info *arg_info = MakeInfo();
 
     TRAVpush(TR_tc);
-    syntaxtree = TRAVdo(syntaxtree, arg_info);
+    syntaxtree = TRAV_DO(syntaxtree, arg_info);
     TRAVpop();
 
     arg_info = FreeInfo(arg_info);
@@ -16,6 +16,10 @@ node *TCassign(node *arg_node, info *arg_info);
 node *TCreturn(node *arg_node, info *arg_info);
 node *TCcast(node *arg_node, info *arg_info);
 node *TCbinop(node *arg_node, info *arg_info);
+node *TCmonop(node *arg_node, info *arg_info);
+node *TCvar(node *arg_node, info *arg_info);
+node *TCarrexpr(node *arg_node, info *arg_info);
+node *TCternary(node *arg_node, info *arg_info);
 
 extern node *TCdoTypeChecking(node *syntaxtree);
 
@@ -1,6 +1,10 @@
 #include "gen_byte_code.h"
 
+#include <stdint.h>
+#include <string.h>
+
 #include "helpers.h"
+#include "names.h"
 #include "symbol_table.h"
 
 #include "dbug.h"
@@ -11,6 +15,7 @@
 
 #include "ctinfo.h"
 #include "free.h"
+#include "location.h"
 #include "memory.h"
 #include "str.h"
 
@@ -25,7 +30,13 @@ struct INFO
   int branch_counter;
   int load_constants_counter;
 
-  type current_type;
+  node *last_import;
+  node *last_constant;
+  node *last_global;
+  node *last_export;
+
+  node **constant_slots;
+  unsigned int constant_slot_count;
 };
 
 #define INFO_FILE(n) ((n)->fptr)
@@ -37,7 +48,15 @@ struct INFO
 #define INFO_BRANCH_COUNTER(n) ((n)->branch_counter)
 #define INFO_LOAD_CONSTS_COUNTER(n) ((n)->load_constants_counter)
 
-#define INFO_CURRENT_TYPE(n) ((n)->current_type)
+#define INFO_LAST_IMPORT(n) ((n)->last_import)
+#define INFO_LAST_CONSTANT(n) ((n)->last_constant)
+#define INFO_LAST_GLOBAL(n) ((n)->last_global)
+#define INFO_LAST_EXPORT(n) ((n)->last_export)
+
+#define INFO_CONSTANT_SLOTS(n) ((n)->constant_slots)
+#define INFO_CONSTANT_SLOT_COUNT(n) ((n)->constant_slot_count)
+
+#define CONSTANT_INITIAL_SLOTS 64
 
 static info *MakeInfo()
 {
@@ -56,7 +75,14 @@ static info *MakeInfo()
   INFO_BRANCH_COUNTER(result) = 0;
   INFO_LOAD_CONSTS_COUNTER(result) = 0;
 
-  INFO_CURRENT_TYPE(result) = T_unknown;
+  INFO_LAST_IMPORT(result) = NULL;
+  INFO_LAST_CONSTANT(result) = NULL;
+  INFO_LAST_GLOBAL(result) = NULL;
+  INFO_LAST_EXPORT(result) = NULL;
+
+  INFO_CONSTANT_SLOT_COUNT(result) = CONSTANT_INITIAL_SLOTS;
+  INFO_CONSTANT_SLOTS(result) = (node **)MEMmalloc(CONSTANT_INITIAL_SLOTS * sizeof(node *));
+  memset(INFO_CONSTANT_SLOTS(result), 0, CONSTANT_INITIAL_SLOTS * sizeof(node *));
 
   DBUG_RETURN(result);
 }
@@ -65,6 +91,7 @@ static info *FreeInfo(info *info)
 {
   DBUG_ENTER("FreeInfo");
 
+  INFO_CONSTANT_SLOTS(info) = MEMfree(INFO_CONSTANT_SLOTS(info));
   info = MEMfree(info);
 
   DBUG_RETURN(info);
@@ -76,33 +103,105 @@ char *createBranch(const char *name, info *info)
   return STRcatn(3, STRitoa(INFO_BRANCH_COUNTER(info)), "_", name);
 }
 
-node *addToCGTableEntries(node *entries, node *new_entry)
+/**
+ * Interns a freshly built instruction value, so that code gen table entries
+ * can be compared by pointer, and releases the temporary string.
+ */
+char *internValue(char *value)
+{
+  char *interned = NAMEintern(value);
+
+  MEMfree(value);
+
+  return interned;
+}
+
+/**
+ * Appends an entry to one of the lists of the code gen table and returns
+ * the list. The last entry of every list is kept in the info, so an append
+ * does not walk the list.
+ */
+node *addToCGTableEntries(node *entries, node **last, node *new_entry)
 {
-  if (!entries)
+  if (entries == NULL)
   {
     entries = new_entry;
   }
   else
   {
-    CODEGENTABLEENTRY_NEXT(entries) = addToCGTableEntries(CODEGENTABLEENTRY_NEXT(entries), new_entry);
+    L_CODEGENTABLEENTRY_NEXT(*last, new_entry);
   }
 
+  *last = new_entry;
+
   return entries;
 }
 
-node *SearchInCGTableEntries(node *entries, const char *value)
+/**
+ * Constants are also held in an open-addressed hash table keyed on their
+ * interned value, so a constant is found without a walk of the list.
+ */
+static unsigned int ConstantSlot(node **slots, unsigned int slot_count, const char *value)
 {
-  if (!entries)
+  unsigned int slot = (unsigned int)(((uintptr_t)value >> 3) * 2654435761u) & (slot_count - 1);
+
+  while (slots[slot] != NULL && CODEGENTABLEENTRY_VALUE(slots[slot]) != value)
   {
-    return NULL;
+    slot = (slot + 1) & (slot_count - 1);
   }
 
-  if (STReq(CODEGENTABLEENTRY_VALUE(entries), value))
+  return slot;
+}
+
+node *SearchInCGTableEntries(info *arg_info, const char *value)
+{
+  return INFO_CONSTANT_SLOTS(arg_info)[ConstantSlot(INFO_CONSTANT_SLOTS(arg_info), INFO_CONSTANT_SLOT_COUNT(arg_info), value)];
+}
+
+static void AddConstant(info *arg_info, node *entry)
+{
+  node **slots = INFO_CONSTANT_SLOTS(arg_info);
+  unsigned int slot_count = INFO_CONSTANT_SLOT_COUNT(arg_info);
+
+  // Keep the load at most one half
+  if (2 * (unsigned int)(INFO_LOAD_CONSTS_COUNTER(arg_info) + 1) > slot_count)
   {
-    return entries;
+    INFO_CONSTANT_SLOT_COUNT(arg_info) = 2 * slot_count;
+    INFO_CONSTANT_SLOTS(arg_info) = (node **)MEMmalloc(2 * slot_count * sizeof(node *));
+    memset(INFO_CONSTANT_SLOTS(arg_info), 0, 2 * slot_count * sizeof(node *));
+
+    for (unsigned int i = 0; i < slot_count; i++)
+    {
+      if (slots[i] != NULL)
+      {
+        INFO_CONSTANT_SLOTS(arg_info)[ConstantSlot(INFO_CONSTANT_SLOTS(arg_info), 2 * slot_count, CODEGENTABLEENTRY_VALUE(slots[i]))] = slots[i];
+      }
+    }
+
+    MEMfree(slots);
   }
 
-  return SearchInCGTableEntries(CODEGENTABLEENTRY_NEXT(entries), value);
+  INFO_CONSTANT_SLOTS(arg_info)[ConstantSlot(INFO_CONSTANT_SLOTS(arg_info), INFO_CONSTANT_SLOT_COUNT(arg_info), CODEGENTABLEENTRY_VALUE(entry))] = entry;
+
+  L_CODEGENTABLE_CONSTANTS(INFO_CODE_GEN_TABLE(arg_info), addToCGTableEntries(CODEGENTABLE_CONSTANTS(INFO_CODE_GEN_TABLE(arg_info)), &INFO_LAST_CONSTANT(arg_info), entry));
+  INFO_LOAD_CONSTS_COUNTER(arg_info) += 1;
+}
+
+/**
+ * Loads a constant, adding it to the constants of the code gen table if it
+ * is not there yet.
+ */
+static void EmitLoadConstant(const char *load, char *instruction_value, info *arg_info)
+{
+  node *constant_entry = SearchInCGTableEntries(arg_info, instruction_value);
+
+  if (constant_entry == NULL)
+  {
+    constant_entry = TBmakeCodegentableentry(INFO_LOAD_CONSTS_COUNTER(arg_info), I_constant, instruction_value, NULL);
+    AddConstant(arg_info, constant_entry);
+  }
+
+  fprintf(INFO_FILE(arg_info), "\t%s %d\n", load, CODEGENTABLEENTRY_INDEX(constant_entry));
 }
 
 const char *typePrefix(type t)
@@ -139,8 +238,10 @@ node *GBCdecls(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCdecls");
 
-  TRAVdo(DECLS_DECL(arg_node), arg_info);
-  TRAVopt(DECLS_NEXT(arg_node), arg_info);
+  for (int i = 0; i < DECLS_COUNT(arg_node); i++)
+  {
+    TRAVdo(DECLS_DECL(arg_node, i), arg_info);
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -149,8 +250,10 @@ node *GBCexprs(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCexprs");
 
-  TRAVdo(EXPRS_EXPR(arg_node), arg_info);
-  TRAVopt(EXPRS_NEXT(arg_node), arg_info);
+  for (int i = 0; i < EXPRS_COUNT(arg_node); i++)
+  {
+    TRAVdo(EXPRS_EXPR(arg_node, i), arg_info);
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -165,8 +268,6 @@ node *GBCids(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCids");
 
-  TRAVopt(IDS_NEXT(arg_node), arg_info);
-
   DBUG_RETURN(arg_node);
 }
 
@@ -182,7 +283,7 @@ node *GBCexprstmt(node *arg_node, info *arg_info)
     DBUG_RETURN(arg_node);
   }
 
-  node *entry = STfindFuncInParents(INFO_SYMBOL_TABLE(arg_info), FUNCALL_NAME(expr));
+  node *entry = FUNCALL_ENTRY(expr);
   node *link = SYMBOLTABLEENTRY_DECLARATION(entry);
 
   if (NODE_TYPE(link) == N_fundecl)
@@ -190,9 +291,9 @@ node *GBCexprstmt(node *arg_node, info *arg_info)
     DBUG_RETURN(arg_node);
   }
 
-  if (typePrefix(SYMBOLTABLEENTRY_TYPE(entry)))
+  if (typePrefix(FUNCALL_TYPE(expr)))
   {
-    fprintf(INFO_FILE(arg_info), "\t%spop\n", typePrefix(SYMBOLTABLEENTRY_TYPE(entry)));
+    fprintf(INFO_FILE(arg_info), "\t%spop\n", typePrefix(FUNCALL_TYPE(expr)));
   }
 
   DBUG_RETURN(arg_node);
@@ -204,10 +305,10 @@ node *GBCfuncall(node *arg_node, info *arg_info)
 
   fprintf(INFO_FILE(arg_info), "\tisrg\n");
 
-  FUNCALL_ARGS(arg_node) = TRAVopt(FUNCALL_ARGS(arg_node), arg_info);
+  L_FUNCALL_ARGS(arg_node, TRAVopt(FUNCALL_ARGS(arg_node), arg_info));
 
-  node *funcall = STfindFuncInParents(INFO_SYMBOL_TABLE(arg_info), FUNCALL_NAME(arg_node));
-  INFO_CURRENT_TYPE(arg_info) = SYMBOLTABLEENTRY_TYPE(funcall);
+  node *funcall = FUNCALL_ENTRY(arg_node);
+  node *signature = SYMBOLTABLE_SIGNATURE(SYMBOLTABLEENTRY_TABLE(funcall));
 
   node *link = SYMBOLTABLEENTRY_DECLARATION(funcall);
 
@@ -217,8 +318,7 @@ node *GBCfuncall(node *arg_node, info *arg_info)
   }
   else
   {
-    node *symbol_table = SYMBOLTABLEENTRY_TABLE(funcall);
-    fprintf(INFO_FILE(arg_info), "\tjsr %u %s\n", STcountParams(SYMBOLTABLE_ENTRIES(symbol_table)), FUNCALL_NAME(arg_node));
+    fprintf(INFO_FILE(arg_info), "\tjsr %d %s\n", SIGNATURE_PARAMCOUNT(signature), FUNCALL_NAME(arg_node));
   }
 
   DBUG_RETURN(arg_node);
@@ -228,8 +328,10 @@ node *GBCfundefs(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCfundefs");
 
-  TRAVdo(FUNDEFS_FUNDEF(arg_node), arg_info);
-  TRAVopt(FUNDEFS_NEXT(arg_node), arg_info);
+  for (node *fundefs = arg_node; fundefs != NULL; fundefs = FUNDEFS_NEXT(fundefs))
+  {
+    TRAVdo(FUNDEFS_FUNDEF(fundefs), arg_info);
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -238,30 +340,11 @@ node *GBCfundecl(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCfundecl");
 
-  node *symbol_table = INFO_SYMBOL_TABLE(arg_info);
-  node *fundecl = STfindFunc(symbol_table, FUNDECL_NAME(arg_node));
-  node *fundecl_entry = SYMBOLTABLE_ENTRIES(SYMBOLTABLEENTRY_TABLE(fundecl));
-
-  char *fundecl_params = NULL;
-
-  while (fundecl_entry)
-  {
-    if (SYMBOLTABLEENTRY_ISPARAMETER(fundecl_entry))
-    {
-      fundecl_params = STRcatn(3, fundecl_params, " ", HprintType(SYMBOLTABLEENTRY_TYPE(fundecl_entry)));
-    }
-
-    fundecl_entry = SYMBOLTABLEENTRY_NEXT(fundecl_entry);
-  }
-
-  const char *instruction_value = STRcatn(6, "fun \"", FUNDECL_NAME(arg_node), "\" ", HprintType(FUNDECL_TYPE(arg_node)), " ", fundecl_params ? fundecl_params : "");
+  node *signature = SYMBOLTABLE_SIGNATURE(FUNDECL_SYMBOLTABLE(arg_node));
 
-  node *cgtable_entry = TBmakeCodegentableentry(0, I_import, STRcpy(instruction_value), NULL);
-  node *cgtable_imports = CODEGENTABLE_IMPORTS(INFO_CODE_GEN_TABLE(arg_info));
+  node *cgtable_entry = TBmakeCodegentableentry(0, I_import, SIGNATURE_IMPORT(signature), NULL);
 
-  CODEGENTABLE_IMPORTS(INFO_CODE_GEN_TABLE(arg_info)) = addToCGTableEntries(cgtable_imports, cgtable_entry);
-
-  free(fundecl_params);
+  L_CODEGENTABLE_IMPORTS(INFO_CODE_GEN_TABLE(arg_info), addToCGTableEntries(CODEGENTABLE_IMPORTS(INFO_CODE_GEN_TABLE(arg_info)), &INFO_LAST_IMPORT(arg_info), cgtable_entry));
 
   DBUG_RETURN(arg_node);
 }
@@ -273,35 +356,18 @@ node *GBCfundef(node *arg_node, info *arg_info)
   fprintf(INFO_FILE(arg_info), "%s:\n", FUNDEF_NAME(arg_node));
 
   node *symbol_table = INFO_SYMBOL_TABLE(arg_info);
-  node *fundef = STfindFunc(symbol_table, FUNDEF_NAME(arg_node));
 
   if (FUNDEF_ISEXPORT(arg_node))
   {
-    node *fundef_entries = SYMBOLTABLE_ENTRIES(SYMBOLTABLEENTRY_TABLE(fundef));
-
-    char *fundef_params = NULL;
+    node *signature = SYMBOLTABLE_SIGNATURE(FUNDEF_SYMBOLTABLE(arg_node));
+    node *cgtable_entry = TBmakeCodegentableentry(0, I_export, SIGNATURE_EXPORT(signature), NULL);
 
-    while (fundef_entries)
-    {
-      if (SYMBOLTABLEENTRY_ISPARAMETER(fundef_entries))
-      {
-        fundef_params = STRcatn(3, fundef_params, " ", HprintType(SYMBOLTABLEENTRY_TYPE(fundef_entries)));
-      }
-
-      fundef_entries = SYMBOLTABLEENTRY_NEXT(fundef_entries);
-    }
-
-    const char *instruction_value = STRcatn(8, "fun \"", FUNDEF_NAME(arg_node), "\" ", HprintType(FUNDEF_TYPE(arg_node)), " ", fundef_params ? fundef_params : "", " ", FUNDEF_NAME(arg_node));
-
-    node *cgtable_entry = TBmakeCodegentableentry(0, I_export, STRcpy(instruction_value), NULL);
-    node *cgtable_exports = CODEGENTABLE_EXPORTS(INFO_CODE_GEN_TABLE(arg_info));
-
-    CODEGENTABLE_EXPORTS(INFO_CODE_GEN_TABLE(arg_info)) = addToCGTableEntries(cgtable_exports, cgtable_entry);
+    L_CODEGENTABLE_EXPORTS(INFO_CODE_GEN_TABLE(arg_info), addToCGTableEntries(CODEGENTABLE_EXPORTS(INFO_CODE_GEN_TABLE(arg_info)), &INFO_LAST_EXPORT(arg_info), cgtable_entry));
   }
 
   INFO_SYMBOL_TABLE(arg_info) = FUNDEF_SYMBOLTABLE(arg_node);
 
-  unsigned int registers = STcountVarDecls(SYMBOLTABLE_ENTRIES(INFO_SYMBOL_TABLE(arg_info)));
+  unsigned int registers = STcountVarDecls(INFO_SYMBOL_TABLE(arg_info));
 
   if (registers)
   {
@@ -339,7 +405,9 @@ node *GBCreturn(node *arg_node, info *arg_info)
 
   TRAVopt(RETURN_EXPR(arg_node), arg_info);
 
-  fprintf(INFO_FILE(arg_info), "\t%sreturn\n", typePrefix(INFO_CURRENT_TYPE(arg_info)));
+  const char *prefix = RETURN_EXPR(arg_node) ? typePrefix(HexprType(RETURN_EXPR(arg_node))) : NULL;
+
+  fprintf(INFO_FILE(arg_info), "\t%sreturn\n", prefix ? prefix : "");
 
   DBUG_RETURN(arg_node);
 }
@@ -433,12 +501,11 @@ node *GBCglobdecl(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCglobdecl");
 
-  char *instructions_value = STRcatn(4, "var \"", GLOBDECL_NAME(arg_node), "\" ", HprintType(GLOBDECL_TYPE(arg_node)));
+  char *instructions_value = internValue(STRcatn(4, "var \"", GLOBDECL_NAME(arg_node), "\" ", HprintType(GLOBDECL_TYPE(arg_node))));
 
   node *cgtable_entry = TBmakeCodegentableentry(0, I_import, instructions_value, NULL);
-  node *cgtable_imports = CODEGENTABLE_IMPORTS(INFO_CODE_GEN_TABLE(arg_info));
 
-  cgtable_imports = addToCGTableEntries(cgtable_imports, cgtable_entry);
+  L_CODEGENTABLE_IMPORTS(INFO_CODE_GEN_TABLE(arg_info), addToCGTableEntries(CODEGENTABLE_IMPORTS(INFO_CODE_GEN_TABLE(arg_info)), &INFO_LAST_IMPORT(arg_info), cgtable_entry));
 
   TRAVopt(GLOBDECL_DIMS(arg_node), arg_info);
 
@@ -454,20 +521,18 @@ node *GBCglobdef(node *arg_node, info *arg_info)
     node *globdef = STfindInParents(INFO_SYMBOL_TABLE(arg_info), GLOBDEF_NAME(arg_node));
 
     char *globdef_offset = STRitoa(SYMBOLTABLEENTRY_OFFSET(globdef));
-    char *instructions_value = STRcatn(4, "var \"", GLOBDEF_NAME(arg_node), "\" ", globdef_offset);
+    char *instructions_value = internValue(STRcatn(4, "var \"", GLOBDEF_NAME(arg_node), "\" ", globdef_offset));
 
     node *cgtable_entry = TBmakeCodegentableentry(0, I_export, instructions_value, NULL);
-    node *cgtable_exports = CODEGENTABLE_EXPORTS(INFO_CODE_GEN_TABLE(arg_info));
 
-    CODEGENTABLE_EXPORTS(INFO_CODE_GEN_TABLE(arg_info)) = addToCGTableEntries(cgtable_exports, cgtable_entry);
+    L_CODEGENTABLE_EXPORTS(INFO_CODE_GEN_TABLE(arg_info), addToCGTableEntries(CODEGENTABLE_EXPORTS(INFO_CODE_GEN_TABLE(arg_info)), &INFO_LAST_EXPORT(arg_info), cgtable_entry));
 
     free(globdef_offset);
   }
 
-  node *cg_table_globals = CODEGENTABLE_GLOBALS(INFO_CODE_GEN_TABLE(arg_info));
-  node *cgtable_entry = TBmakeCodegentableentry(0, I_global, STRcpy(HprintType(GLOBDEF_TYPE(arg_node))), NULL);
+  node *cgtable_entry = TBmakeCodegentableentry(0, I_global, NAMEintern(HprintType(GLOBDEF_TYPE(arg_node))), NULL);
 
-  CODEGENTABLE_GLOBALS(INFO_CODE_GEN_TABLE(arg_info)) = addToCGTableEntries(cg_table_globals, cgtable_entry);
+  L_CODEGENTABLE_GLOBALS(INFO_CODE_GEN_TABLE(arg_info), addToCGTableEntries(CODEGENTABLE_GLOBALS(INFO_CODE_GEN_TABLE(arg_info)), &INFO_LAST_GLOBAL(arg_info), cgtable_entry));
 
   TRAVopt(GLOBDEF_DIMS(arg_node), arg_info);
 
@@ -478,8 +543,10 @@ node *GBCparam(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCparam");
 
-  TRAVopt(PARAM_DIMS(arg_node), arg_info);
-  TRAVopt(PARAM_NEXT(arg_node), arg_info);
+  for (node *param = arg_node; param != NULL; param = PARAM_NEXT(param))
+  {
+    TRAVopt(PARAM_DIMS(param), arg_info);
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -488,9 +555,11 @@ node *GBCvardecl(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCvardecl");
 
-  TRAVopt(VARDECL_DIMS(arg_node), arg_info);
-  TRAVopt(VARDECL_INIT(arg_node), arg_info);
-  TRAVopt(VARDECL_NEXT(arg_node), arg_info);
+  for (node *vardecl = arg_node; vardecl != NULL; vardecl = VARDECL_NEXT(vardecl))
+  {
+    TRAVopt(VARDECL_DIMS(vardecl), arg_info);
+    TRAVopt(VARDECL_INIT(vardecl), arg_info);
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -499,8 +568,10 @@ node *GBCstmts(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCstmts");
 
-  TRAVdo(STMTS_STMT(arg_node), arg_info);
-  TRAVopt(STMTS_NEXT(arg_node), arg_info);
+  for (int i = 0; i < STMTS_COUNT(arg_node); i++)
+  {
+    TRAVdo(STMTS_STMT(arg_node, i), arg_info);
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -530,17 +601,18 @@ node *GBCvarlet(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCvarlet");
 
-  node *symbol_table = INFO_SYMBOL_TABLE(arg_info);
-  INFO_SYMBOL_TABLE_ENTRY(arg_info) = STfindInParents(symbol_table, VARLET_NAME(arg_node));
+  INFO_SYMBOL_TABLE_ENTRY(arg_info) = VARLET_ENTRY(arg_node);
 
   DBUG_RETURN(arg_node);
 }
 
-node *GBCbinop(node *arg_node, info *arg_info)
+/**
+ * Emits a binary operation whose left operand has been emitted.
+ */
+static void EmitBinop(node *arg_node, info *arg_info)
 {
-  DBUG_ENTER("GBCbinop");
+  DBUG_ENTER("EmitBinop");
 
-  TRAVdo(BINOP_LEFT(arg_node), arg_info);
   TRAVdo(BINOP_RIGHT(arg_node), arg_info);
 
   const char *operation;
@@ -583,15 +655,46 @@ node *GBCbinop(node *arg_node, info *arg_info)
   case BO_and:
   case BO_or:
   case BO_unknown:
-    CTIabortLine(NODE_LINE(arg_node), "Unknown operator type found");
+    CTIabortLine(LOCline(NODE_OFFSET(arg_node)), "Unknown operator type found");
     break;
   }
 
-  if (typePrefix(INFO_CURRENT_TYPE(arg_info)))
+  /*
+   * The instruction works on the type of the operands, which is that of
+   * the BinOp itself unless it compares. A comparison is a bool, so its
+   * operands give the type; type checking lets int and bool operands mix,
+   * and the right operand decides then.
+   */
+  type operand_type = HisBooleanOperator(BINOP_OP(arg_node)) ? HexprType(BINOP_RIGHT(arg_node)) : HexprType(arg_node);
+
+  if (typePrefix(operand_type))
+  {
+    fprintf(INFO_FILE(arg_info), "\t%s%s\n", typePrefix(operand_type), operation);
+  }
+
+  DBUG_VOID_RETURN;
+}
+
+/**
+ * Chains nested through the left operand are emitted innermost first in a
+ * loop rather than by recursion.
+ */
+node *GBCbinop(node *arg_node, info *arg_info)
+{
+  DBUG_ENTER("GBCbinop");
+
+  int count;
+  node **spine = HbinopSpine(arg_node, &count);
+
+  TRAVdo(BINOP_LEFT(spine[count - 1]), arg_info);
+
+  for (int i = count - 1; i >= 0; i--)
   {
-    fprintf(INFO_FILE(arg_info), "\t%s%s\n", typePrefix(INFO_CURRENT_TYPE(arg_info)), operation);
+    EmitBinop(spine[i], arg_info);
   }
 
+  MEMfree(spine);
+
   DBUG_RETURN(arg_node);
 }
 
@@ -615,9 +718,9 @@ node *GBCmonop(node *arg_node, info *arg_info)
     break;
   }
 
-  if (typePrefix(INFO_CURRENT_TYPE(arg_info)))
+  if (typePrefix(MONOP_TYPE(arg_node)))
   {
-    fprintf(INFO_FILE(arg_info), "\t%s%s\n", typePrefix(INFO_CURRENT_TYPE(arg_info)), operation);
+    fprintf(INFO_FILE(arg_info), "\t%s%s\n", typePrefix(MONOP_TYPE(arg_node)), operation);
   }
 
   DBUG_RETURN(arg_node);
@@ -629,7 +732,7 @@ node *GBCcast(node *arg_node, info *arg_info)
 
   TRAVdo(CAST_EXPR(arg_node), arg_info);
 
-  if (INFO_CURRENT_TYPE(arg_info) != CAST_TYPE(arg_node))
+  if (HexprType(CAST_EXPR(arg_node)) != CAST_TYPE(arg_node))
   {
 
     if (CAST_TYPE(arg_node) == T_int)
@@ -642,8 +745,6 @@ node *GBCcast(node *arg_node, info *arg_info)
     }
   }
 
-  INFO_CURRENT_TYPE(arg_info) = CAST_TYPE(arg_node);
-
   DBUG_RETURN(arg_node);
 }
 
@@ -652,9 +753,7 @@ node *GBCvar(node *arg_node, info *arg_info)
   DBUG_ENTER("GBCvar");
 
   node *var_decl = VAR_DECL(arg_node);
-  node *vardecl_entry = STfindByDeclInParents(INFO_SYMBOL_TABLE(arg_info), var_decl);
-
-  INFO_CURRENT_TYPE(arg_info) = SYMBOLTABLEENTRY_TYPE(vardecl_entry);
+  node *vardecl_entry = VAR_ENTRY(arg_node);
 
   if (NODE_TYPE(var_decl) == N_globdef)
   {
@@ -682,26 +781,9 @@ node *GBCnum(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCnum");
 
-  char *instruction_value = STRcat("int ", STRitoa(NUM_VALUE(arg_node)));
-
-  node *cgtable_constants = CODEGENTABLE_CONSTANTS(INFO_CODE_GEN_TABLE(arg_info));
-  node *constant_entry = SearchInCGTableEntries(cgtable_constants, instruction_value);
-
-  if (constant_entry)
-  {
-    fprintf(INFO_FILE(arg_info), "\t%s %u\n", "iloadc", CODEGENTABLEENTRY_INDEX(constant_entry));
-    free(instruction_value);
-  }
-  else
-  {
-    node *cgtable_entry = TBmakeCodegentableentry(INFO_LOAD_CONSTS_COUNTER(arg_info), I_constant, instruction_value, NULL);
-    fprintf(INFO_FILE(arg_info), "\t%s %d\n", "iloadc", CODEGENTABLEENTRY_INDEX(cgtable_entry));
-
-    CODEGENTABLE_CONSTANTS(INFO_CODE_GEN_TABLE(arg_info)) = addToCGTableEntries(cgtable_constants, cgtable_entry);
-    INFO_LOAD_CONSTS_COUNTER(arg_info) += 1;
-  }
+  char *instruction_value = internValue(STRcat("int ", STRitoa(NUM_VALUE(arg_node))));
 
-  INFO_CURRENT_TYPE(arg_info) = T_int;
+  EmitLoadConstant("iloadc", instruction_value, arg_info);
 
   DBUG_RETURN(arg_node);
 }
@@ -710,26 +792,9 @@ node *GBCfloat(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCfloat");
 
-  char *instruction_value = STRcat("float ", STRitoa(FLOAT_VALUE(arg_node)));
-
-  node *cgtable_constants = CODEGENTABLE_CONSTANTS(INFO_CODE_GEN_TABLE(arg_info));
-  node *constant_entry = SearchInCGTableEntries(cgtable_constants, instruction_value);
-
-  if (constant_entry)
-  {
-    fprintf(INFO_FILE(arg_info), "\t%s %u\n", "floadc", CODEGENTABLEENTRY_INDEX(constant_entry));
-    free(instruction_value);
-  }
-  else
-  {
-    node *cgtable_entry = TBmakeCodegentableentry(INFO_LOAD_CONSTS_COUNTER(arg_info), I_constant, instruction_value, NULL);
-    fprintf(INFO_FILE(arg_info), "\t%s %d\n", "floadc", CODEGENTABLEENTRY_INDEX(cgtable_entry));
-
-    CODEGENTABLE_CONSTANTS(INFO_CODE_GEN_TABLE(arg_info)) = addToCGTableEntries(cgtable_constants, cgtable_entry);
-    INFO_LOAD_CONSTS_COUNTER(arg_info) += 1;
-  }
+  char *instruction_value = internValue(STRcat("float ", STRitoa(FLOAT_VALUE(arg_node))));
 
-  INFO_CURRENT_TYPE(arg_info) = T_float;
+  EmitLoadConstant("floadc", instruction_value, arg_info);
 
   DBUG_RETURN(arg_node);
 }
@@ -738,26 +803,9 @@ node *GBCbool(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCbool");
 
-  char *instruction_value = STRcat("bool ", BOOL_VALUE(arg_node) ? "true" : "false");
-
-  node *cgtable_constants = CODEGENTABLE_CONSTANTS(INFO_CODE_GEN_TABLE(arg_info));
-  node *constant_entry = SearchInCGTableEntries(cgtable_constants, instruction_value);
+  char *instruction_value = internValue(STRcat("bool ", BOOL_VALUE(arg_node) ? "true" : "false"));
 
-  if (constant_entry)
-  {
-    fprintf(INFO_FILE(arg_info), "\t%s %u\n", "bloadc", CODEGENTABLEENTRY_INDEX(constant_entry));
-    free(instruction_value);
-  }
-  else
-  {
-    node *cgtable_entry = TBmakeCodegentableentry(INFO_LOAD_CONSTS_COUNTER(arg_info), I_constant, instruction_value, NULL);
-    fprintf(INFO_FILE(arg_info), "\t%s %d\n", "bloadc", CODEGENTABLEENTRY_INDEX(cgtable_entry));
-
-    CODEGENTABLE_CONSTANTS(INFO_CODE_GEN_TABLE(arg_info)) = addToCGTableEntries(cgtable_constants, cgtable_entry);
-    INFO_LOAD_CONSTS_COUNTER(arg_info) += 1;
-  }
-
-  INFO_CURRENT_TYPE(arg_info) = T_bool;
+  EmitLoadConstant("bloadc", instruction_value, arg_info);
 
   DBUG_RETURN(arg_node);
 }
@@ -766,31 +814,62 @@ node *GBCerror(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCerror");
 
-  ERROR_NEXT(arg_node) = TRAVopt(ERROR_NEXT(arg_node), arg_info);
+  L_ERROR_NEXT(arg_node, TRAVopt(ERROR_NEXT(arg_node), arg_info));
 
   DBUG_RETURN(arg_node);
 }
 
-node *GBCternary(node *arg_node, info *arg_info)
+/**
+ * Emits a ternary whose condition has been emitted, jumping to false_branch
+ * when the condition does not hold.
+ */
+static void EmitTernary(node *arg_node, char *false_branch, info *arg_info)
 {
-  DBUG_ENTER("GBCternary");
-
-  char *false_branch = createBranch("false_expr", arg_info);
-
-  TERNARY_COND(arg_node) = TRAVopt(TERNARY_COND(arg_node), arg_info);
+  DBUG_ENTER("EmitTernary");
 
   fprintf(INFO_FILE(arg_info), "\tbranch_f %s\n", false_branch);
 
-  TERNARY_THEN(arg_node) = TRAVopt(TERNARY_THEN(arg_node), arg_info);
+  L_TERNARY_THEN(arg_node, TRAVopt(TERNARY_THEN(arg_node), arg_info));
   char *end_branch = createBranch("end", arg_info);
 
   fprintf(INFO_FILE(arg_info), "\tjump %s\n", end_branch);
   fprintf(INFO_FILE(arg_info), "%s:\n", false_branch);
 
-  TERNARY_ELSE(arg_node) = TRAVopt(TERNARY_ELSE(arg_node), arg_info);
+  L_TERNARY_ELSE(arg_node, TRAVopt(TERNARY_ELSE(arg_node), arg_info));
 
   fprintf(INFO_FILE(arg_info), "%s:\n", end_branch);
 
+  DBUG_VOID_RETURN;
+}
+
+/**
+ * Ternaries nested through their condition, as produced for || and && chains,
+ * are emitted innermost first in a loop rather than by recursion. Their false
+ * branches are numbered outermost first, as a recursive walk would.
+ */
+node *GBCternary(node *arg_node, info *arg_info)
+{
+  DBUG_ENTER("GBCternary");
+
+  int count;
+  node **spine = HternarySpine(arg_node, &count);
+  char **false_branches = MEMmalloc(count * sizeof(char *));
+
+  for (int i = 0; i < count; i++)
+  {
+    false_branches[i] = createBranch("false_expr", arg_info);
+  }
+
+  L_TERNARY_COND(spine[count - 1], TRAVopt(TERNARY_COND(spine[count - 1]), arg_info));
+
+  for (int i = count - 1; i >= 0; i--)
+  {
+    EmitTernary(spine[i], false_branches[i], arg_info);
+  }
+
+  MEMfree(false_branches);
+  MEMfree(spine);
+
   DBUG_RETURN(arg_node);
 }
 
@@ -798,10 +877,10 @@ node *GBCcodegentable(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBCcodegentable");
 
-  CODEGENTABLE_IMPORTS(arg_node) = TRAVopt(CODEGENTABLE_IMPORTS(arg_node), arg_info);
-  CODEGENTABLE_CONSTANTS(arg_node) = TRAVopt(CODEGENTABLE_CONSTANTS(arg_node), arg_info);
-  CODEGENTABLE_GLOBALS(arg_node) = TRAVopt(CODEGENTABLE_GLOBALS(arg_node), arg_info);
-  CODEGENTABLE_EXPORTS(arg_node) = TRAVopt(CODEGENTABLE_EXPORTS(arg_node), arg_info);
+  L_CODEGENTABLE_IMPORTS(arg_node, TRAVopt(CODEGENTABLE_IMPORTS(arg_node), arg_info));
+  L_CODEGENTABLE_CONSTANTS(arg_node, TRAVopt(CODEGENTABLE_CONSTANTS(arg_node), arg_info));
+  L_CODEGENTABLE_GLOBALS(arg_node, TRAVopt(CODEGENTABLE_GLOBALS(arg_node), arg_info));
+  L_CODEGENTABLE_EXPORTS(arg_node, TRAVopt(CODEGENTABLE_EXPORTS(arg_node), arg_info));
 
   DBUG_RETURN(arg_node);
 }
@@ -815,30 +894,31 @@ node *GBCcodegentableentry(node *arg_node, info *arg_info)
 
   FILE *fileptr = INFO_FILE(arg_info);
 
-  const char *pseudo_instruction;
-
-  switch (CODEGENTABLEENTRY_INSTRUCTION(arg_node))
+  for (node *entry = arg_node; entry != NULL; entry = CODEGENTABLEENTRY_NEXT(entry))
   {
-  case I_constant:
-    pseudo_instruction = ".const ";
-    break;
-  case I_export:
-    pseudo_instruction = ".export";
-    break;
-  case I_global:
-    pseudo_instruction = ".global ";
-    break;
-  case I_import:
-    pseudo_instruction = ".import";
-    break;
-  case I_unknown:
-  default:
-    DBUG_RETURN(arg_node);
-  }
+    const char *pseudo_instruction;
 
-  fprintf(fileptr, "%s%s\n", pseudo_instruction, CODEGENTABLEENTRY_VALUE(arg_node));
+    switch (CODEGENTABLEENTRY_INSTRUCTION(entry))
+    {
+    case I_constant:
+      pseudo_instruction = ".const ";
+      break;
+    case I_export:
+      pseudo_instruction = ".export";
+      break;
+    case I_global:
+      pseudo_instruction = ".global ";
+      break;
+    case I_import:
+      pseudo_instruction = ".import";
+      break;
+    case I_unknown:
+    default:
+      DBUG_RETURN(arg_node);
+    }
 
-  CODEGENTABLEENTRY_NEXT(arg_node) = TRAVopt(CODEGENTABLEENTRY_NEXT(arg_node), arg_info);
+    fprintf(fileptr, "%s%s\n", pseudo_instruction, CODEGENTABLEENTRY_VALUE(entry));
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -855,6 +935,12 @@ node *GBCsymboltableentry(node *arg_node, info *arg_info)
   DBUG_RETURN(arg_node);
 }
 
+node *GBCsignature(node *arg_node, info *arg_info)
+{
+  DBUG_ENTER("GBCsignature");
+  DBUG_RETURN(arg_node);
+}
+
 node *GBClinkedvalue(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("GBClinkedvalue");
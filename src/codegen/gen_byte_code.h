@@ -5,6 +5,7 @@
 extern node *GBCprogram (node *arg_node, info *arg_info);
 extern node *GBCsymboltable (node *arg_node, info *arg_info);
 extern node *GBCsymboltableentry (node *arg_node, info *arg_info);
+extern node *GBCsignature (node *arg_node, info *arg_info);
 extern node *GBCdecls (node *arg_node, info *arg_info);
 extern node *GBCexprs (node *arg_node, info *arg_info);
 extern node *GBCarrexpr (node *arg_node, info *arg_info);
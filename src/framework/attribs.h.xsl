@@ -64,6 +64,7 @@
   <xsl:import href="common-key-tables.xsl"/>
   <xsl:import href="common-travfun.xsl"/>
   <xsl:import href="common-name-to-nodeenum.xsl"/>
+  <xsl:import href="common-layout.xsl"/>
 
   <xsl:output method="text" indent="no"/>
   <xsl:strip-space elements="*"/>
@@ -89,9 +90,16 @@
 
     </xsl:text>
     <!-- start phase that generates a struct of attributes for each node -->
-    <xsl:apply-templates select="/definition/syntaxtree" mode="generate-attrib-structs"/>
-    <!-- start phase that unites all attribute structs to one union -->
-    <xsl:apply-templates select="/definition/syntaxtree" mode="generate-attrib-union"/>
+    <xsl:choose>
+      <xsl:when test="$layout != 'split'">
+        <xsl:apply-templates select="/definition/syntaxtree" mode="generate-packed-union"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:apply-templates select="/definition/syntaxtree" mode="generate-attrib-structs"/>
+        <!-- start phase that unites all attribute structs to one union -->
+        <xsl:apply-templates select="/definition/syntaxtree" mode="generate-attrib-union"/>
+      </xsl:otherwise>
+    </xsl:choose>
     <xsl:text>
 #endif /* _SAC_ATTRIBS_H_ */
     </xsl:text>
@@ -169,6 +177,16 @@
     </xsl:apply-templates>
     <xsl:value-of select="'} ; '"/>
   </xsl:template>
+
+  <!-- in the packed layout, attributes are stored in the SONUNION -->
+  <xsl:template match="syntaxtree" mode="generate-packed-union">
+    <xsl:text>
+/*****************************************************************************
+ * The packed layout stores all attributes in the SONUNION, see sons.h.
+ ****************************************************************************/
+    </xsl:text>
+    <xsl:value-of select="'struct ATTRIBUNION { } ; '"/>
+  </xsl:template>
  
   <!-- generate an entry for each node within the union -->
   <xsl:template match="node" mode="generate-attrib-union">
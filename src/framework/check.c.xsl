@@ -231,7 +231,7 @@ node *CHKdoTreeCheck( node *syntax_tree)
       <xsl:with-param name="name"><xsl:value-of select="@name" /></xsl:with-param>
     </xsl:call-template>
     <xsl:value-of select="'{'"/>  
-    <xsl:if test="attributes/attribute[key(&quot;arraytypes&quot;, ./type/@name)]">
+    <xsl:if test="attributes/attribute[key(&quot;arraytypes&quot;, ./type/@name)] or sons/son[@list = 'yes']">
       <xsl:value-of select="'int cnt;'" />
     </xsl:if>
     <xsl:value-of select="'DBUG_ENTER'"/>
@@ -281,12 +281,28 @@ node *CHKdoTreeCheck( node *syntax_tree)
     <xsl:text> 
  */
     </xsl:text>
+    <!-- every item of a list son is checked -->
+    <xsl:if test="@list = 'yes'">
+      <xsl:value-of select="'for( cnt = 0; cnt &lt; '" />
+      <xsl:call-template name="upper_uppername">
+        <xsl:with-param name="name1">
+          <xsl:value-of select="../../@name" />
+        </xsl:with-param>
+        <xsl:with-param name="name2">
+          <xsl:value-of select="'Count'"/>
+        </xsl:with-param>
+      </xsl:call-template>
+      <xsl:value-of select="'( arg_node); cnt++) { '" />
+    </xsl:if>
     <xsl:apply-templates select="targets/target" mode="sons-check">
       <xsl:sort select="@name"/>
     </xsl:apply-templates>
     <xsl:value-of select="'{'"/>
     <xsl:call-template name="notexist" />
     <xsl:value-of select="'}'"/>
+    <xsl:if test="@list = 'yes'">
+      <xsl:value-of select="'}'"/>
+    </xsl:if>
   </xsl:template>
 
 
@@ -396,6 +412,11 @@ node *CHKdoTreeCheck( node *syntax_tree)
       <xsl:with-param name="field">
         <xsl:value-of select="../../@name"/>
       </xsl:with-param>
+      <xsl:with-param name="index">
+        <xsl:if test="../../@list = 'yes'">
+          <xsl:value-of select="'cnt'"/>
+        </xsl:if>
+      </xsl:with-param>
     </xsl:call-template>
     <xsl:value-of select="','"/>
     <xsl:value-of select="'arg_node'"/>
@@ -429,7 +450,10 @@ node *CHKdoTreeCheck( node *syntax_tree)
         <xsl:value-of select="../../@name"/>
       </xsl:with-param>
     </xsl:call-template>
-    <xsl:value-of select="'( arg_node) != NULL){'"/>
+    <xsl:call-template name="son-arguments">
+      <xsl:with-param name="son" select="../.."/>
+    </xsl:call-template>
+    <xsl:value-of select="' != NULL){'"/>
     <xsl:value-of select="'if( !(( FALSE)'"/>
     <xsl:apply-templates select="./*" mode="correctson" />
     <xsl:value-of select="'))'" />
@@ -592,7 +616,7 @@ node *CHKdoTreeCheck( node *syntax_tree)
         <xsl:value-of select="@name"/>
       </xsl:with-param>
       <xsl:with-param name="index">
-        <xsl:if test="key(&quot;arraytypes&quot;, ./type/@name)">
+        <xsl:if test="key(&quot;arraytypes&quot;, ./type/@name) or @list = 'yes'">
           <xsl:value-of select="'cnt'"/>
         </xsl:if>
       </xsl:with-param>
@@ -661,7 +685,7 @@ node *CHKdoTreeCheck( node *syntax_tree)
       </xsl:with-param>
     </xsl:call-template>
     <xsl:value-of select="' != NULL) {'"/>
-    <xsl:call-template name="node-access">
+    <xsl:call-template name="node-set">
       <xsl:with-param name="node">arg_node</xsl:with-param>
       <xsl:with-param name="nodetype">
         <xsl:value-of select="../../@name"/>
@@ -669,18 +693,65 @@ node *CHKdoTreeCheck( node *syntax_tree)
       <xsl:with-param name="field">
         <xsl:value-of select="@name"/>
       </xsl:with-param>
+      <xsl:with-param name="value">
+        <xsl:value-of select="'TRAVdo( '"/>
+        <xsl:call-template name="node-access">
+          <xsl:with-param name="node">arg_node</xsl:with-param>
+          <xsl:with-param name="nodetype">
+            <xsl:value-of select="../../@name"/>
+          </xsl:with-param>
+          <xsl:with-param name="field">
+            <xsl:value-of select="@name"/>
+          </xsl:with-param>
+        </xsl:call-template>
+        <xsl:value-of select="', arg_info)'"/>
+      </xsl:with-param>
     </xsl:call-template>
-    <xsl:value-of select="'= TRAVdo( '"/>
-    <xsl:call-template name="node-access">
-      <xsl:with-param name="node">arg_node</xsl:with-param>
-      <xsl:with-param name="nodetype">
-        <xsl:value-of select="../../@name"/>
+    <xsl:value-of select="';}'"/>
+  </xsl:template>
+  
+
+
+
+
+  <xsl:template match="son[@list = 'yes']" mode="trav">
+    <xsl:variable name="item">
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node">arg_node</xsl:with-param>
+        <xsl:with-param name="nodetype">
+          <xsl:value-of select="../../@name"/>
+        </xsl:with-param>
+        <xsl:with-param name="field">
+          <xsl:value-of select="@name"/>
+        </xsl:with-param>
+        <xsl:with-param name="index">cnt</xsl:with-param>
+      </xsl:call-template>
+    </xsl:variable>
+    <xsl:text>
+
+/*
+ * trav functions: to get all items of the list son
+ */
+    </xsl:text>
+    <xsl:value-of select="'for( cnt = 0; cnt &lt; '" />
+    <xsl:call-template name="upper_uppername">
+      <xsl:with-param name="name1">
+        <xsl:value-of select="../../@name" />
       </xsl:with-param>
-      <xsl:with-param name="field">
-        <xsl:value-of select="@name"/>
+      <xsl:with-param name="name2">
+        <xsl:value-of select="'Count'"/>
       </xsl:with-param>
     </xsl:call-template>
-    <xsl:value-of select="', arg_info);'"/>
+    <xsl:value-of select="'( arg_node); cnt++) { '" />
+    <xsl:value-of select="concat( 'if ( ', $item, ' != NULL) {')"/>
+    <xsl:call-template name="node-set">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+      <xsl:with-param name="index">cnt</xsl:with-param>
+      <xsl:with-param name="value" select="concat( 'TRAVdo( ', $item, ', arg_info)')"/>
+    </xsl:call-template>
+    <xsl:value-of select="';}'"/>
     <xsl:value-of select="'}'"/>
   </xsl:template>
   
@@ -735,7 +806,9 @@ node *CHKdoTreeCheck( node *syntax_tree)
         <xsl:value-of select="../../../@name"/> <!-- son name -->
       </xsl:with-param>
     </xsl:call-template>
-    <xsl:value-of select="'(arg_node)'"/>
+    <xsl:call-template name="son-arguments">
+      <xsl:with-param name="son" select="../../.."/>
+    </xsl:call-template>
     <xsl:value-of select="') == '"/>
     <xsl:value-of select="'N_'"/>
     <xsl:call-template name="lowercase">
@@ -758,7 +831,9 @@ node *CHKdoTreeCheck( node *syntax_tree)
         <xsl:value-of select="../../../@name"/>
       </xsl:with-param>
     </xsl:call-template>
-    <xsl:value-of select="'(arg_node)'"/>
+    <xsl:call-template name="son-arguments">
+      <xsl:with-param name="son" select="../../.."/>
+    </xsl:call-template>
     <xsl:value-of select="'))'"/>
   </xsl:template>
 
@@ -820,6 +895,21 @@ node *CHKdoTreeCheck( node *syntax_tree)
   </xsl:template>
 
 
+  <!-- the arguments of the accessor of a son: the item of a list son is
+       selected by the counter of the loop over them -->
+  <xsl:template name="son-arguments">
+    <xsl:param name="son" />
+    <xsl:choose>
+      <xsl:when test="$son/@list = 'yes'">
+        <xsl:value-of select="'( arg_node, cnt)'"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="'( arg_node)'"/>
+      </xsl:otherwise>
+    </xsl:choose>
+  </xsl:template>
+
+
   <xsl:template name="check_correct_output">
     <xsl:param name="name1" />
     <xsl:param name="name2" />
@@ -182,6 +182,10 @@ DBUG_RETURN( arg_node);
   <xsl:if test="attributes/attribute[key(&quot;arraytypes&quot;, ./type/@name)]">
     <xsl:value-of select="'int cnt;'" />
   </xsl:if>
+  <!-- counter for the items of a list son -->
+  <xsl:if test="sons/son[@list = 'yes']">
+    <xsl:value-of select="'int i;'" />
+  </xsl:if>
   <!-- DBUG_ENTER statement -->
   <xsl:value-of select="'DBUG_ENTER( &quot;CHKM'"/>
   <xsl:call-template name="lowercase" >
@@ -231,6 +235,44 @@ DBUG_RETURN( arg_node);
 </xsl:template>
 
 
+<!--
+     traversal main son[@list]
+
+     calls CHKMTRAV for every item of a list son
+-->
+
+<xsl:template match="son[@list = 'yes']">
+  <xsl:variable name="item">
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype">
+        <xsl:value-of select="../../@name"/>
+      </xsl:with-param>
+      <xsl:with-param name="field">
+        <xsl:value-of select="@name"/>
+      </xsl:with-param>
+      <xsl:with-param name="index">i</xsl:with-param>
+    </xsl:call-template>
+  </xsl:variable>
+  <xsl:value-of select="'for (i = 0; i &lt; '"/>
+  <xsl:call-template name="node-access">
+    <xsl:with-param name="node">arg_node</xsl:with-param>
+    <xsl:with-param name="nodetype">
+      <xsl:value-of select="../../@name"/>
+    </xsl:with-param>
+    <xsl:with-param name="field">Count</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="'; i++) { '"/>
+  <xsl:call-template name="node-set">
+    <xsl:with-param name="node">arg_node</xsl:with-param>
+    <xsl:with-param name="nodetype" select="../../@name"/>
+    <xsl:with-param name="field" select="@name"/>
+    <xsl:with-param name="index">i</xsl:with-param>
+    <xsl:with-param name="value" select="concat( 'CHKMTRAV( ', $item, ' , arg_info)')"/>
+  </xsl:call-template>
+  <xsl:value-of select="'; }'"/>
+</xsl:template>
+
 <!--
      traversal main son
 
@@ -238,7 +280,7 @@ DBUG_RETURN( arg_node);
 
      example:
 
-     ARG_NEXT( arg_node) = CHKMTRAV( ARG_NEXT( arg_node), arg_info);
+     L_ARG_NEXT( arg_node, CHKMTRAV( ARG_NEXT( arg_node), arg_info));
 
      remarks:
  
@@ -246,7 +288,7 @@ DBUG_RETURN( arg_node);
 -->
      
 <xsl:template match="son">
-  <xsl:call-template name="node-access">
+  <xsl:call-template name="node-set">
     <xsl:with-param name="node">arg_node</xsl:with-param>
     <xsl:with-param name="nodetype">
       <xsl:value-of select="../../@name"/>
@@ -254,18 +296,21 @@ DBUG_RETURN( arg_node);
     <xsl:with-param name="field">
       <xsl:value-of select="@name"/>
     </xsl:with-param>
-  </xsl:call-template>
-  <xsl:value-of select="' = CHKMTRAV( '" />
-  <xsl:call-template name="node-access">
-    <xsl:with-param name="node">arg_node</xsl:with-param>
-    <xsl:with-param name="nodetype">
-      <xsl:value-of select="../../@name"/>
-    </xsl:with-param>
-    <xsl:with-param name="field">
-      <xsl:value-of select="@name"/>
+    <xsl:with-param name="value">
+      <xsl:value-of select="'CHKMTRAV( '" />
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node">arg_node</xsl:with-param>
+        <xsl:with-param name="nodetype">
+          <xsl:value-of select="../../@name"/>
+        </xsl:with-param>
+        <xsl:with-param name="field">
+          <xsl:value-of select="@name"/>
+        </xsl:with-param>
+      </xsl:call-template>
+      <xsl:value-of select="' , arg_info)'"/>
     </xsl:with-param>
   </xsl:call-template>
-  <xsl:value-of select="' , arg_info);'"/>
+  <xsl:value-of select="';'"/>
 </xsl:template>
 
 
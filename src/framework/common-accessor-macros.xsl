@@ -61,11 +61,13 @@ version="1.0">
 <xsl:import href="common-c-code.xsl"/>
 <xsl:import href="common-node-access.xsl"/>
 <xsl:import href="common-name-to-nodeenum.xsl"/>
+<xsl:import href="common-layout.xsl"/>
 
 <xsl:output method="text" indent="no"/>
 <xsl:strip-space elements="*"/>
 
-<!-- generate accessors for nodes -->
+<!-- generate accessors for nodes: a son is read with X_Y( n), which is
+     an lvalue unless sons are handles, and set with L_X_Y( n, son) -->
 <xsl:template match="son" mode="accessor-macros">
   <xsl:value-of select="'#define '"/>
   <xsl:call-template name="node-access">
@@ -77,16 +79,112 @@ version="1.0">
       <xsl:value-of select="@name" />
     </xsl:with-param>
   </xsl:call-template>
-  <xsl:value-of select="'((n)->sons.'"/> 
+  <xsl:call-template name="son-read">
+    <xsl:with-param name="slot">
+      <xsl:call-template name="son-slot">
+        <xsl:with-param name="node">n</xsl:with-param>
+        <xsl:with-param name="nodetype" select="../../@name" />
+        <xsl:with-param name="field" select="@name" />
+      </xsl:call-template>
+    </xsl:with-param>
+  </xsl:call-template>
+  <xsl:call-template name="newline"/>
+  <xsl:value-of select="'#define '"/>
+  <xsl:call-template name="node-set">
+    <xsl:with-param name="node">n</xsl:with-param>
+    <xsl:with-param name="nodetype" select="../../@name" />
+    <xsl:with-param name="field" select="@name" />
+    <xsl:with-param name="value">x</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="'('"/>
+  <xsl:call-template name="son-slot">
+    <xsl:with-param name="node">n</xsl:with-param>
+    <xsl:with-param name="nodetype" select="../../@name" />
+    <xsl:with-param name="field" select="@name" />
+  </xsl:call-template>
+  <xsl:value-of select="' = TBhandle( x))'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+<!-- a list son has an accessor and a setter for its items, and an
+     accessor for their number -->
+<xsl:template match="son[@list = 'yes']" mode="accessor-macros">
+  <xsl:value-of select="'#define '"/>
+  <xsl:call-template name="node-access">
+    <xsl:with-param name="node">n</xsl:with-param>
+    <xsl:with-param name="nodetype">
+      <xsl:value-of select="../../@name" />
+    </xsl:with-param>
+    <xsl:with-param name="field">
+      <xsl:value-of select="@name" />
+    </xsl:with-param>
+    <xsl:with-param name="index">x</xsl:with-param>
+  </xsl:call-template>
+  <xsl:call-template name="son-read">
+    <xsl:with-param name="slot">
+      <xsl:call-template name="son-slot">
+        <xsl:with-param name="node">n</xsl:with-param>
+        <xsl:with-param name="nodetype" select="../../@name" />
+        <xsl:with-param name="field" select="@name" />
+        <xsl:with-param name="index">x</xsl:with-param>
+      </xsl:call-template>
+    </xsl:with-param>
+  </xsl:call-template>
+  <xsl:call-template name="newline"/>
+  <xsl:value-of select="'#define '"/>
+  <xsl:call-template name="node-set">
+    <xsl:with-param name="node">n</xsl:with-param>
+    <xsl:with-param name="nodetype" select="../../@name" />
+    <xsl:with-param name="field" select="@name" />
+    <xsl:with-param name="index">i</xsl:with-param>
+    <xsl:with-param name="value">x</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="'('"/>
+  <xsl:call-template name="son-slot">
+    <xsl:with-param name="node">n</xsl:with-param>
+    <xsl:with-param name="nodetype" select="../../@name" />
+    <xsl:with-param name="field" select="@name" />
+    <xsl:with-param name="index">i</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="' = TBhandle( x))'"/>
+  <xsl:call-template name="newline"/>
+  <xsl:value-of select="'#define '"/>
+  <xsl:call-template name="node-access">
+    <xsl:with-param name="node">n</xsl:with-param>
+    <xsl:with-param name="nodetype">
+      <xsl:value-of select="../../@name" />
+    </xsl:with-param>
+    <xsl:with-param name="field">Count</xsl:with-param>
+  </xsl:call-template>
+  <xsl:call-template name="list-access"/>
+  <xsl:value-of select="'.count)'" />
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+<!-- the right side of a son accessor: the slot itself, or the node of
+     the handle in it -->
+<xsl:template name="son-read">
+  <xsl:param name="slot"/>
+  <xsl:choose>
+    <xsl:when test="$layout = 'handles'">
+      <xsl:value-of select="concat( '(TBnode( ', $slot, '))')"/>
+    </xsl:when>
+    <xsl:otherwise>
+      <xsl:value-of select="concat( '(', $slot, ')')"/>
+    </xsl:otherwise>
+  </xsl:choose>
+</xsl:template>
+
+<!-- start of the right side of a list son macro, up to the list -->
+<xsl:template name="list-access">
+  <xsl:value-of select="'((n)->sons.'"/>
   <xsl:call-template name="name-to-nodeenum">
     <xsl:with-param name="name">
       <xsl:value-of select="../../@name"/>
     </xsl:with-param>
   </xsl:call-template>
-  <xsl:value-of select="'->'" />
+  <xsl:call-template name="layout-member"/>
   <xsl:value-of select="@name" />
-  <xsl:value-of select="')'" />
-  <xsl:call-template name="newline"/>
 </xsl:template>
 
 <!-- generate accessors for attributes -->
@@ -109,13 +207,13 @@ version="1.0">
     </xsl:with-param>
   </xsl:call-template>
   <!-- generate right side of macro -->
-  <xsl:value-of select="'((n)->attribs.'"/> 
+  <xsl:call-template name="layout-attribs"/>
   <xsl:call-template name="name-to-nodeenum">
     <xsl:with-param name="name">
       <xsl:value-of select="../../@name"/>
     </xsl:with-param>
   </xsl:call-template>
-  <xsl:value-of select="'->'"/>
+  <xsl:call-template name="layout-member"/>
   <xsl:value-of select="@name"/>
   <!-- if the attribute is an array, we need to add the index to the macro -->
   <xsl:if test="key( &quot;arraytypes&quot;, ./type/@name)">
@@ -127,30 +225,58 @@ version="1.0">
 
 <!-- generate macros for flags -->
 <xsl:template match="flags[flag]" mode="accessor-macros" >
-  <xsl:value-of select="'#define '"/>
-  <!-- generate left side of macro -->
-  <xsl:call-template name="node-access">
-    <xsl:with-param name="node">n</xsl:with-param>
-    <xsl:with-param name="nodetype">
-      <xsl:value-of select="../@name" />
-    </xsl:with-param>
-    <xsl:with-param name="field">
-      <xsl:value-of select="'FlagStructure'" />
-    </xsl:with-param>
-  </xsl:call-template>
-  <!-- generate right side of macro -->
-  <xsl:value-of select="'((n)->attribs.'"/> 
-  <xsl:call-template name="name-to-nodeenum">
-    <xsl:with-param name="name">
-      <xsl:value-of select="../@name"/>
-    </xsl:with-param>
-  </xsl:call-template>
-  <xsl:value-of select="'->flags'"/>
-  <xsl:value-of select="')'" />
-  <xsl:call-template name="newline"/>
+  <!-- packed flags are not grouped, so there is no FlagStructure -->
+  <xsl:if test="$layout = 'split'">
+    <xsl:value-of select="'#define '"/>
+    <!-- generate left side of macro -->
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">n</xsl:with-param>
+      <xsl:with-param name="nodetype">
+        <xsl:value-of select="../@name" />
+      </xsl:with-param>
+      <xsl:with-param name="field">
+        <xsl:value-of select="'FlagStructure'" />
+      </xsl:with-param>
+    </xsl:call-template>
+    <!-- generate right side of macro -->
+    <xsl:value-of select="'((n)->attribs.'"/> 
+    <xsl:call-template name="name-to-nodeenum">
+      <xsl:with-param name="name">
+        <xsl:value-of select="../@name"/>
+      </xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="'->flags'"/>
+    <xsl:value-of select="')'" />
+    <xsl:call-template name="newline"/>
+  </xsl:if>
   <!-- generate macros for each flag -->
   <xsl:apply-templates select="flag" mode="accessor-macros" />
 </xsl:template>
+
+<!-- start of the right side of an attribute or flag macro, up to the
+     member of the node type -->
+<xsl:template name="layout-attribs">
+  <xsl:choose>
+    <xsl:when test="$layout != 'split'">
+      <xsl:value-of select="'((n)->sons.'"/>
+    </xsl:when>
+    <xsl:otherwise>
+      <xsl:value-of select="'((n)->attribs.'"/>
+    </xsl:otherwise>
+  </xsl:choose>
+</xsl:template>
+
+<!-- selects a field from the member of the node type -->
+<xsl:template name="layout-member">
+  <xsl:choose>
+    <xsl:when test="$layout != 'split'">
+      <xsl:value-of select="'.'"/>
+    </xsl:when>
+    <xsl:otherwise>
+      <xsl:value-of select="'->'"/>
+    </xsl:otherwise>
+  </xsl:choose>
+</xsl:template>
   
 <xsl:template match="flag" mode="accessor-macros">
   <xsl:value-of select="'#define '"/>
@@ -165,13 +291,16 @@ version="1.0">
     </xsl:with-param>
   </xsl:call-template>
   <!-- generate right side of macro -->
-  <xsl:value-of select="'((n)->attribs.'"/> 
+  <xsl:call-template name="layout-attribs"/>
   <xsl:call-template name="name-to-nodeenum">
     <xsl:with-param name="name">
       <xsl:value-of select="../../@name"/>
     </xsl:with-param>
   </xsl:call-template>
-  <xsl:value-of select="'->flags.'"/>
+  <xsl:if test="$layout = 'split'">
+    <xsl:value-of select="'->flags'"/>
+  </xsl:if>
+  <xsl:value-of select="'.'"/>
   <xsl:value-of select="@name"/>
   <xsl:value-of select="')'" />
   <xsl:call-template name="newline"/>
@@ -0,0 +1,26 @@
+<?xml version="1.0"?>
+
+<!--
+  Selects the memory layout of the generated nodes. It is set with
+  xsltproc -\-stringparam layout <layout>, see AST_LAYOUT in Makefile.Config.
+
+    split   the node points to a SONS_N_* and an ATTRIBS_N_* structure
+    packed  sons, attributes and flags are stored inline in the node, in a
+            NODE_N_* structure per node type; attributes of types with a
+            bits attribute in ast.xml become bitfields of that width
+    handles as packed, but every son, also an item of a list son, is
+            stored as a 32-bit handle instead of a node pointer, see
+            TBnode and TBhandle in sons.h
+
+  The accessor macros are the same for all layouts, except that packed
+  and handles nodes have no FlagStructure accessor, as their flags are not
+  grouped. Sons are read with X_Y( n) and set with L_X_Y( n, son), which
+  stores the handle of son in the handles layout; the read accessor of a
+  son is no lvalue there.
+-->
+
+<xsl:stylesheet xmlns:xsl="http://www.w3.org/1999/XSL/Transform" version="1.0">
+
+<xsl:param name="layout" select="'split'"/>
+
+</xsl:stylesheet>
@@ -66,6 +66,7 @@ version="1.0">
 <xsl:import href="common-name-to-nodeenum.xsl"/>
 <xsl:import href="common-node-access.xsl"/>
 <xsl:import href="common-make-assertion.xsl"/>
+<xsl:import href="common-layout.xsl"/>
 
 <xsl:output method="text" indent="no"/>
 <xsl:strip-space elements="*"/>
@@ -94,7 +95,31 @@ version="1.0">
   <xsl:value-of select="'&quot;);'"/>
   <!-- allocate new node this -->
   <xsl:value-of select="'DBUG_PRINT( &quot;MAKE&quot;, (&quot;allocating node structure&quot;));'"/>
-  <xsl:value-of select="'this = MakeEmptyNode();'" />
+  <xsl:value-of select="'this = MakeEmptyNode( '" />
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name" />
+  </xsl:call-template>
+  <xsl:choose>
+    <!-- a packed node ends after the structure of its type -->
+    <xsl:when test="$layout != 'split'">
+      <xsl:value-of select="', offsetof( node, sons) + sizeof( struct NODE_N_'"/>
+      <xsl:call-template name="uppercase">
+        <xsl:with-param name="string" select="@name"/>
+      </xsl:call-template>
+      <xsl:value-of select="'));'"/>
+    </xsl:when>
+    <xsl:otherwise>
+      <xsl:value-of select="', sizeof( node) + sizeof( struct SONS_N_'"/>
+      <xsl:call-template name="uppercase">
+        <xsl:with-param name="string" select="@name"/>
+      </xsl:call-template>
+      <xsl:value-of select="') + sizeof( struct ATTRIBS_N_'"/>
+      <xsl:call-template name="uppercase">
+        <xsl:with-param name="string" select="@name"/>
+      </xsl:call-template>
+      <xsl:value-of select="'));'"/>
+    </xsl:otherwise>
+  </xsl:choose>
 
   <xsl:value-of select="'NODE_TYPE( this) = N_'" />
   <xsl:call-template name="lowercase" >
@@ -105,28 +130,35 @@ version="1.0">
   <xsl:value-of select="';'" />
 
   <xsl:value-of select="'DBUG_PRINT( &quot;MAKE&quot;, (&quot;address: %s &quot;, this));'"/>
-  <!-- allocate the sons structure -->
-  <xsl:value-of select="'DBUG_PRINT( &quot;MAKE&quot;, (&quot;allocating sons structure&quot;));'"/>
-  <xsl:value-of select="'this->sons.'"/>
-  <xsl:call-template name="name-to-nodeenum">
-    <xsl:with-param name="name" select="@name" />
-  </xsl:call-template>
-  <xsl:value-of select="' = MEMmalloc(sizeof(struct SONS_N_'"/>
-  <xsl:call-template name="uppercase">
-    <xsl:with-param name="string" select="@name"/>
-  </xsl:call-template>
-  <xsl:value-of select="'));'"/>
-  <!-- allocate the attrib structure -->
-  <xsl:value-of select="'DBUG_PRINT( &quot;MAKE&quot;, (&quot;allocating attrib structure&quot;));'"/>
-  <xsl:value-of select="'this->attribs.'"/>
-  <xsl:call-template name="name-to-nodeenum">
-    <xsl:with-param name="name" select="@name" />
-  </xsl:call-template>
-  <xsl:value-of select="' = MEMmalloc(sizeof(struct ATTRIBS_N_'"/>
-  <xsl:call-template name="uppercase">
-    <xsl:with-param name="string" select="@name"/>
-  </xsl:call-template>
-  <xsl:value-of select="'));'"/>
+  <!-- packed nodes hold their sons and attributes inline -->
+  <xsl:if test="$layout = 'split'">
+    <!-- the sons structure follows the node in its block -->
+    <xsl:value-of select="'DBUG_PRINT( &quot;MAKE&quot;, (&quot;placing sons structure&quot;));'"/>
+    <xsl:value-of select="'this->sons.'"/>
+    <xsl:call-template name="name-to-nodeenum">
+      <xsl:with-param name="name" select="@name" />
+    </xsl:call-template>
+    <xsl:value-of select="' = (struct SONS_N_'"/>
+    <xsl:call-template name="uppercase">
+      <xsl:with-param name="string" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="' *) (this + 1);'"/>
+    <!-- the attrib structure follows the sons structure -->
+    <xsl:value-of select="'DBUG_PRINT( &quot;MAKE&quot;, (&quot;placing attrib structure&quot;));'"/>
+    <xsl:value-of select="'this->attribs.'"/>
+    <xsl:call-template name="name-to-nodeenum">
+      <xsl:with-param name="name" select="@name" />
+    </xsl:call-template>
+    <xsl:value-of select="' = (struct ATTRIBS_N_'"/>
+    <xsl:call-template name="uppercase">
+      <xsl:with-param name="string" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="' *) ((char *) (this + 1) + sizeof( struct SONS_N_'"/>
+    <xsl:call-template name="uppercase">
+      <xsl:with-param name="string" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="'));'"/>
+  </xsl:if>
   <!-- set node type -->
   <xsl:value-of select="'DBUG_PRINT( &quot;MAKE&quot;, (&quot;setting node type&quot;));'"/>
   <xsl:value-of select="'NODE_TYPE(this) = '" />
@@ -147,7 +179,7 @@ version="1.0">
   <xsl:call-template name="newline" />
   <xsl:value-of select="'DBUG_PRINT( &quot;MAKE&quot;, (&quot;doing son target checks&quot;));'"/>
   <!-- generate warning messages -->
-  <xsl:apply-templates select="sons/son[not( @default)]" mode="make-assertion-target">
+  <xsl:apply-templates select="sons/son[not( @default)][not( @list = 'yes')]" mode="make-assertion-target">
     <xsl:with-param name="self"><xsl:value-of select="'this'"/></xsl:with-param>
   </xsl:apply-templates>
   <xsl:call-template name="newline" />
@@ -172,7 +204,7 @@ version="1.0">
     </xsl:otherwise>
   </xsl:choose>
   <xsl:value-of select="'));'"/>
-  <xsl:call-template name="node-access">
+  <xsl:call-template name="node-set">
     <xsl:with-param name="node">
       <xsl:value-of select="'this'" />
     </xsl:with-param>
@@ -182,17 +214,18 @@ version="1.0">
     <xsl:with-param name="field">
       <xsl:value-of select="@name" />
     </xsl:with-param>
+    <!-- check for default value -->
+    <xsl:with-param name="value">
+      <xsl:choose>
+        <xsl:when test="@default">
+          <xsl:value-of select="@default" />
+        </xsl:when>
+        <xsl:otherwise>
+          <xsl:value-of select="@name" />
+        </xsl:otherwise>
+      </xsl:choose>
+    </xsl:with-param>
   </xsl:call-template>
-  <xsl:value-of select="' = '"/>
-  <!-- check for default value -->
-  <xsl:choose>
-    <xsl:when test="@default">
-      <xsl:value-of select="@default" />
-    </xsl:when>
-    <xsl:otherwise>
-      <xsl:value-of select="@name" />
-    </xsl:otherwise>
-  </xsl:choose>
   <xsl:value-of select="';'"/>
   <!-- if the current son is an avis, add the backref -->
   <xsl:if test="&quot;Avis&quot; = @name">
@@ -235,6 +268,26 @@ version="1.0">
   </xsl:if>
 </xsl:template>
  
+<!-- a list son starts out empty -->
+<xsl:template match="sons/son[@list = 'yes']" mode="make-body">
+  <xsl:variable name="list">
+    <xsl:value-of select="'this->sons.'"/>
+    <xsl:call-template name="name-to-nodeenum">
+      <xsl:with-param name="name" select="../../@name" />
+    </xsl:call-template>
+    <xsl:choose>
+      <xsl:when test="$layout != 'split'">
+        <xsl:value-of select="'.'"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="'->'"/>
+      </xsl:otherwise>
+    </xsl:choose>
+    <xsl:value-of select="@name"/>
+  </xsl:variable>
+  <xsl:value-of select="concat( $list, '.items = NULL; ', $list, '.count = 0; ', $list, '.size = 0;')"/>
+</xsl:template>
+
 <!-- generate the assignmnent for an attribute -->
 <xsl:template match="attributes/attribute" mode="make-body">
   <!-- if it is an array, we have to build a for loop over its elements -->
@@ -65,6 +65,20 @@ version="1.0">
 <!-- generate a make function head -->
 <xsl:template match="node" mode="make-head">
   <xsl:value-of select="'node *TBmake'"/>
+  <xsl:call-template name="make-name"/>
+  <xsl:call-template name="make-parameters"/>
+</xsl:template>
+
+<!-- generate the head of the share function of a hashcons node, which
+     takes the same parameters as its make function -->
+<xsl:template match="node" mode="share-head">
+  <xsl:value-of select="'node *TBshare'"/>
+  <xsl:call-template name="make-name"/>
+  <xsl:call-template name="make-parameters"/>
+</xsl:template>
+
+<!-- the node name as it appears in TBmakeXxx -->
+<xsl:template name="make-name">
   <xsl:call-template name="uppercase" >
     <xsl:with-param name="string" >
       <xsl:value-of select="substring( @name, 1, 1)" />
@@ -75,17 +89,25 @@ version="1.0">
       <xsl:value-of select="substring( @name, 2, 30)" />
     </xsl:with-param>
   </xsl:call-template>
+</xsl:template>
+
+<!-- the parameter list of a make function -->
+<xsl:template name="make-parameters">
   <xsl:value-of select="'( '"/>
   <!-- permanent attributes without default value first -->
   <xsl:apply-templates select="attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;]" mode="make-head"/>
   <!-- add a , if needed -->
   <xsl:if test="attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;]">
-    <xsl:if test="sons/son[ not( @default)]">
+    <xsl:if test="sons/son[ not( @default)][ not( @list = 'yes')]">
       <xsl:value-of select="' ,'"/>
     </xsl:if>
   </xsl:if>
   <!-- sons without default value are last parameters -->
-  <xsl:apply-templates select="sons/son[ not( @default)]" mode="make-head"/>
+  <xsl:apply-templates select="sons/son[ not( @default)][ not( @list = 'yes')]" mode="make-head"/>
+  <!-- a node with nothing but a list son has no parameters -->
+  <xsl:if test="not( attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;] | sons/son[ not( @default)][ not( @list = 'yes')])">
+    <xsl:value-of select="'void'"/>
+  </xsl:if>
   <xsl:value-of select="')'"/>
 </xsl:template>
 
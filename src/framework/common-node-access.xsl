@@ -54,6 +54,9 @@
 
 <xsl:stylesheet xmlns:xsl="http://www.w3.org/1999/XSL/Transform" version="1.0">
 
+<xsl:import href="common-name-to-nodeenum.xsl"/>
+<xsl:import href="common-layout.xsl"/>
+
 <!-- Some nice templates for accessing fields of the node structure
      by using the access macros -->
 
@@ -84,4 +87,66 @@
   <xsl:value-of select="') '" />
 </xsl:template>
 
+<!-- generate a son setter ala L_ARRAY_NEXT(n, value) -->
+<xsl:template name="node-set">
+  <!-- name of the variable pointing to the node -->
+  <xsl:param name="node" />
+  <!-- name of node type -->
+  <xsl:param name="nodetype" />
+  <!-- son to set -->
+  <xsl:param name="field" />
+  <!-- index for the items of a list son, otherwise do not set -->
+  <xsl:param name="index" />
+  <!-- the new son -->
+  <xsl:param name="value" />
+
+  <xsl:value-of select="'L_'" />
+  <xsl:call-template name="uppercase">
+    <xsl:with-param name="string"><xsl:value-of select="$nodetype"/></xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="'_'"/>
+  <xsl:call-template name="uppercase">
+    <xsl:with-param name="string"><xsl:value-of select="$field"/></xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="'( '" />
+  <xsl:value-of select="$node" />
+  <xsl:if test="$index != &quot;&quot;">
+    <xsl:value-of select="', '" />
+    <xsl:value-of select="$index" />
+  </xsl:if>
+  <xsl:value-of select="', '" />
+  <xsl:value-of select="$value" />
+  <xsl:value-of select="') '" />
+</xsl:template>
+
+<!-- the sonslot a son is stored in, for code that needs its address:
+     (n)->sons.N_array->Next -->
+<xsl:template name="son-slot">
+  <!-- name of the variable pointing to the node -->
+  <xsl:param name="node" />
+  <!-- name of node type -->
+  <xsl:param name="nodetype" />
+  <!-- son to select -->
+  <xsl:param name="field" />
+  <!-- index for the items of a list son, otherwise do not set -->
+  <xsl:param name="index" />
+
+  <xsl:value-of select="concat( '(', $node, ')->sons.')" />
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="$nodetype" />
+  </xsl:call-template>
+  <xsl:choose>
+    <xsl:when test="$layout = 'split'">
+      <xsl:value-of select="'->'" />
+    </xsl:when>
+    <xsl:otherwise>
+      <xsl:value-of select="'.'" />
+    </xsl:otherwise>
+  </xsl:choose>
+  <xsl:value-of select="$field" />
+  <xsl:if test="$index != &quot;&quot;">
+    <xsl:value-of select="concat( '.items[', $index, ']')" />
+  </xsl:if>
+</xsl:template>
+
 </xsl:stylesheet>
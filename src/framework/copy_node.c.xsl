@@ -61,6 +61,7 @@ version="1.0">
 <xsl:import href="common-travfun.xsl"/>
 <xsl:import href="common-node-access.xsl"/>
 <xsl:import href="common-c-code.xsl"/>
+<xsl:import href="common-name-to-nodeenum.xsl"/>
 
 <xsl:output method="text" indent="no"/>
 <xsl:strip-space elements="*"/>
@@ -92,16 +93,213 @@ version="1.0">
   <!-- includes -->
   <xsl:text>
 
+#include &lt;stdint.h&gt;
+#include &lt;string.h&gt;
+
 #include "copy_node.h"
 #include "copy_info.h"
 #include "traverse.h"
 #include "dbug.h"
 #include "tree_basic.h"
 #include "str.h"
-#include "lookup_table.h"
-
+#include "memory.h"
+
+/*
+ * Sons are not copied recursively, which would take C stack in proportion
+ * to the depth of the tree, but put on a work stack together with the son
+ * of the copy they go into. The outermost COPY function of a run, told
+ * apart by the info structure of the run, copies them before it returns.
+ * As the sons of a node are put on the stack last one first, the nodes are
+ * copied, and entered into the map below, in the same order as by a
+ * recursive copy.
+ */
+typedef struct COPY_WORK {
+  node *node;
+  sonslot *copy;
+  info *info;
+} copy_work;
+
+static copy_work *work = NULL;
+static int work_count = 0;
+static int work_size = 0;
+static info *work_owner = NULL;
+
+static void CopyLater( node *son, sonslot *copy, info *arg_info)
+{
+  copy_work *grown;
+
+  if (son != NULL) {
+    if (work_count == work_size) {
+      work_size = work_size == 0 ? 64 : 2 * work_size;
+      grown = MEMmalloc( work_size * sizeof( copy_work));
+      if (work != NULL) {
+        memcpy( grown, work, work_count * sizeof( copy_work));
+        work = MEMfree( work);
+      }
+      work = grown;
+    }
+    work[work_count].node = son;
+    work[work_count].copy = copy;
+    work[work_count].info = arg_info;
+    work_count++;
+  }
+}
+
+static void CopyPending( info *arg_info)
+{
+  info *owner = work_owner;
+
+  if (owner != arg_info) {
+    work_owner = arg_info;
+    while ((work_count > 0) &amp;&amp; (work[work_count - 1].info == arg_info)) {
+      work_count--;
+      *work[work_count].copy = TBhandle( TRAVdo( work[work_count].node, arg_info));
+    }
+    work_owner = owner;
+  }
+}
+
+/*
+ * Link attributes are redirected to the copies of the nodes they point to
+ * through an open-addressed hash map from each copied node to its copy.
+ * The outermost COPY function of a run counts the nodes of the subtree and
+ * sizes the map to at least twice that, so that it never has to grow and
+ * probe sequences stay short. A link to a node that has not been copied,
+ * because it lies outside the subtree or is copied later, keeps pointing
+ * to the original.
+ */
+typedef struct COPY_ENTRY {
+  node *original;
+  node *copy;
+} copy_entry;
+
+static copy_entry *map = NULL;
+static size_t map_capacity = 0;
+static size_t map_mask = 0;
+static info *map_owner = NULL;
+
+#define MAP_SLOT( original) \
+  ((((uintptr_t) (original) &gt;&gt; 3) * (uintptr_t) 0x9E3779B1u) &amp; map_mask)
+
+/*
+ * Counts the nodes of the subtree with a switch per node that pushes its
+ * sons, which is much cheaper than copying them.
+ */
+#define COUNT_PUSH( son)                                              \
+  if ((son) != NULL) {                                                \
+    if (top == size) {                                                \
+      grown = MEMmalloc( 2 * size * sizeof( node *));                 \
+      memcpy( grown, stack, size * sizeof( node *));                  \
+      stack = MEMfree( stack);                                        \
+      stack = grown;                                                  \
+      size *= 2;                                                      \
+    }                                                                 \
+    stack[top++] = (son);                                             \
+  }
+
+static size_t CountNodes( node *arg_node)
+{
+  node **stack;
+  node **grown;
+  node *current;
+  size_t size = 64;
+  size_t top = 0;
+  size_t count = 0;
+  </xsl:text>
+  <xsl:if test="//syntaxtree/node/sons/son[@list = 'yes']">
+    <xsl:text>int i;
+  </xsl:text>
+  </xsl:if>
+  <xsl:text>
+  stack = MEMmalloc( size * sizeof( node *));
+  stack[top++] = arg_node;
 
-#define COPYTRAV( node, info) (node != NULL) ? TRAVdo( node, info) : node
+  while (top &gt; 0) {
+    current = stack[--top];
+    count++;
+    switch (NODE_TYPE( current)) {
+  </xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node" mode="count-sons"/>
+  <xsl:text>
+    default:
+      break;
+    }
+  }
+
+  stack = MEMfree( stack);
+
+  return( count);
+}
+
+/*
+ * Starts a run at arg_node, unless one is running; returns whether it did.
+ */
+static bool MapBegin( node *arg_node, info *arg_info)
+{
+  size_t size = 16;
+  size_t count;
+
+  if (map_owner == arg_info) {
+    return( FALSE);
+  }
+
+  DBUG_ASSERT( (map_owner == NULL), "copy runs must not nest");
+
+  count = CountNodes( arg_node);
+  while (size &lt; 2 * count) {
+    size *= 2;
+  }
+
+  if (size &gt; map_capacity) {
+    if (map != NULL) {
+      map = MEMfree( map);
+    }
+    map = MEMmalloc( size * sizeof( copy_entry));
+    map_capacity = size;
+  }
+
+  memset( map, 0, size * sizeof( copy_entry));
+  map_mask = size - 1;
+  map_owner = arg_info;
+
+  return( TRUE);
+}
+
+static void MapEnd( bool started)
+{
+  if (started) {
+    map_owner = NULL;
+  }
+}
+
+static void MapInsert( node *original, node *copy)
+{
+  size_t slot = MAP_SLOT( original);
+
+  while (map[slot].original != NULL) {
+    slot = (slot + 1) &amp; map_mask;
+  }
+
+  map[slot].original = original;
+  map[slot].copy = copy;
+}
+
+static node *MapLookup( node *original)
+{
+  size_t slot;
+
+  if (original == NULL) {
+    return( NULL);
+  }
+
+  for (slot = MAP_SLOT( original); map[slot].original != NULL; slot = (slot + 1) &amp; map_mask) {
+    if (map[slot].original == original) {
+      return( map[slot].copy);
+    }
+  }
+
+  return( original);
+}
 
   </xsl:text>
   <!-- functions -->
@@ -113,6 +311,47 @@ version="1.0">
 </xsl:template>
 
 
+<!-- generate the pushes of the sons of a node for CountNodes -->
+<xsl:template match="node" mode="count-sons">
+  <xsl:value-of select="'case '"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name"/>
+  </xsl:call-template>
+  <xsl:value-of select="':'"/>
+  <xsl:for-each select="sons/son[@name]">
+    <xsl:if test="@list = 'yes'">
+      <xsl:value-of select="'for (i = 0; i &lt; '"/>
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node">current</xsl:with-param>
+        <xsl:with-param name="nodetype">
+          <xsl:value-of select="../../@name"/>
+        </xsl:with-param>
+        <xsl:with-param name="field">Count</xsl:with-param>
+      </xsl:call-template>
+      <xsl:value-of select="'; i++) { '"/>
+    </xsl:if>
+    <xsl:value-of select="'COUNT_PUSH( '"/>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">current</xsl:with-param>
+      <xsl:with-param name="nodetype">
+        <xsl:value-of select="../../@name"/>
+      </xsl:with-param>
+      <xsl:with-param name="field">
+        <xsl:value-of select="@name"/>
+      </xsl:with-param>
+      <xsl:with-param name="index">
+        <xsl:if test="@list = 'yes'">i</xsl:if>
+      </xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="')'"/>
+    <xsl:if test="@list = 'yes'">
+      <xsl:value-of select="' }'"/>
+    </xsl:if>
+  </xsl:for-each>
+  <xsl:value-of select="'break;'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
 <!-- generate copy functions -->
 <xsl:template match="node">
   <!-- generate head and comment -->
@@ -123,6 +362,10 @@ version="1.0">
   <xsl:value-of select="'node *result = '"/>
   <xsl:apply-templates select="." mode="make-function-call"/>
   <xsl:value-of select="';'"/>
+  <xsl:value-of select="'bool started;'"/>
+  <xsl:if test="sons/son[@list = 'yes']">
+    <xsl:value-of select="'int i;'"/>
+  </xsl:if>
   <!-- give hint we start to copy now -->
   <xsl:value-of select="'DBUG_ENTER(&quot;COPY'"/>
   <xsl:call-template name="lowercase" >
@@ -131,7 +374,8 @@ version="1.0">
     </xsl:with-param>
   </xsl:call-template>
   <xsl:value-of select="'&quot;);'"/>
-  <xsl:value-of select="'LUTinsertIntoLutP( INFO_LUT( arg_info), arg_node, result);'"/>
+  <xsl:value-of select="'started = MapBegin( arg_node, arg_info);'"/>
+  <xsl:value-of select="'MapInsert( arg_node, result);'"/>
 
   <!-- call copy for attributes -->   
   <xsl:if test="count(attributes/attribute) > 0">
@@ -155,7 +399,11 @@ version="1.0">
     /* Copy sons */
     </xsl:text>
   </xsl:if>
-  <xsl:apply-templates select="sons/son[@name]"/>
+  <xsl:apply-templates select="sons/son[@name]">
+    <xsl:sort select="position()" data-type="number" order="descending"/>
+  </xsl:apply-templates>
+  <xsl:value-of select="'CopyPending( arg_info);'"/>
+  <xsl:value-of select="'MapEnd( started);'"/>
   <!-- return value -->
   <xsl:text>
   /* Return value */
@@ -180,9 +428,20 @@ version="1.0">
 </xsl:template>
 
 
-<!-- generate copy calls for sons-->
+<!-- generate copy calls for sons, which are put on the work stack -->
 <xsl:template match="son">
+  <xsl:value-of select="'CopyLater( '"/>
   <xsl:call-template name="node-access">
+    <xsl:with-param name="node">arg_node</xsl:with-param>
+    <xsl:with-param name="nodetype">
+      <xsl:value-of select="../../@name"/>
+    </xsl:with-param>
+    <xsl:with-param name="field">
+      <xsl:value-of select="@name"/>
+    </xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="', &amp;'"/>
+  <xsl:call-template name="son-slot">
     <xsl:with-param name="node">result</xsl:with-param>
     <xsl:with-param name="nodetype">
       <xsl:value-of select="../../@name"/>
@@ -191,7 +450,29 @@ version="1.0">
       <xsl:value-of select="@name"/>
     </xsl:with-param>
   </xsl:call-template>
-  <xsl:value-of select="' = COPYTRAV( '"/>
+  <xsl:value-of select="', arg_info);'"/>
+</xsl:template>
+
+<!-- the copy of a list son gets as many items, which are put on the work
+     stack last one first -->
+<xsl:template match="son[@list = 'yes']">
+  <xsl:value-of select="'TBresize( result, '"/>
+  <xsl:call-template name="node-access">
+    <xsl:with-param name="node">arg_node</xsl:with-param>
+    <xsl:with-param name="nodetype">
+      <xsl:value-of select="../../@name"/>
+    </xsl:with-param>
+    <xsl:with-param name="field">Count</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="'); for (i = '"/>
+  <xsl:call-template name="node-access">
+    <xsl:with-param name="node">arg_node</xsl:with-param>
+    <xsl:with-param name="nodetype">
+      <xsl:value-of select="../../@name"/>
+    </xsl:with-param>
+    <xsl:with-param name="field">Count</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="' - 1; i &gt;= 0; i--) { CopyLater( '"/>
   <xsl:call-template name="node-access">
     <xsl:with-param name="node">arg_node</xsl:with-param>
     <xsl:with-param name="nodetype">
@@ -200,8 +481,20 @@ version="1.0">
     <xsl:with-param name="field">
       <xsl:value-of select="@name"/>
     </xsl:with-param>
+    <xsl:with-param name="index">i</xsl:with-param>
   </xsl:call-template>
-  <xsl:value-of select="', arg_info);'"/>
+  <xsl:value-of select="', &amp;'"/>
+  <xsl:call-template name="son-slot">
+    <xsl:with-param name="node">result</xsl:with-param>
+    <xsl:with-param name="nodetype">
+      <xsl:value-of select="../../@name"/>
+    </xsl:with-param>
+    <xsl:with-param name="field">
+      <xsl:value-of select="@name"/>
+    </xsl:with-param>
+    <xsl:with-param name="index">i</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="', arg_info); }'"/>
 </xsl:template>
 
 <!-- generate copying flags -->
@@ -267,9 +560,9 @@ version="1.0">
       </xsl:call-template>
       <xsl:value-of select="';'" />
     </xsl:when>
-    <!-- literal attributes are just copied (assigment) -->
+    <!-- links are redirected to the copy of the node they point to -->
     <xsl:when test="key(&quot;types&quot;, ./type/@name)[@copy = &quot;lookup&quot;]">
-       <xsl:value-of select="'LUTsearchInLutPp( INFO_LUT( arg_info), '"/>
+       <xsl:value-of select="'MapLookup( '"/>
       <xsl:call-template name="node-access">
         <xsl:with-param name="node">
           <xsl:value-of select="'arg_node'" />
@@ -322,12 +615,12 @@ version="1.0">
   <xsl:apply-templates select="attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;]" mode="make-function-call"/>
   <!-- add a , if needed -->
   <xsl:if test="attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;]">
-    <xsl:if test="sons/son[ not( @default)]">
+    <xsl:if test="sons/son[ not( @default)][ not( @list = 'yes')]">
       <xsl:value-of select="' ,'"/>
     </xsl:if>
   </xsl:if>
   <!-- sons without default value are last parameters -->
-  <xsl:apply-templates select="sons/son[ not( @default)]" mode="make-function-call"/>
+  <xsl:apply-templates select="sons/son[ not( @default)][ not( @list = 'yes')]" mode="make-function-call"/>
   <xsl:value-of select="')'"/>
 </xsl:template>
 
@@ -117,6 +117,8 @@ version="1.0">
   <!-- includes -->
   <xsl:text>
 
+#include &lt;string.h&gt;
+
 #include "free.h"
 #include "free_node.h"
 #include "free_attribs.h"
@@ -127,12 +129,64 @@ version="1.0">
 #include "memory.h"
 #include "dbug.h"
 
-#define FREETRAV( node, info) (node != NULL) ? TRAVdo( node, info) : node
+#define FREETRAV( node, info) FreeLater( node, info)
 #define FREECOND( node, info)                                    \
   (INFO_FREE_FLAG( info) != arg_node)                            \
     ? FREETRAV( node, info)                                      \
     : (node)
 
+/*
+ * Sons are not freed recursively, which would take C stack in proportion
+ * to the depth of the tree, but put on a work stack. The outermost FREE
+ * function of a run, told apart by the info structure of the run, frees
+ * them before it returns.
+ */
+typedef struct FREE_WORK {
+  node *node;
+  info *info;
+} free_work;
+
+static free_work *work = NULL;
+static int work_count = 0;
+static int work_size = 0;
+static info *work_owner = NULL;
+
+static node *FreeLater( node *son, info *arg_info)
+{
+  free_work *grown;
+
+  if (son != NULL) {
+    if (work_count == work_size) {
+      work_size = work_size == 0 ? 64 : 2 * work_size;
+      grown = MEMmalloc( work_size * sizeof( free_work));
+      if (work != NULL) {
+        memcpy( grown, work, work_count * sizeof( free_work));
+        work = MEMfree( work);
+      }
+      work = grown;
+    }
+    work[work_count].node = son;
+    work[work_count].info = arg_info;
+    work_count++;
+  }
+
+  return( NULL);
+}
+
+static void FreePending( info *arg_info)
+{
+  info *owner = work_owner;
+
+  if (owner != arg_info) {
+    work_owner = arg_info;
+    while ((work_count > 0) &amp;&amp; (work[work_count - 1].info == arg_info)) {
+      work_count--;
+      TRAVdo( work[work_count].node, arg_info);
+    }
+    work_owner = owner;
+  }
+}
+
   </xsl:text>
   <!-- functions -->
   <xsl:apply-templates select="//syntaxtree/node">
@@ -167,9 +221,40 @@ version="1.0">
      The return value is the value of the NEXT son, or if no NEXT son
      is present the result of Free. This way, depending on the 
      TRAVCOND macro, the full chain of nodes or only one node can
-     be freed.
+     be freed. The sons themselves are only put on the work stack and
+     freed by FreePending of the outermost call.
+-->
+
+<!--
+     traversal main node[@root]
+
+     freeing the root of the syntax tree releases every node at once by
+     resetting the node arena, instead of walking the tree
 -->
 
+<xsl:template match="node[@root = &quot;yes&quot;]">
+  <!-- generate head and comment -->
+  <xsl:apply-templates select="@name"/>
+  <xsl:value-of select="'{'"/>
+  <xsl:value-of select="'DBUG_ENTER( &quot;FREE'"/>
+  <xsl:call-template name="lowercase" >
+    <xsl:with-param name="string" >
+      <xsl:value-of select="@name"/>
+    </xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="'&quot;);'"/>
+  <xsl:value-of select="'DBUG_PRINT( &quot;FREE&quot;, (&quot;Releasing all nodes with root '" />
+  <xsl:call-template name="name-to-nodeenum" >
+    <xsl:with-param name="name" >
+      <xsl:value-of select="@name"/>
+    </xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="' at &quot; F_PTR, arg_node));'"/>
+  <xsl:value-of select="'TBresetArena();'"/>
+  <xsl:value-of select="'DBUG_RETURN( NULL);'"/>
+  <xsl:value-of select="'}'"/>
+</xsl:template>
+
 <xsl:template match="node">
   <!-- generate head and comment -->
   <xsl:apply-templates select="@name"/>
@@ -180,6 +265,10 @@ version="1.0">
   <xsl:if test="attributes/attribute[key(&quot;arraytypes&quot;, ./type/@name)]">
     <xsl:value-of select="'int cnt;'" />
   </xsl:if>
+  <!-- counter for the items of a list son -->
+  <xsl:if test="sons/son[@list = 'yes']">
+    <xsl:value-of select="'int i;'" />
+  </xsl:if>
   <!-- variable for result -->
   <xsl:value-of select="'node *result = NULL;'"/>
   <!-- DBUG_ENTER statement -->
@@ -198,6 +287,11 @@ version="1.0">
     </xsl:with-param>
   </xsl:call-template>
   <xsl:value-of select="' at &quot; F_PTR, arg_node));'"/>
+  <!-- a shared node may be used elsewhere; it lives until the arena is
+       reset -->
+  <xsl:if test="@hashcons = &quot;yes&quot;">
+    <xsl:value-of select="'if (TBisShared( arg_node)) { DBUG_RETURN( NULL); }'"/>
+  </xsl:if>
   <!-- first free everything downwards in the ast -->
   <xsl:apply-templates select="sons/son[@name = &quot;Next&quot;]"/>
   <!-- call free for attributes -->
@@ -221,27 +315,7 @@ version="1.0">
       <xsl:value-of select="'result = NULL;'"/>
     </xsl:otherwise>
   </xsl:choose>
-  <!-- free sons structure -->
-  <xsl:value-of select="'arg_node->sons.'"/>
-  <xsl:call-template name="name-to-nodeenum" >
-    <xsl:with-param name="name" select="@name"/>
-  </xsl:call-template>
-  <xsl:value-of select="' = MEMfree( arg_node->sons.'"/>
-  <xsl:call-template name="name-to-nodeenum" >
-    <xsl:with-param name="name" select="@name"/>
-  </xsl:call-template>
-  <xsl:value-of select="');'"/>
-  <!-- free attribute structure -->
-  <xsl:value-of select="'arg_node->attribs.'"/>
-  <xsl:call-template name="name-to-nodeenum" >
-    <xsl:with-param name="name" select="@name"/>
-  </xsl:call-template>
-  <xsl:value-of select="' = MEMfree( arg_node->attribs.'"/>
-  <xsl:call-template name="name-to-nodeenum" >
-    <xsl:with-param name="name" select="@name"/>
-  </xsl:call-template>
-  <xsl:value-of select="');'"/>
-  <!-- calculate return value and free node -->
+  <!-- put the block of node, sons and attributes up for reuse -->
   <xsl:value-of select="'DBUG_PRINT( &quot;FREE&quot;, (&quot;Processing node '" />
   <xsl:call-template name="name-to-nodeenum" >
     <xsl:with-param name="name" >
@@ -249,14 +323,9 @@ version="1.0">
     </xsl:with-param>
   </xsl:call-template>
   <xsl:value-of select="' at &quot; F_PTR, arg_node));'"/>
-  <xsl:choose>
-    <xsl:when test="sons/son[@name = &quot;Next&quot;]">
-      <xsl:value-of select="'arg_node = MEMfree( arg_node);'"/>
-    </xsl:when>
-    <xsl:otherwise>
-      <xsl:value-of select="'result = MEMfree( arg_node);'"/>
-    </xsl:otherwise>
-  </xsl:choose>
+  <xsl:value-of select="'TBrecycleNode( arg_node);'"/>
+  <!-- free the sons put aside, if this is the outermost call -->
+  <xsl:value-of select="'FreePending( arg_info);'"/>
   <!-- DBUG_RETURN call -->
   <xsl:value-of select="'DBUG_RETURN( result);'"/>
   <!-- end of body -->
@@ -286,6 +355,44 @@ version="1.0">
   </xsl:call-template>
 </xsl:template>
 
+<!--
+     traversal main son[@list]
+
+     calls FREETRAV for every item of a list son
+-->
+
+<xsl:template match="son[@list = 'yes']">
+  <xsl:variable name="item">
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype">
+        <xsl:value-of select="../../@name"/>
+      </xsl:with-param>
+      <xsl:with-param name="field">
+        <xsl:value-of select="@name"/>
+      </xsl:with-param>
+      <xsl:with-param name="index">i</xsl:with-param>
+    </xsl:call-template>
+  </xsl:variable>
+  <xsl:value-of select="'for (i = 0; i &lt; '"/>
+  <xsl:call-template name="node-access">
+    <xsl:with-param name="node">arg_node</xsl:with-param>
+    <xsl:with-param name="nodetype">
+      <xsl:value-of select="../../@name"/>
+    </xsl:with-param>
+    <xsl:with-param name="field">Count</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="'; i++) { '"/>
+  <xsl:call-template name="node-set">
+    <xsl:with-param name="node">arg_node</xsl:with-param>
+    <xsl:with-param name="nodetype" select="../../@name"/>
+    <xsl:with-param name="field" select="@name"/>
+    <xsl:with-param name="index">i</xsl:with-param>
+    <xsl:with-param name="value" select="concat( 'FREETRAV( ', $item, ', arg_info)')"/>
+  </xsl:call-template>
+  <xsl:value-of select="'; }'"/>
+</xsl:template>
+
 <!--
      traversal main son
 
@@ -293,7 +400,7 @@ version="1.0">
 
      example:
 
-     ARG_NEXT( arg_node) = FREETRAV( ARG_NEXT( arg_node), arg_info);
+     L_ARG_NEXT( arg_node, FREETRAV( ARG_NEXT( arg_node), arg_info));
 
      remarks:
  
@@ -303,7 +410,7 @@ version="1.0">
 -->
      
 <xsl:template match="son">
-  <xsl:call-template name="node-access">
+  <xsl:call-template name="node-set">
     <xsl:with-param name="node">arg_node</xsl:with-param>
     <xsl:with-param name="nodetype">
       <xsl:value-of select="../../@name"/>
@@ -311,25 +418,28 @@ version="1.0">
     <xsl:with-param name="field">
       <xsl:value-of select="@name"/>
     </xsl:with-param>
-  </xsl:call-template>
-  <xsl:choose>
-    <xsl:when test="@name = &quot;Next&quot;">
-      <xsl:value-of select="' = FREECOND( '"/>
-    </xsl:when>
-    <xsl:otherwise>
-      <xsl:value-of select="' = FREETRAV( '"/>
-    </xsl:otherwise>
-  </xsl:choose>
-  <xsl:call-template name="node-access">
-    <xsl:with-param name="node">arg_node</xsl:with-param>
-    <xsl:with-param name="nodetype">
-      <xsl:value-of select="../../@name"/>
-    </xsl:with-param>
-    <xsl:with-param name="field">
-      <xsl:value-of select="@name"/>
+    <xsl:with-param name="value">
+      <xsl:choose>
+        <xsl:when test="@name = &quot;Next&quot;">
+          <xsl:value-of select="'FREECOND( '"/>
+        </xsl:when>
+        <xsl:otherwise>
+          <xsl:value-of select="'FREETRAV( '"/>
+        </xsl:otherwise>
+      </xsl:choose>
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node">arg_node</xsl:with-param>
+        <xsl:with-param name="nodetype">
+          <xsl:value-of select="../../@name"/>
+        </xsl:with-param>
+        <xsl:with-param name="field">
+          <xsl:value-of select="@name"/>
+        </xsl:with-param>
+      </xsl:call-template>
+      <xsl:value-of select="', arg_info)'"/>
     </xsl:with-param>
   </xsl:call-template>
-  <xsl:value-of select="', arg_info);'"/>
+  <xsl:value-of select="';'"/>
 </xsl:template>
 
 <!--
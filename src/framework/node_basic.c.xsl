@@ -65,6 +65,7 @@ version="1.0">
 <xsl:import href="common-make-head.xsl"/>
 <xsl:import href="common-make-body.xsl"/>
 <xsl:import href="common-travfun.xsl"/>
+<xsl:import href="common-layout.xsl"/>
 
 <xsl:output method="text" indent="no"/>
 <xsl:strip-space elements="*"/>
@@ -85,35 +86,644 @@ version="1.0">
     </xsl:with-param>
   </xsl:call-template>
   <xsl:text>
+#include &lt;pthread.h&gt;
+#include &lt;stddef.h&gt;
+#include &lt;stdint.h&gt;
+#include &lt;string.h&gt;
+</xsl:text>
+  <xsl:if test="$layout = 'handles'">
+    <xsl:text>#include &lt;sys/mman.h&gt;
+</xsl:text>
+  </xsl:if>
+  <xsl:text>
 #include "node_basic.h"
 #include "tree_basic.h"
 #include "memory.h"
 #include "dbug.h"
 #include "globals.h"
+#include "myglobals.h"
 #include "ctinfo.h"
+#include "symbol_table.h"
+
+/*
+ * Nodes are bump-allocated from an arena, each together with its sons and
+ * attribute structures in one block: the node, then its sons, then its
+ * attributes. Unless the layout is split, the block ends right after the
+ * packed structure of the node type in its SONUNION. Freeing a subtree puts
+ * its blocks on a recycle list per node type; freeing the root of the
+ * syntax tree releases the whole arena.
+ *
+ * The parser threads allocate nodes as well, so every thread bumps in a
+ * chunk of its own and keeps its own recycle lists. Only taking a new
+ * chunk is locked. A reset bumps the arena generation, which makes every
+ * thread drop its chunk and recycle lists on its next allocation.
+ */
+#define ARENA_CHUNK_SIZE 262144
+#define ARENA_ALIGN 8
+
+static int generation = 0;
+static pthread_mutex_t chunks_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread char *cursor = NULL;
+static __thread char *limit = NULL;
+static __thread int thread_generation = 0;
+static __thread node *recycled[MAX_NODES + 1];
+
+  </xsl:text>
+  <xsl:choose>
+    <xsl:when test="$layout = 'handles'">
+      <xsl:text>
+/*
+ * Sons are handles, the offset of their node from TBhandleBase in units
+ * of ARENA_ALIGN. So all chunks are cut from one region that is reserved
+ * on the first allocation and only backed by memory as it is touched; its
+ * first ARENA_ALIGN bytes stay unused, as handle 0 is NULL. A reset gives
+ * the memory back and starts cutting from the front again.
+ */
+#define ARENA_REGION_SIZE ((size_t) ARENA_ALIGN &lt;&lt; 32)
+
+typedef char handle_region_check[sizeof( size_t) &gt; 4 ? 1 : -1];
+
+char *TBhandleBase = NULL;
+static size_t region_used = 0;
+
+/*
+ * Returns a new chunk of size bytes.
+ */
+static char *ChunkAlloc( size_t size)
+{
+  char *result = NULL;
+  void *region;
+
+  pthread_mutex_lock( &amp;chunks_lock);
+  if (TBhandleBase == NULL) {
+    region = mmap( NULL, ARENA_REGION_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region != MAP_FAILED) {
+      TBhandleBase = (char *) region;
+      region_used = ARENA_ALIGN;
+    }
+  }
+  if ((TBhandleBase != NULL) &amp;&amp; (size &lt;= ARENA_REGION_SIZE - region_used)) {
+    result = TBhandleBase + region_used;
+    region_used += size;
+  }
+  pthread_mutex_unlock( &amp;chunks_lock);
 
-static node *MakeEmptyNode()
+  if (result == NULL) {
+    CTIabort( "Out of memory for the syntax tree");
+  }
+
+  return( result);
+}
+</xsl:text>
+    </xsl:when>
+    <xsl:otherwise>
+      <xsl:text>
+typedef struct ARENA_CHUNK {
+  struct ARENA_CHUNK *next;
+} arena_chunk;
+
+static arena_chunk *chunks = NULL;
+
+/*
+ * Returns a new chunk of size bytes.
+ */
+static char *ChunkAlloc( size_t size)
+{
+  arena_chunk *chunk;
+
+  chunk = (arena_chunk *) MEMmalloc( ARENA_ALIGN + size);
+
+  pthread_mutex_lock( &amp;chunks_lock);
+  chunk->next = chunks;
+  chunks = chunk;
+  pthread_mutex_unlock( &amp;chunks_lock);
+
+  return( (char *) chunk + ARENA_ALIGN);
+}
+</xsl:text>
+    </xsl:otherwise>
+  </xsl:choose>
+  <xsl:text>
+static char *NewChunk( void)
+{
+  char *result;
+
+  result = ChunkAlloc( ARENA_CHUNK_SIZE - ARENA_ALIGN);
+  limit = result + ARENA_CHUNK_SIZE - ARENA_ALIGN;
+
+  return( result);
+}
+
+/*
+ * Drops the chunk and recycle lists of the calling thread if the arena has
+ * been reset since it last allocated.
+ */
+static void SyncGeneration( void)
+{
+  if (thread_generation != generation) {
+    cursor = NULL;
+    limit = NULL;
+    memset( recycled, 0, sizeof( recycled));
+    thread_generation = generation;
+  }
+}
+
+/*
+ * Bumps a block of size bytes off the chunk of the calling thread. A block
+ * of more than a quarter chunk, as the array of a long list son, gets a
+ * chunk of its own instead.
+ */
+static void *ArenaAlloc( size_t size)
+{
+  void *result;
+
+  size = (size + ARENA_ALIGN - 1) &amp; ~(size_t) (ARENA_ALIGN - 1);
+
+  if (size &gt; ARENA_CHUNK_SIZE / 4) {
+    result = ChunkAlloc( size);
+  } else {
+    if ((cursor == NULL) || (cursor + size &gt; limit)) {
+      cursor = NewChunk();
+    }
+    result = cursor;
+    cursor += size;
+  }
+
+  return( result);
+}
+
+/*
+ * Allocates a block of size bytes for a node of the given type.
+ */
+static node *MakeEmptyNode( nodetype type, size_t size)
 {
   node *result;
 
   DBUG_ENTER("MakeEmptyNode");
 
-  result = (node *) MEMmalloc( sizeof( node));
+  SyncGeneration();
+
+  if (recycled[type] != NULL) {
+    result = recycled[type];
+    recycled[type] = *(node **) result;
+  } else {
+    result = (node *) ArenaAlloc( size);
+  }
 
-  NODE_LINE( result) = global.line;
-  NODE_COL( result) = global.col;
+  NODE_OFFSET( result) = parse_offset != NULL ? *parse_offset : global.line;
 
   DBUG_RETURN( result);
 }
 
+void TBrecycleNode( node *arg_node)
+{
+  nodetype type;
+
+  DBUG_ENTER("TBrecycleNode");
+
+  type = NODE_TYPE( arg_node);
+  *(node **) arg_node = recycled[type];
+  recycled[type] = arg_node;
+
+  DBUG_VOID_RETURN;
+}
+
+/*
+ * List sons, marked list in ast.xml, keep their items in an array from the
+ * arena. Appending to a full array moves the items to one of twice the
+ * size, so appending is amortised O(1); the old array is only given back
+ * with the arena, as is the array of a freed node.
+ */
+static struct LISTSON *ListOf( node *arg_node)
+{
+  struct LISTSON *result = NULL;
+
+  switch (NODE_TYPE( arg_node)) {
+  </xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node[sons/son[@list = 'yes']]" mode="listof"/>
+  <xsl:text>
+  default:
+    break;
+  }
+
+  return( result);
+}
+
+/*
+ * Unlinks son from parent and returns it, so that a subtree can be moved
+ * to a new parent instead of being copied before the old parent is freed:
+ *
+ *   init = TBdetachSon( arg_node, GLOBDEF_INIT( arg_node));
+ *
+ * Only the first son or item of parent that is son is unlinked, so a
+ * shared son that parent holds twice is detached by two calls.
+ */
+node *TBdetachSon( node *parent, node *son)
+{
+  struct LISTSON *list;
+  int i;
+
+  DBUG_ENTER("TBdetachSon");
+
+  if (son != NULL) {
+    switch (NODE_TYPE( parent)) {
   </xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node[sons/son[not( @list = 'yes')]]" mode="detach"/>
+  <xsl:text>
+    default:
+      break;
+    }
+
+    list = ListOf( parent);
+    if (list != NULL) {
+      for (i = 0; i &lt; list->count; i++) {
+        if (TBnode( list->items[i]) == son) {
+          list->items[i] = TBhandle( NULL);
+          DBUG_RETURN( son);
+        }
+      }
+    }
+
+    DBUG_ASSERT( FALSE, "TBdetachSon of a node that is no son of parent");
+  }
+
+  DBUG_RETURN( son);
+}
+
+/*
+ * Makes room for at least count items in list.
+ */
+static void ListReserve( struct LISTSON *son, int count)
+{
+  sonslot *items;
+  int size;
+
+  if (count &gt; son->size) {
+    SyncGeneration();
+    size = son->size == 0 ? 8 : 2 * son->size;
+    while (size &lt; count) {
+      size *= 2;
+    }
+    items = (sonslot *) ArenaAlloc( size * sizeof( sonslot));
+    if (son->count &gt; 0) {
+      memcpy( items, son->items, son->count * sizeof( sonslot));
+    }
+    son->items = items;
+    son->size = size;
+  }
+}
+
+/*
+ * Appends item to the list son of list and returns list:
+ *
+ *   stmts = TBappend( stmts, TBmakeAssign( let, expr));
+ */
+node *TBappend( node *list, node *item)
+{
+  struct LISTSON *son;
+
+  DBUG_ENTER("TBappend");
+
+  son = ListOf( list);
+
+  DBUG_ASSERT( (son != NULL), "TBappend on a node without a list son");
+
+  ListReserve( son, son->count + 1);
+  son->items[son->count++] = TBhandle( item);
+
+  DBUG_RETURN( list);
+}
+
+/*
+ * Moves the items of other into the list of list, in front of the item at
+ * index, and returns list. Other is left empty, to be freed by the caller.
+ */
+node *TBsplice( node *list, int index, node *other)
+{
+  struct LISTSON *son;
+  struct LISTSON *other_son;
+
+  DBUG_ENTER("TBsplice");
+
+  son = ListOf( list);
+  other_son = ListOf( other);
+
+  DBUG_ASSERT( ((son != NULL) &amp;&amp; (other_son != NULL)),
+               "TBsplice on a node without a list son");
+  DBUG_ASSERT( ((index &gt;= 0) &amp;&amp; (index &lt;= son->count)),
+               "TBsplice index out of range");
+
+  if (other_son->count &gt; 0) {
+    ListReserve( son, son->count + other_son->count);
+    memmove( son->items + index + other_son->count, son->items + index,
+             (son->count - index) * sizeof( sonslot));
+    memcpy( son->items + index, other_son->items, other_son->count * sizeof( sonslot));
+    son->count += other_son->count;
+    other_son->count = 0;
+  }
+
+  DBUG_RETURN( list);
+}
+
+/*
+ * Sets the number of items of list to count; new items are NULL.
+ */
+node *TBresize( node *list, int count)
+{
+  struct LISTSON *son;
+
+  DBUG_ENTER("TBresize");
+
+  son = ListOf( list);
+
+  DBUG_ASSERT( (son != NULL), "TBresize on a node without a list son");
+
+  ListReserve( son, count);
+  if (count &gt; son->count) {
+    memset( son->items + son->count, 0, (count - son->count) * sizeof( sonslot));
+  }
+  son->count = count;
+
+  DBUG_RETURN( list);
+}
+
+/*
+ * Removes the NULL items from the list son of arg_node, keeping the order
+ * of the others. Nodes without a list son are left alone.
+ */
+node *TBcompact( node *arg_node)
+{
+  struct LISTSON *son;
+  int i;
+  int kept = 0;
+
+  DBUG_ENTER("TBcompact");
+
+  son = ListOf( arg_node);
+
+  if (son != NULL) {
+    for (i = 0; i &lt; son->count; i++) {
+      if (TBnode( son->items[i]) != NULL) {
+        son->items[kept++] = son->items[i];
+      }
+    }
+    son->count = kept;
+  }
+
+  DBUG_RETURN( arg_node);
+}
+
+/*
+ * Hash-consing of the node types marked hashcons in ast.xml. TBshareXxx
+ * takes the arguments of TBmakeXxx and returns the one shared node with
+ * these fields, making it on first use. A node is only shared if all its
+ * sons are shared, so a shared node roots a shared subtree; otherwise
+ * TBshareXxx just makes a new node. Structurally equal shared subtrees are
+ * thus the same pointer. A shared node keeps the line of its first use.
+ *
+ * Shared nodes are immutable. A pass that changes a node for which
+ * TBisShared holds replaces it by TBunshare first, a private copy whose
+ * sons stay shared, so changes work top-down. FREE leaves shared nodes
+ * alone; they live until the arena is reset.
+ *
+ * The tables are not locked: sharing only starts after the parser threads
+ * have finished.
+ */
+#define SHARE_INITIAL_SLOTS 1024
+#define SHARE_SLOT( arg_node) \
+  ((((uintptr_t) (arg_node) &gt;&gt; 3) * (uintptr_t) 0x9E3779B1u) &amp; (share_slot_count - 1))
+
+typedef struct SHARE_ENTRY {
+  node *node;
+  unsigned int hash;
+} share_entry;
+
+/* shared nodes by structure, and the same nodes by address */
+static share_entry *share_slots = NULL;
+static node **shared_slots = NULL;
+static unsigned int share_slot_count = 0;
+static unsigned int share_count = 0;
+
+/*
+ * FNV-1a over the bytes of a field, folded into hash.
+ */
+static unsigned int ShareHash( unsigned int hash, const void *field, size_t size)
+{
+  const unsigned char *bytes = (const unsigned char *) field;
+  size_t i;
+
+  for (i = 0; i &lt; size; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+
+  return( hash);
+}
+
+static void ShareGrow( void)
+{
+  share_entry *old_slots = share_slots;
+  unsigned int old_count = share_slot_count;
+  unsigned int slot;
+  unsigned int i;
+
+  share_slot_count = old_count == 0 ? SHARE_INITIAL_SLOTS : 2 * old_count;
+  share_slots = MEMmalloc( share_slot_count * sizeof( share_entry));
+  memset( share_slots, 0, share_slot_count * sizeof( share_entry));
+  if (shared_slots != NULL) {
+    shared_slots = MEMfree( shared_slots);
+  }
+  shared_slots = MEMmalloc( share_slot_count * sizeof( node *));
+  memset( shared_slots, 0, share_slot_count * sizeof( node *));
+
+  for (i = 0; i &lt; old_count; i++) {
+    if (old_slots[i].node != NULL) {
+      slot = old_slots[i].hash &amp; (share_slot_count - 1);
+      while (share_slots[slot].node != NULL) {
+        slot = (slot + 1) &amp; (share_slot_count - 1);
+      }
+      share_slots[slot] = old_slots[i];
+
+      slot = SHARE_SLOT( old_slots[i].node);
+      while (shared_slots[slot] != NULL) {
+        slot = (slot + 1) &amp; (share_slot_count - 1);
+      }
+      shared_slots[slot] = old_slots[i].node;
+    }
+  }
+
+  if (old_slots != NULL) {
+    MEMfree( old_slots);
+  }
+}
+
+/*
+ * Enters arg_node, just made, as the shared node of its structure.
+ */
+static node *ShareInsert( node *arg_node, unsigned int hash)
+{
+  unsigned int slot;
+
+  DBUG_ENTER("ShareInsert");
+
+  if (2 * (share_count + 1) &gt; share_slot_count) {
+    ShareGrow();
+  }
+
+  slot = hash &amp; (share_slot_count - 1);
+  while (share_slots[slot].node != NULL) {
+    slot = (slot + 1) &amp; (share_slot_count - 1);
+  }
+  share_slots[slot].node = arg_node;
+  share_slots[slot].hash = hash;
+
+  slot = SHARE_SLOT( arg_node);
+  while (shared_slots[slot] != NULL) {
+    slot = (slot + 1) &amp; (share_slot_count - 1);
+  }
+  shared_slots[slot] = arg_node;
+
+  share_count++;
+
+  DBUG_RETURN( arg_node);
+}
+
+bool TBisShared( node *arg_node)
+{
+  unsigned int slot;
+  bool result = FALSE;
+
+  DBUG_ENTER("TBisShared");
+
+  if ((arg_node != NULL) &amp;&amp; (share_count &gt; 0)) {
+    slot = SHARE_SLOT( arg_node);
+    while ((shared_slots[slot] != NULL) &amp;&amp; (shared_slots[slot] != arg_node)) {
+      slot = (slot + 1) &amp; (share_slot_count - 1);
+    }
+    result = shared_slots[slot] == arg_node;
+  }
+
+  DBUG_RETURN( result);
+}
+
+void TBresetArena( void)
+{
+</xsl:text>
+  <xsl:choose>
+    <xsl:when test="$layout = 'handles'">
+      <xsl:text>
+  DBUG_ENTER("TBresetArena");
+
+  pthread_mutex_lock( &amp;chunks_lock);
+  if (TBhandleBase != NULL) {
+    madvise( TBhandleBase, region_used, MADV_DONTNEED);
+    region_used = ARENA_ALIGN;
+  }
+  generation++;
+</xsl:text>
+    </xsl:when>
+    <xsl:otherwise>
+      <xsl:text>
+  arena_chunk *chunk;
+
+  DBUG_ENTER("TBresetArena");
+
+  pthread_mutex_lock( &amp;chunks_lock);
+  while (chunks != NULL) {
+    chunk = chunks;
+    chunks = chunk->next;
+    MEMfree( chunk);
+  }
+  generation++;
+</xsl:text>
+    </xsl:otherwise>
+  </xsl:choose>
+  <xsl:text>
+  if (share_slots != NULL) {
+    share_slots = MEMfree( share_slots);
+    shared_slots = MEMfree( shared_slots);
+  }
+  share_slot_count = 0;
+  share_count = 0;
+  pthread_mutex_unlock( &amp;chunks_lock);
+
+  /* the indexes of the symbol tables go with the tables */
+  STfreeIndexes();
+
+  DBUG_VOID_RETURN;
+}
+
+  </xsl:text>
+  <xsl:if test="$layout != 'split'">
+    <xsl:text>
+/*
+ * A packed node is cut off after the structure of its type, so nothing but
+ * the SONUNION may follow the sons in the node.
+ */
+typedef char packed_layout_check[(offsetof( node, sons) + sizeof( struct SONUNION) == sizeof( node)) ? 1 : -1];
+
+    </xsl:text>
+  </xsl:if>
   <xsl:apply-templates select="//syntaxtree/node"/>
+  <xsl:apply-templates select="//syntaxtree" mode="unshare"/>
   <xsl:text>
   /* end of file */
 
   </xsl:text>
 </xsl:template>
 
+<!-- the case of ListOf for a node with a list son -->
+<xsl:template match="node" mode="listof">
+  <xsl:value-of select="'case '"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name" />
+  </xsl:call-template>
+  <xsl:value-of select="': result = &amp;arg_node->sons.'"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name" />
+  </xsl:call-template>
+  <xsl:choose>
+    <xsl:when test="$layout != 'split'">
+      <xsl:value-of select="'.'"/>
+    </xsl:when>
+    <xsl:otherwise>
+      <xsl:value-of select="'->'"/>
+    </xsl:otherwise>
+  </xsl:choose>
+  <xsl:value-of select="sons/son[@list = 'yes']/@name"/>
+  <xsl:value-of select="'; break;'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+<!-- the case of TBdetachSon for a node with sons other than a list son -->
+<xsl:template match="node" mode="detach">
+  <xsl:value-of select="'case '"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name" />
+  </xsl:call-template>
+  <xsl:value-of select="': '"/>
+  <xsl:for-each select="sons/son[not( @list = 'yes')]">
+    <xsl:value-of select="'if ('"/>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">parent</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="'== son) { '"/>
+    <xsl:call-template name="node-set">
+      <xsl:with-param name="node">parent</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+      <xsl:with-param name="value">NULL</xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="'; DBUG_RETURN( son); } '"/>
+  </xsl:for-each>
+  <xsl:value-of select="'break;'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
 <xsl:template match="node">
   <xsl:text>
 
@@ -124,6 +734,185 @@ static node *MakeEmptyNode()
   </xsl:text>
   <xsl:apply-templates select="." mode="make-head"/>
   <xsl:apply-templates select="." mode="make-body"/>
+  <xsl:if test="@hashcons = 'yes'">
+    <xsl:apply-templates select="." mode="share"/>
+  </xsl:if>
+</xsl:template>
+
+<!-- the share function of a hashcons node: hashes the node type and the
+     arguments, and returns the shared node with equal attributes and the
+     same sons, or makes and enters one. Attributes are compared by their
+     bytes through a copy, as bitfields have no address -->
+<xsl:template match="node" mode="share">
+  <xsl:variable name="nodeenum">
+    <xsl:call-template name="name-to-nodeenum">
+      <xsl:with-param name="name" select="@name" />
+    </xsl:call-template>
+  </xsl:variable>
+  <xsl:variable name="make">
+    <xsl:value-of select="'TBmake'"/>
+    <xsl:call-template name="make-name"/>
+    <xsl:call-template name="make-arguments"/>
+  </xsl:variable>
+  <xsl:variable name="attributes" select="attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;]"/>
+  <xsl:variable name="sons" select="sons/son[not(@default)][not(@list = 'yes')]"/>
+  <xsl:apply-templates select="." mode="share-head"/>
+  <xsl:value-of select="'{'"/>
+  <xsl:value-of select="concat( 'nodetype share_type = ', $nodeenum, '; ')"/>
+  <xsl:value-of select="'unsigned int hash; unsigned int slot; node *shared; node *result = NULL; '"/>
+  <xsl:for-each select="$attributes">
+    <xsl:value-of select="concat( key( &quot;types&quot;, ./type/@name)/@ctype, ' ', @name, '_shared; ')"/>
+  </xsl:for-each>
+  <xsl:value-of select="'DBUG_ENTER(&quot;TBshare'"/>
+  <xsl:call-template name="make-name"/>
+  <xsl:value-of select="'&quot;); '"/>
+  <xsl:if test="$sons">
+    <xsl:value-of select="'if ('"/>
+    <xsl:for-each select="$sons">
+      <xsl:if test="position() != 1">
+        <xsl:value-of select="' || '"/>
+      </xsl:if>
+      <xsl:value-of select="concat( '((', @name, ' != NULL) &amp;&amp; !TBisShared( ', @name, '))')"/>
+    </xsl:for-each>
+    <xsl:value-of select="concat( ') { DBUG_RETURN( ', $make, '); } ')"/>
+  </xsl:if>
+  <xsl:value-of select="'hash = ShareHash( 2166136261u, &amp;share_type, sizeof( share_type)); '"/>
+  <xsl:for-each select="$attributes | $sons">
+    <xsl:value-of select="concat( 'hash = ShareHash( hash, &amp;', @name, ', sizeof( ', @name, ')); ')"/>
+  </xsl:for-each>
+  <xsl:value-of select="'if (share_count &gt; 0) { slot = hash &amp; (share_slot_count - 1); '"/>
+  <xsl:value-of select="'while ((result == NULL) &amp;&amp; (share_slots[slot].node != NULL)) { '"/>
+  <xsl:value-of select="'shared = share_slots[slot].node; '"/>
+  <xsl:value-of select="'if ((share_slots[slot].hash == hash) &amp;&amp; (NODE_TYPE( shared) == share_type)) { '"/>
+  <xsl:for-each select="$attributes">
+    <xsl:value-of select="concat( @name, '_shared = ')"/>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">shared</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="'; '"/>
+  </xsl:for-each>
+  <xsl:value-of select="'if ('"/>
+  <xsl:for-each select="$attributes | $sons">
+    <xsl:sort select="count( parent::attributes)" order="descending"/>
+    <xsl:if test="position() != 1">
+      <xsl:value-of select="' &amp;&amp; '"/>
+    </xsl:if>
+    <xsl:choose>
+      <xsl:when test="self::attribute">
+        <xsl:value-of select="concat( '(memcmp( &amp;', @name, '_shared, &amp;', @name, ', sizeof( ', @name, ')) == 0)')"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="'('"/>
+        <xsl:call-template name="node-access">
+          <xsl:with-param name="node">shared</xsl:with-param>
+          <xsl:with-param name="nodetype" select="../../@name"/>
+          <xsl:with-param name="field" select="@name"/>
+        </xsl:call-template>
+        <xsl:value-of select="concat( '== ', @name, ')')"/>
+      </xsl:otherwise>
+    </xsl:choose>
+  </xsl:for-each>
+  <xsl:value-of select="') { result = shared; } } '"/>
+  <xsl:value-of select="'slot = (slot + 1) &amp; (share_slot_count - 1); } } '"/>
+  <xsl:value-of select="concat( 'if (result == NULL) { result = ShareInsert( ', $make, ', hash); } ')"/>
+  <xsl:value-of select="'DBUG_RETURN( result); }'"/>
+</xsl:template>
+
+<!-- the arguments of a make call, named like its parameters: the
+     attributes first, as in make-parameters, then the sons -->
+<xsl:template name="make-arguments">
+  <xsl:value-of select="'( '"/>
+  <xsl:for-each select="attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;] | sons/son[not(@default)][not(@list = 'yes')]">
+    <xsl:sort select="count( parent::attributes)" order="descending"/>
+    <xsl:if test="position() != 1">
+      <xsl:value-of select="', '"/>
+    </xsl:if>
+    <xsl:value-of select="@name"/>
+  </xsl:for-each>
+  <xsl:value-of select="')'"/>
+</xsl:template>
+
+<!-- TBunshare: a private copy of a shared node, made with the fields of the
+     original; the sons stay shared -->
+<xsl:template match="syntaxtree" mode="unshare">
+  <xsl:text>
+node *TBunshare( node *arg_node)
+{
+  node *result = arg_node;
+
+  DBUG_ENTER("TBunshare");
+
+  if (TBisShared( arg_node)) {
+    switch (NODE_TYPE( arg_node)) {
+  </xsl:text>
+  <xsl:apply-templates select="node[@hashcons = 'yes']" mode="unshare"/>
+  <xsl:text>
+    default:
+      DBUG_ASSERT( FALSE, "shared node of a type without hashcons");
+      break;
+    }
+    NODE_OFFSET( result) = NODE_OFFSET( arg_node);
+  }
+
+  DBUG_RETURN( result);
+}
+  </xsl:text>
+</xsl:template>
+
+<xsl:template match="node" mode="unshare">
+  <xsl:variable name="node" select="@name"/>
+  <xsl:value-of select="'case '"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name" />
+  </xsl:call-template>
+  <xsl:value-of select="': result = TBmake'"/>
+  <xsl:call-template name="make-name"/>
+  <xsl:value-of select="'( '"/>
+  <xsl:for-each select="attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;] | sons/son[not(@default)][not(@list = 'yes')]">
+    <xsl:sort select="count( parent::attributes)" order="descending"/>
+    <xsl:if test="position() != 1">
+      <xsl:value-of select="', '"/>
+    </xsl:if>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="$node"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+  </xsl:for-each>
+  <xsl:value-of select="'); '"/>
+  <!-- the attributes and sons that are no parameters of the make function -->
+  <xsl:for-each select="sons/son[@default]">
+    <xsl:call-template name="node-set">
+      <xsl:with-param name="node">result</xsl:with-param>
+      <xsl:with-param name="nodetype" select="$node"/>
+      <xsl:with-param name="field" select="@name"/>
+      <xsl:with-param name="value">
+        <xsl:call-template name="node-access">
+          <xsl:with-param name="node">arg_node</xsl:with-param>
+          <xsl:with-param name="nodetype" select="$node"/>
+          <xsl:with-param name="field" select="@name"/>
+        </xsl:call-template>
+      </xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="'; '"/>
+  </xsl:for-each>
+  <xsl:for-each select="attributes/attribute[not( type/targets/target/phases/all) or @default or not( type/targets/target/@mandatory = &quot;yes&quot;)]">
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">result</xsl:with-param>
+      <xsl:with-param name="nodetype" select="$node"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="' = '"/>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="$node"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="'; '"/>
+  </xsl:for-each>
+  <xsl:value-of select="'break; '"/>
 </xsl:template>
 
 </xsl:stylesheet>
@@ -85,6 +85,24 @@ version="1.0">
 
 #include "types.h"
 
+/*
+ * A node records the byte offset at which it starts in the scanned text,
+ * not a line: LOCline and LOCcol in location.h turn the offset into a
+ * line and a column for diagnostics. The offset is kept in the line field
+ * of the node header; NODE_LINE and NODE_COL are not to be used.
+ */
+#define NODE_OFFSET( n) NODE_LINE( n)
+
+extern void TBrecycleNode( node *arg_node);
+extern void TBresetArena( void);
+extern node *TBdetachSon( node *parent, node *son);
+extern bool TBisShared( node *arg_node);
+extern node *TBunshare( node *arg_node);
+extern node *TBappend( node *list, node *item);
+extern node *TBsplice( node *list, int index, node *other);
+extern node *TBresize( node *list, int count);
+extern node *TBcompact( node *arg_node);
+
   </xsl:text>
   <xsl:apply-templates select="/definition/@version"/>
   <xsl:apply-templates select="//syntaxtree/node"/>
@@ -119,6 +137,9 @@ version="1.0">
   <xsl:apply-templates select="attributes/attribute" mode="accessor-macros"/>
   <xsl:apply-templates select="flags" mode="accessor-macros"/>
   <xsl:apply-templates select="." mode="make-head"/>
+  <xsl:if test="@hashcons = 'yes'">
+    <xsl:apply-templates select="." mode="share-head"/>
+  </xsl:if>
 </xsl:template>
 
 <xsl:template match="node" mode="make-head">
@@ -127,4 +148,10 @@ version="1.0">
   <xsl:value-of select="';'"/>
 </xsl:template>
 
+<xsl:template match="node" mode="share-head">
+  <xsl:value-of select="'extern '"/>
+  <xsl:apply-imports/>
+  <xsl:value-of select="';'"/>
+</xsl:template>
+
 </xsl:stylesheet>
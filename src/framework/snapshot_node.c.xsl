@@ -0,0 +1,1050 @@
+<?xml version="1.0"?>
+
+
+<!--
+
+****************************************************************************
+* 
+* SAC Compiler Construction Framework
+* 
+****************************************************************************
+* 
+* SAC COPYRIGHT NOTICE, LICENSE, AND DISCLAIMER
+* 
+* (c) Copyright 1994 - 2011 by
+* 
+*   SAC Development Team
+*   SAC Research Foundation
+* 
+*   http://www.sac-home.org
+*   email:info@sac-home.org
+* 
+*   All rights reserved
+* 
+****************************************************************************
+* 
+* The SAC compiler construction framework, all accompanying 
+* software and documentation (in the following named this software)
+* is developed by the SAC Development Team (in the following named
+* the developer) which reserves all rights on this software.
+* 
+* Permission to use this software is hereby granted free of charge
+* exclusively for the duration and purpose of the course 
+*   "Compilers and Operating Systems" 
+* of the MSc programme Grid Computing at the University of Amsterdam.
+* Redistribution of the software or any parts thereof as well as any
+* alteration  of the software or any parts thereof other than those 
+* required to use the compiler construction framework for the purpose
+* of the above mentioned course are not permitted.
+* 
+* The developer disclaims all warranties with regard to this software,
+* including all implied warranties of merchantability and fitness.  In no
+* event shall the developer be liable for any special, indirect or
+* consequential damages or any damages whatsoever resulting from loss of
+* use, data, or profits, whether in an action of contract, negligence, or
+* other tortuous action, arising out of or in connection with the use or
+* performance of this software. The entire risk as to the quality and
+* performance of this software is with you. Should this software prove
+* defective, you assume the cost of all servicing, repair, or correction.
+* 
+****************************************************************************
+ 
+ -->
+
+
+<xsl:stylesheet xmlns:xsl="http://www.w3.org/1999/XSL/Transform"
+version="1.0">
+
+<xsl:import href="common-key-tables.xsl"/>
+<xsl:import href="common-travfun.xsl"/>
+<xsl:import href="common-node-access.xsl"/>
+<xsl:import href="common-c-code.xsl"/>
+<xsl:import href="common-make-head.xsl"/>
+<xsl:import href="common-name-to-nodeenum.xsl"/>
+
+<xsl:output method="text" indent="no"/>
+<xsl:strip-space elements="*"/>
+
+<!-- This stylesheet generates a snapshot_node.c file that writes a syntax
+     tree, with its symbol tables and links, to a binary image and reads it
+     back. The field kinds of every node type are written down in a table,
+     so that images are checked and read by a single loop; only getting and
+     setting the fields is generated per node type.
+
+     Field kinds:  s  son          l  link
+                   L  list son, its number of items and then the items
+                   n  interned name (copy literal)
+                   t  string (copy function)
+                   w  any other attribute, in one word
+                   f  the flags of the node, one bit each   -->
+
+<xsl:template match="/">
+  <xsl:call-template name="travfun-file">
+    <xsl:with-param name="file">
+      <xsl:value-of select="'snapshot_node.c'"/>
+    </xsl:with-param>
+    <xsl:with-param name="desc">
+      <xsl:value-of select="'Functions to encode and decode syntax tree images.'"/>
+    </xsl:with-param>
+    <xsl:with-param name="xslt">
+      <xsl:value-of select="'snapshot_node.c.xsl'"/>
+    </xsl:with-param>
+  </xsl:call-template>
+  <xsl:text>
+
+#include &lt;stdint.h&gt;
+#include &lt;string.h&gt;
+
+#include "snapshot_node.h"
+#include "tree_basic.h"
+#include "ctinfo.h"
+#include "dbug.h"
+#include "names.h"
+#include "str.h"
+#include "memory.h"
+
+/*
+ * An image is an array of 32-bit words in host byte order, followed by
+ * the strings it refers to:
+ *
+ *   header   hash of the node layout below, number of nodes, number of
+ *            record words, number of string bytes
+ *   records  one per node, sons before the nodes they belong to, so that
+ *            the root comes last:
+ *              node type, or'ed with SNP_SHARED for a node shared by
+ *              TBshareXxx, source offset,
+ *              then the sons, attributes and flags in the order of ast.xml,
+ *              a list son as its number of items followed by the items
+ *            where nodes are given as their record number + 1, and strings
+ *            as their offset in the string area + 1; 0 stands for NULL
+ *   strings  NUL-terminated
+ *
+ * The image does not hold a single pointer, so it can be read straight
+ * from a mapped file. A node that is the son of several others, as shared
+ * nodes are, has a single record.
+ */
+#define SNP_SHARED 0x80000000u
+#define SNP_HEADER_WORDS 4
+#define SNP_NODE_WORDS 2
+#define SNP_MAX_SONS </xsl:text>
+  <xsl:for-each select="//syntaxtree/node">
+    <xsl:sort select="count( sons/son[not( @list = 'yes')])" data-type="number" order="descending"/>
+    <xsl:if test="position() = 1">
+      <xsl:value-of select="count( sons/son[not( @list = 'yes')])"/>
+    </xsl:if>
+  </xsl:for-each>
+  <xsl:text>
+
+/* Attributes of kind w have to fit into a word. */
+</xsl:text>
+  <xsl:apply-templates select="//attributetypes/type[@ctype != 'char*'][@ctype != 'node*']" mode="check"/>
+  <xsl:text>
+static const char *const fields[MAX_NODES + 1] = {
+</xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node" mode="fields"/>
+  <xsl:text>};
+
+/* Names the node types and their fields, for the layout hash. */
+static const char layout[] =
+</xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node" mode="layout"/>
+  <xsl:text>;
+
+static uint32_t LayoutHash( void)
+{
+  uint32_t hash = 2166136261u;
+  const char *p;
+
+  for (p = layout; *p != '\0'; p++) {
+    hash = (hash ^ (unsigned char) *p) * 16777619u;
+  }
+
+  return( hash);
+}
+
+/*
+ * Open-addressed hash map from node or string addresses to their number
+ * in the image. It grows to keep at least half of its slots free.
+ */
+typedef struct SNP_SLOT {
+  const void *key;
+  uint32_t value;
+} snp_slot;
+
+typedef struct SNP_MAP {
+  snp_slot *slots;
+  size_t mask;
+  size_t count;
+} snp_map;
+
+#define SNP_SLOT( map, key) \
+  ((((uintptr_t) (key) &gt;&gt; 3) * (uintptr_t) 0x9E3779B1u) &amp; (map)-&gt;mask)
+
+static void MapInit( snp_map *map, size_t size)
+{
+  map-&gt;slots = MEMmalloc( size * sizeof( snp_slot));
+  memset( map-&gt;slots, 0, size * sizeof( snp_slot));
+  map-&gt;mask = size - 1;
+  map-&gt;count = 0;
+}
+
+static uint32_t MapFind( snp_map *map, const void *key)
+{
+  size_t slot;
+
+  for (slot = SNP_SLOT( map, key); map-&gt;slots[slot].key != NULL;
+       slot = (slot + 1) &amp; map-&gt;mask) {
+    if (map-&gt;slots[slot].key == key) {
+      return( map-&gt;slots[slot].value);
+    }
+  }
+
+  return( 0);
+}
+
+static void MapInsert( snp_map *map, const void *key, uint32_t value)
+{
+  snp_slot *old = map-&gt;slots;
+  size_t old_size = map-&gt;mask + 1;
+  size_t slot;
+  size_t i;
+
+  if (2 * (map-&gt;count + 1) &gt; old_size) {
+    MapInit( map, 2 * old_size);
+    for (i = 0; i &lt; old_size; i++) {
+      if (old[i].key != NULL) {
+        MapInsert( map, old[i].key, old[i].value);
+      }
+    }
+    old = MEMfree( old);
+  }
+
+  for (slot = SNP_SLOT( map, key); map-&gt;slots[slot].key != NULL;
+       slot = (slot + 1) &amp; map-&gt;mask) {
+  }
+
+  map-&gt;slots[slot].key = key;
+  map-&gt;slots[slot].value = value;
+  map-&gt;count++;
+}
+
+/*
+ * Encoding
+ */
+typedef struct SNP_WRITER {
+  snp_map nodes;
+  snp_map strings;
+  char *text;
+  size_t text_size;
+  size_t text_capacity;
+} snp_writer;
+
+static uint32_t PutSon( snp_writer *writer, node *son)
+{
+  return( son == NULL ? 0 : MapFind( &amp;writer-&gt;nodes, son));
+}
+
+static uint32_t PutLink( snp_writer *writer, node *target)
+{
+  uint32_t number;
+
+  if (target == NULL) {
+    return( 0);
+  }
+
+  number = MapFind( &amp;writer-&gt;nodes, target);
+  if (number == 0) {
+    CTIabort( "Cannot take a snapshot of a syntax tree with a link out of it");
+  }
+  DBUG_ASSERT( !TBisShared( target), "snapshot of a link to a shared node");
+
+  return( number);
+}
+
+static uint32_t PutString( snp_writer *writer, const char *string)
+{
+  uint32_t number;
+  size_t length;
+  char *grown;
+
+  if (string == NULL) {
+    return( 0);
+  }
+
+  number = MapFind( &amp;writer-&gt;strings, string);
+  if (number == 0) {
+    length = strlen( string) + 1;
+    if (writer-&gt;text_size + length &gt; writer-&gt;text_capacity) {
+      while (writer-&gt;text_size + length &gt; writer-&gt;text_capacity) {
+        writer-&gt;text_capacity *= 2;
+      }
+      grown = MEMmalloc( writer-&gt;text_capacity);
+      memcpy( grown, writer-&gt;text, writer-&gt;text_size);
+      writer-&gt;text = MEMfree( writer-&gt;text);
+      writer-&gt;text = grown;
+    }
+    memcpy( writer-&gt;text + writer-&gt;text_size, string, length);
+    number = (uint32_t) writer-&gt;text_size + 1;
+    writer-&gt;text_size += length;
+    MapInsert( &amp;writer-&gt;strings, string, number);
+  }
+
+  return( number);
+}
+
+/*
+ * Fills sons with the sons of arg_node but for its list son; returns how
+ * many there are.
+ */
+static int Sons( node *arg_node, node **sons)
+{
+  switch (NODE_TYPE( arg_node)) {
+</xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node" mode="sons"/>
+  <xsl:text>
+  default:
+    return( 0);
+  }
+}
+
+/* Returns the items of the list son of arg_node and sets count to their number. */
+static sonslot *Items( node *arg_node, int *count)
+{
+  switch (NODE_TYPE( arg_node)) {
+</xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node[sons/son[@list = 'yes']]" mode="items"/>
+  <xsl:text>
+  default:
+    *count = 0;
+    return( NULL);
+  }
+}
+
+/* Writes the fields of arg_node from pos on; returns the end of them. */
+static uint32_t *PutFields( snp_writer *writer, node *arg_node, uint32_t *pos)
+{
+  switch (NODE_TYPE( arg_node)) {
+</xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node" mode="put"/>
+  <xsl:text>
+  default:
+    DBUG_ASSERT( FALSE, "snapshot of a node of unknown type");
+    break;
+  }
+
+  return( pos);
+}
+
+typedef struct SNP_FRAME {
+  node *node;
+  int next;
+  int count;
+  int item_count;
+  sonslot *items;
+  node *sons[SNP_MAX_SONS + 1];
+} snp_frame;
+
+/**
+ * Encodes the syntax tree below syntaxtree into an image. Links must point
+ * into the tree.
+ *
+ * @param size Set to the size of the image in bytes.
+ * @return The image, to be freed with MEMfree.
+ */
+void *SNPencodeTree( node *syntaxtree, size_t *size)
+{
+  snp_writer writer;
+  snp_frame *stack;
+  snp_frame *grown;
+  snp_frame *frame;
+  node **order;
+  node **order_grown;
+  node *son;
+  size_t stack_size = 64;
+  size_t top = 0;
+  size_t order_size = 256;
+  size_t count = 0;
+  size_t record_words = 0;
+  size_t i;
+  uint32_t *words;
+  uint32_t *pos;
+  char *image;
+
+  DBUG_ENTER("SNPencodeTree");
+
+  DBUG_ASSERT( (syntaxtree != NULL), "snapshot of an empty syntax tree");
+
+  MapInit( &amp;writer.nodes, 256);
+  MapInit( &amp;writer.strings, 256);
+  writer.text_capacity = 1024;
+  writer.text_size = 0;
+  writer.text = MEMmalloc( writer.text_capacity);
+
+  /*
+   * Numbers the nodes in post-order with an explicit stack, so that deep
+   * trees take no C stack.
+   */
+  stack = MEMmalloc( stack_size * sizeof( snp_frame));
+  order = MEMmalloc( order_size * sizeof( node *));
+
+  stack[0].node = syntaxtree;
+  stack[0].next = 0;
+  stack[0].count = Sons( syntaxtree, stack[0].sons);
+  stack[0].items = Items( syntaxtree, &amp;stack[0].item_count);
+  top = 1;
+
+  while (top &gt; 0) {
+    frame = &amp;stack[top - 1];
+    if (frame-&gt;next &lt; frame-&gt;count + frame-&gt;item_count) {
+      son = frame-&gt;next &lt; frame-&gt;count
+              ? frame-&gt;sons[frame-&gt;next]
+              : TBnode( frame-&gt;items[frame-&gt;next - frame-&gt;count]);
+      frame-&gt;next++;
+      if ((son != NULL) &amp;&amp; (MapFind( &amp;writer.nodes, son) == 0)) {
+        if (top == stack_size) {
+          grown = MEMmalloc( 2 * stack_size * sizeof( snp_frame));
+          memcpy( grown, stack, stack_size * sizeof( snp_frame));
+          stack = MEMfree( stack);
+          stack = grown;
+          stack_size *= 2;
+        }
+        stack[top].node = son;
+        stack[top].next = 0;
+        stack[top].count = Sons( son, stack[top].sons);
+        stack[top].items = Items( son, &amp;stack[top].item_count);
+        top++;
+      }
+    } else {
+      if (count == order_size) {
+        order_grown = MEMmalloc( 2 * order_size * sizeof( node *));
+        memcpy( order_grown, order, order_size * sizeof( node *));
+        order = MEMfree( order);
+        order = order_grown;
+        order_size *= 2;
+      }
+      order[count++] = frame-&gt;node;
+      MapInsert( &amp;writer.nodes, frame-&gt;node, (uint32_t) count);
+      record_words += SNP_NODE_WORDS + strlen( fields[NODE_TYPE( frame-&gt;node)]) + frame-&gt;item_count;
+      top--;
+    }
+  }
+
+  stack = MEMfree( stack);
+
+  words = MEMmalloc( (SNP_HEADER_WORDS + record_words) * sizeof( uint32_t));
+  memset( words, 0, (SNP_HEADER_WORDS + record_words) * sizeof( uint32_t));
+
+  pos = words + SNP_HEADER_WORDS;
+  for (i = 0; i &lt; count; i++) {
+    pos[0] = (uint32_t) NODE_TYPE( order[i]);
+    if (TBisShared( order[i])) {
+      pos[0] |= SNP_SHARED;
+    }
+    pos[1] = (uint32_t) NODE_OFFSET( order[i]);
+    pos = PutFields( &amp;writer, order[i], pos + SNP_NODE_WORDS);
+  }
+
+  DBUG_ASSERT( (pos == words + SNP_HEADER_WORDS + record_words),
+               "snapshot records of unexpected size");
+
+  words[0] = LayoutHash();
+  words[1] = (uint32_t) count;
+  words[2] = (uint32_t) record_words;
+  words[3] = (uint32_t) writer.text_size;
+
+  *size = (SNP_HEADER_WORDS + record_words) * sizeof( uint32_t) + writer.text_size;
+  image = MEMmalloc( *size);
+  memcpy( image, words, (SNP_HEADER_WORDS + record_words) * sizeof( uint32_t));
+  memcpy( image + (SNP_HEADER_WORDS + record_words) * sizeof( uint32_t),
+          writer.text, writer.text_size);
+
+  words = MEMfree( words);
+  order = MEMfree( order);
+  writer.text = MEMfree( writer.text);
+  writer.nodes.slots = MEMfree( writer.nodes.slots);
+  writer.strings.slots = MEMfree( writer.strings.slots);
+
+  DBUG_RETURN( image);
+}
+
+/*
+ * Decoding
+ */
+typedef struct SNP_READER {
+  node **nodes;
+  const char *text;
+} snp_reader;
+
+static node *GetNode( snp_reader *reader, uint32_t number)
+{
+  return( number == 0 ? NULL : reader-&gt;nodes[number - 1]);
+}
+
+static char *GetName( snp_reader *reader, uint32_t number)
+{
+  return( number == 0 ? NULL : NAMEintern( reader-&gt;text + number - 1));
+}
+
+static char *GetString( snp_reader *reader, uint32_t number)
+{
+  return( number == 0 ? NULL : STRcpy( reader-&gt;text + number - 1));
+}
+
+/* Makes a node of the given type with its fields at their defaults. */
+static node *MakeNode( nodetype type)
+{
+  switch (type) {
+</xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node" mode="make"/>
+  <xsl:text>
+  default:
+    return( NULL);
+  }
+}
+
+/* Sets the fields of arg_node from pos on. */
+static void GetFields( snp_reader *reader, node *arg_node, const uint32_t *pos)
+{
+  switch (NODE_TYPE( arg_node)) {
+</xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node" mode="get"/>
+  <xsl:text>
+  default:
+    break;
+  }
+}
+
+/*
+ * Returns the shared node with the fields of the private node arg_node,
+ * or NULL if nodes of its type are not shared.
+ */
+static node *Share( node *arg_node)
+{
+  node *result;
+
+  switch (NODE_TYPE( arg_node)) {
+</xsl:text>
+  <xsl:apply-templates select="//syntaxtree/node[@hashcons = 'yes']" mode="share"/>
+  <xsl:text>
+  default:
+    return( NULL);
+  }
+
+  return( result);
+}
+
+/* Returns the number of words of the record at pos. */
+static size_t RecordWords( const uint32_t *pos)
+{
+  const char *kinds = fields[pos[0] &amp; ~SNP_SHARED];
+  const char *list = strchr( kinds, 'L');
+
+  return( SNP_NODE_WORDS + strlen( kinds)
+          + (list == NULL ? 0 : pos[SNP_NODE_WORDS + (list - kinds)]));
+}
+
+/*
+ * Checks that every record of the image is complete, that sons come
+ * before the nodes they belong to, that links stay within the image and
+ * that strings start within the string area.
+ */
+static bool Check( const uint32_t *words, uint32_t count, uint32_t record_words,
+                   uint32_t text_size)
+{
+  const uint32_t *pos = words;
+  const uint32_t *end = words + record_words;
+  const char *kind;
+  uint32_t type;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 0; i &lt; count; i++) {
+    if (end - pos &lt; SNP_NODE_WORDS) {
+      return( FALSE);
+    }
+    type = pos[0] &amp; ~SNP_SHARED;
+    if ((type == 0) || (type &gt; MAX_NODES)
+        || ((size_t) (end - pos) &lt; SNP_NODE_WORDS + strlen( fields[type]))) {
+      return( FALSE);
+    }
+    for (kind = fields[type], pos += SNP_NODE_WORDS; *kind != '\0'; kind++, pos++) {
+      switch (*kind) {
+      case 's':
+        if (*pos &gt; i) {
+          return( FALSE);
+        }
+        break;
+      case 'L':
+        if ((size_t) (end - pos) &lt; 1 + (size_t) *pos + strlen( kind + 1)) {
+          return( FALSE);
+        }
+        for (j = 1; j &lt;= *pos; j++) {
+          if (pos[j] &gt; i) {
+            return( FALSE);
+          }
+        }
+        pos += *pos;
+        break;
+      case 'l':
+        if (*pos &gt; count) {
+          return( FALSE);
+        }
+        break;
+      case 'n':
+      case 't':
+        if (*pos &gt; text_size) {
+          return( FALSE);
+        }
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  return( pos == end);
+}
+
+/**
+ * Decodes an image made by SNPencodeTree, by making all nodes first and
+ * then setting their fields. Nodes that were shared are shared again.
+ *
+ * @param image The image, aligned to 4 bytes.
+ * @param size Size of the image in bytes.
+ * @return The root of the syntax tree, or NULL if the image is corrupt or
+ *         was made for a different node layout.
+ */
+node *SNPdecodeTree( const void *image, size_t size)
+{
+  const uint32_t *words = image;
+  const uint32_t *records;
+  const uint32_t *pos;
+  const uint32_t **starts;
+  snp_reader reader;
+  node *shared;
+  node *result;
+  uint32_t count;
+  uint32_t record_words;
+  uint32_t text_size;
+  uint32_t i;
+
+  DBUG_ENTER("SNPdecodeTree");
+
+  if ((size &lt; SNP_HEADER_WORDS * sizeof( uint32_t)) || (((uintptr_t) image &amp; 3) != 0)) {
+    DBUG_RETURN( NULL);
+  }
+
+  count = words[1];
+  record_words = words[2];
+  text_size = words[3];
+  records = words + SNP_HEADER_WORDS;
+  reader.text = (const char *) (records + record_words);
+
+  if ((words[0] != LayoutHash()) || (count == 0)
+      || (record_words &gt; size / sizeof( uint32_t))
+      || ((SNP_HEADER_WORDS + (size_t) record_words) * sizeof( uint32_t) + text_size != size)
+      || ((text_size &gt; 0) &amp;&amp; (reader.text[text_size - 1] != '\0'))
+      || !Check( records, count, record_words, text_size)) {
+    DBUG_RETURN( NULL);
+  }
+
+  reader.nodes = MEMmalloc( count * sizeof( node *));
+  starts = MEMmalloc( count * sizeof( uint32_t *));
+
+  pos = records;
+  for (i = 0; i &lt; count; i++) {
+    starts[i] = pos;
+    reader.nodes[i] = MakeNode( (nodetype) (pos[0] &amp; ~SNP_SHARED));
+    NODE_OFFSET( reader.nodes[i]) = (int) pos[1];
+    pos += RecordWords( pos);
+  }
+
+  /*
+   * Sons come before the nodes they belong to, so a node is shared again
+   * after its sons have been.
+   */
+  for (i = 0; i &lt; count; i++) {
+    GetFields( &amp;reader, reader.nodes[i], starts[i] + SNP_NODE_WORDS);
+    if ((starts[i][0] &amp; SNP_SHARED) != 0) {
+      shared = Share( reader.nodes[i]);
+      if (shared != NULL) {
+        NODE_OFFSET( shared) = NODE_OFFSET( reader.nodes[i]);
+        TBrecycleNode( reader.nodes[i]);
+        reader.nodes[i] = shared;
+      }
+    }
+  }
+
+  result = reader.nodes[count - 1];
+
+  reader.nodes = MEMfree( reader.nodes);
+  starts = MEMfree( starts);
+
+  DBUG_RETURN( result);
+}
+  </xsl:text>
+</xsl:template>
+
+
+<!-- the check that an attribute type of kind w fits into a word -->
+<xsl:template match="type" mode="check">
+  <xsl:value-of select="concat( 'typedef char snp_fits_', @name, '[sizeof( ', @ctype, ') &lt;= sizeof( uint32_t) ? 1 : -1];')"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+
+<!-- the field kind of an attribute -->
+<xsl:template match="attribute" mode="kind">
+  <xsl:variable name="type" select="key( &quot;types&quot;, ./type/@name)"/>
+  <xsl:choose>
+    <xsl:when test="$type/@ctype = 'node*'">l</xsl:when>
+    <xsl:when test="$type/@ctype = 'char*' and $type/@copy = 'literal'">n</xsl:when>
+    <xsl:when test="$type/@ctype = 'char*'">t</xsl:when>
+    <xsl:otherwise>w</xsl:otherwise>
+  </xsl:choose>
+</xsl:template>
+
+
+<!-- the field kinds of a node, in the order of its record -->
+<xsl:template match="node" mode="kinds">
+  <xsl:for-each select="sons/son">
+    <xsl:choose>
+      <xsl:when test="@list = 'yes'">L</xsl:when>
+      <xsl:otherwise>s</xsl:otherwise>
+    </xsl:choose>
+  </xsl:for-each>
+  <xsl:apply-templates select="attributes/attribute" mode="kind"/>
+  <xsl:if test="flags/flag">
+    <xsl:value-of select="'f'"/>
+  </xsl:if>
+</xsl:template>
+
+
+<!-- an entry of the field kinds table -->
+<xsl:template match="node" mode="fields">
+  <xsl:value-of select="'['"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name"/>
+  </xsl:call-template>
+  <xsl:value-of select="'] = &quot;'"/>
+  <xsl:apply-templates select="." mode="kinds"/>
+  <xsl:value-of select="'&quot;,'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+
+<!-- a line of the layout string: the node with the names and kinds of its
+     fields -->
+<xsl:template match="node" mode="layout">
+  <xsl:value-of select="concat( '&quot;', @name, '(')"/>
+  <xsl:for-each select="sons/son">
+    <xsl:choose>
+      <xsl:when test="@list = 'yes'">
+        <xsl:value-of select="concat( ' L:', @name)"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="concat( ' s:', @name)"/>
+      </xsl:otherwise>
+    </xsl:choose>
+  </xsl:for-each>
+  <xsl:for-each select="attributes/attribute">
+    <xsl:value-of select="' '"/>
+    <xsl:apply-templates select="." mode="kind"/>
+    <xsl:value-of select="concat( ':', @name, ':', type/@name)"/>
+  </xsl:for-each>
+  <xsl:for-each select="flags/flag">
+    <xsl:value-of select="concat( ' f:', @name)"/>
+  </xsl:for-each>
+  <xsl:value-of select="')&quot;'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+
+<!-- the case of Sons for a node -->
+<xsl:template match="node" mode="sons">
+  <xsl:if test="sons/son[not( @list = 'yes')]">
+    <xsl:value-of select="'case '"/>
+    <xsl:call-template name="name-to-nodeenum">
+      <xsl:with-param name="name" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="': '"/>
+    <xsl:for-each select="sons/son[not( @list = 'yes')]">
+      <xsl:value-of select="concat( 'sons[', position() - 1, '] = ')"/>
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node">arg_node</xsl:with-param>
+        <xsl:with-param name="nodetype" select="../../@name"/>
+        <xsl:with-param name="field" select="@name"/>
+      </xsl:call-template>
+      <xsl:value-of select="'; '"/>
+    </xsl:for-each>
+    <xsl:value-of select="concat( 'return( ', count( sons/son[not( @list = 'yes')]), ');')"/>
+    <xsl:call-template name="newline"/>
+  </xsl:if>
+</xsl:template>
+
+
+<!-- the case of Items for a node with a list son -->
+<xsl:template match="node" mode="items">
+  <xsl:value-of select="'case '"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name"/>
+  </xsl:call-template>
+  <xsl:value-of select="': *count = '"/>
+  <xsl:call-template name="node-access">
+    <xsl:with-param name="node">arg_node</xsl:with-param>
+    <xsl:with-param name="nodetype" select="@name"/>
+    <xsl:with-param name="field">Count</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="'; return( &amp;'"/>
+  <xsl:call-template name="son-slot">
+    <xsl:with-param name="node">arg_node</xsl:with-param>
+    <xsl:with-param name="nodetype" select="@name"/>
+    <xsl:with-param name="field" select="sons/son[@list = 'yes']/@name"/>
+    <xsl:with-param name="index">0</xsl:with-param>
+  </xsl:call-template>
+  <xsl:value-of select="');'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+
+<!-- the case of PutFields for a node -->
+<xsl:template match="node" mode="put">
+  <xsl:value-of select="'case '"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name"/>
+  </xsl:call-template>
+  <xsl:value-of select="': '"/>
+  <xsl:for-each select="sons/son">
+    <xsl:if test="@list = 'yes'">
+      <xsl:value-of select="'{ int i; *pos++ = (uint32_t) '"/>
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node">arg_node</xsl:with-param>
+        <xsl:with-param name="nodetype" select="../../@name"/>
+        <xsl:with-param name="field">Count</xsl:with-param>
+      </xsl:call-template>
+      <xsl:value-of select="'; for (i = 0; i &lt; '"/>
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node">arg_node</xsl:with-param>
+        <xsl:with-param name="nodetype" select="../../@name"/>
+        <xsl:with-param name="field">Count</xsl:with-param>
+      </xsl:call-template>
+      <xsl:value-of select="'; i++) { '"/>
+    </xsl:if>
+    <xsl:value-of select="'*pos++ = PutSon( writer, '"/>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+      <xsl:with-param name="index">
+        <xsl:if test="@list = 'yes'">i</xsl:if>
+      </xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="'); '"/>
+    <xsl:if test="@list = 'yes'">
+      <xsl:value-of select="'} } '"/>
+    </xsl:if>
+  </xsl:for-each>
+  <xsl:for-each select="attributes/attribute">
+    <xsl:variable name="kind">
+      <xsl:apply-templates select="." mode="kind"/>
+    </xsl:variable>
+    <xsl:choose>
+      <xsl:when test="$kind = 'l'">
+        <xsl:value-of select="'*pos++ = PutLink( writer, '"/>
+      </xsl:when>
+      <xsl:when test="$kind = 'w'">
+        <xsl:value-of select="concat( '{ ', key( &quot;types&quot;, ./type/@name)/@ctype, ' value = ')"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="'*pos++ = PutString( writer, '"/>
+      </xsl:otherwise>
+    </xsl:choose>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:choose>
+      <xsl:when test="$kind = 'w'">
+        <xsl:value-of select="'; memcpy( pos++, &amp;value, sizeof( value)); } '"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="'); '"/>
+      </xsl:otherwise>
+    </xsl:choose>
+  </xsl:for-each>
+  <xsl:for-each select="flags/flag">
+    <xsl:value-of select="'if ('"/>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="concat( ') { *pos |= 1u &lt;&lt; ', position() - 1, '; } ')"/>
+  </xsl:for-each>
+  <xsl:if test="flags/flag">
+    <xsl:value-of select="'pos++; '"/>
+  </xsl:if>
+  <xsl:value-of select="'break;'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+
+<!-- the case of MakeNode for a node: its make function with the initial
+     values of the attributes and no sons, as COPY makes its nodes -->
+<xsl:template match="node" mode="make">
+  <xsl:value-of select="'case '"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name"/>
+  </xsl:call-template>
+  <xsl:value-of select="': return( TBmake'"/>
+  <xsl:call-template name="make-name"/>
+  <xsl:value-of select="'( '"/>
+  <xsl:for-each select="attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;] | sons/son[not(@default)][not(@list = 'yes')]">
+    <xsl:sort select="count( parent::attributes)" order="descending"/>
+    <xsl:if test="position() != 1">
+      <xsl:value-of select="', '"/>
+    </xsl:if>
+    <xsl:choose>
+      <xsl:when test="self::attribute">
+        <xsl:value-of select="key( &quot;types&quot;, ./type/@name)/@init"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="'NULL'"/>
+      </xsl:otherwise>
+    </xsl:choose>
+  </xsl:for-each>
+  <xsl:value-of select="'));'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+
+<!-- the case of GetFields for a node -->
+<xsl:template match="node" mode="get">
+  <xsl:value-of select="'case '"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name"/>
+  </xsl:call-template>
+  <xsl:value-of select="': '"/>
+  <xsl:for-each select="sons/son">
+    <xsl:if test="@list = 'yes'">
+      <xsl:value-of select="'{ int i; TBresize( arg_node, (int) *pos++); for (i = 0; i &lt; '"/>
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node">arg_node</xsl:with-param>
+        <xsl:with-param name="nodetype" select="../../@name"/>
+        <xsl:with-param name="field">Count</xsl:with-param>
+      </xsl:call-template>
+      <xsl:value-of select="'; i++) { '"/>
+    </xsl:if>
+    <xsl:call-template name="node-set">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+      <xsl:with-param name="index">
+        <xsl:if test="@list = 'yes'">i</xsl:if>
+      </xsl:with-param>
+      <xsl:with-param name="value">GetNode( reader, *pos++)</xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="'; '"/>
+    <xsl:if test="@list = 'yes'">
+      <xsl:value-of select="'} } '"/>
+    </xsl:if>
+  </xsl:for-each>
+  <xsl:for-each select="attributes/attribute">
+    <xsl:variable name="kind">
+      <xsl:apply-templates select="." mode="kind"/>
+    </xsl:variable>
+    <xsl:if test="$kind = 'w'">
+      <xsl:value-of select="concat( '{ ', key( &quot;types&quot;, ./type/@name)/@ctype, ' value; memcpy( &amp;value, pos++, sizeof( value)); ')"/>
+    </xsl:if>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:choose>
+      <xsl:when test="$kind = 'l'">
+        <xsl:value-of select="' = GetNode( reader, *pos++); '"/>
+      </xsl:when>
+      <xsl:when test="$kind = 'n'">
+        <xsl:value-of select="' = GetName( reader, *pos++); '"/>
+      </xsl:when>
+      <xsl:when test="$kind = 't'">
+        <xsl:value-of select="' = GetString( reader, *pos++); '"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="' = value; } '"/>
+      </xsl:otherwise>
+    </xsl:choose>
+  </xsl:for-each>
+  <xsl:for-each select="flags/flag">
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="../../@name"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="concat( ' = ((*pos &gt;&gt; ', position() - 1, ') &amp; 1u) != 0; ')"/>
+  </xsl:for-each>
+  <xsl:value-of select="'break;'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+
+<!-- the case of Share for a hashcons node: its share function with the
+     fields of the private node, and the attributes that are no parameters
+     of it -->
+<xsl:template match="node" mode="share">
+  <xsl:variable name="node" select="@name"/>
+  <xsl:value-of select="'case '"/>
+  <xsl:call-template name="name-to-nodeenum">
+    <xsl:with-param name="name" select="@name"/>
+  </xsl:call-template>
+  <xsl:value-of select="': result = TBshare'"/>
+  <xsl:call-template name="make-name"/>
+  <xsl:value-of select="'( '"/>
+  <xsl:for-each select="attributes/attribute[type/targets/target/phases/all][not(@default)][type/targets/target/@mandatory = &quot;yes&quot;] | sons/son[not(@default)][not(@list = 'yes')]">
+    <xsl:sort select="count( parent::attributes)" order="descending"/>
+    <xsl:if test="position() != 1">
+      <xsl:value-of select="', '"/>
+    </xsl:if>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="$node"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+  </xsl:for-each>
+  <xsl:value-of select="'); '"/>
+  <xsl:for-each select="sons/son[@default]">
+    <xsl:call-template name="node-set">
+      <xsl:with-param name="node">result</xsl:with-param>
+      <xsl:with-param name="nodetype" select="$node"/>
+      <xsl:with-param name="field" select="@name"/>
+      <xsl:with-param name="value">
+        <xsl:call-template name="node-access">
+          <xsl:with-param name="node">arg_node</xsl:with-param>
+          <xsl:with-param name="nodetype" select="$node"/>
+          <xsl:with-param name="field" select="@name"/>
+        </xsl:call-template>
+      </xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="'; '"/>
+  </xsl:for-each>
+  <xsl:for-each select="attributes/attribute[not( type/targets/target/phases/all) or @default or not( type/targets/target/@mandatory = &quot;yes&quot;)]">
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">result</xsl:with-param>
+      <xsl:with-param name="nodetype" select="$node"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="' = '"/>
+    <xsl:call-template name="node-access">
+      <xsl:with-param name="node">arg_node</xsl:with-param>
+      <xsl:with-param name="nodetype" select="$node"/>
+      <xsl:with-param name="field" select="@name"/>
+    </xsl:call-template>
+    <xsl:value-of select="'; '"/>
+  </xsl:for-each>
+  <xsl:value-of select="'break;'"/>
+  <xsl:call-template name="newline"/>
+</xsl:template>
+
+</xsl:stylesheet>
@@ -60,6 +60,7 @@
   <xsl:import href="common-key-tables.xsl"/>
   <xsl:import href="common-travfun.xsl"/>
   <xsl:import href="common-name-to-nodeenum.xsl"/>
+  <xsl:import href="common-layout.xsl"/>
 
   <xsl:output method="text" indent="no"/>
   <xsl:strip-space elements="*"/>
@@ -82,10 +83,67 @@
 #define _SAC_SONS_H_
 
 #include "types.h"
+    </xsl:text>
+    <xsl:choose>
+      <xsl:when test="$layout = 'handles'">
+        <xsl:text>
+#include &lt;stddef.h&gt;
+#include &lt;stdint.h&gt;
+
+/*
+ * A son is stored as the distance of its node from TBhandleBase in units
+ * of 8 bytes, all nodes being allocated 8-byte aligned in one region of
+ * address space starting there, see node_basic.c. Handle 0 is NULL.
+ */
+typedef uint32_t sonslot;
+
+extern char *TBhandleBase;
+
+static inline node *TBnode( sonslot handle)
+{
+  return( handle == 0 ? NULL : (node *) (TBhandleBase + ((size_t) handle &lt;&lt; 3)));
+}
+
+static inline sonslot TBhandle( node *arg_node)
+{
+  return( arg_node == NULL ? 0 : (sonslot) (((char *) arg_node - TBhandleBase) &gt;&gt; 3));
+}
+        </xsl:text>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:text>
+/*
+ * A son is stored as the pointer to its node.
+ */
+typedef node *sonslot;
+
+#define TBnode( handle) (handle)
+#define TBhandle( arg_node) (arg_node)
+        </xsl:text>
+      </xsl:otherwise>
+    </xsl:choose>
+    <xsl:text>
+/*
+ * The items of a list son, in an array taken from the node arena that
+ * doubles when it is full.
+ */
+struct LISTSON {
+  sonslot *items;
+  int count;
+  int size;
+};
 
     </xsl:text>
-    <xsl:apply-templates select="/definition/syntaxtree" mode="generate-sons-structs"/>
-    <xsl:apply-templates select="/definition/syntaxtree" mode="generate-sons-union"/>
+    <xsl:choose>
+      <xsl:when test="$layout != 'split'">
+        <xsl:apply-templates select="/definition/syntaxtree" mode="generate-packed-structs"/>
+        <xsl:apply-templates select="/definition/syntaxtree" mode="generate-packed-union"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:apply-templates select="/definition/syntaxtree" mode="generate-sons-structs"/>
+        <xsl:apply-templates select="/definition/syntaxtree" mode="generate-sons-union"/>
+      </xsl:otherwise>
+    </xsl:choose>
     <xsl:text>
 #endif /* _SAC_SONS_H_ */
     </xsl:text>
@@ -116,7 +174,13 @@
   </xsl:template>
 
   <xsl:template match="son" mode="generate-sons-structs">
-    <xsl:value-of select="'node * '"/>
+    <xsl:value-of select="'sonslot '"/>
+    <xsl:value-of select="@name"/>
+    <xsl:value-of select="'; '"/>
+  </xsl:template>
+
+  <xsl:template match="son[@list = 'yes']" mode="generate-sons-structs">
+    <xsl:value-of select="'struct LISTSON '"/>
     <xsl:value-of select="@name"/>
     <xsl:value-of select="'; '"/>
   </xsl:template>
@@ -136,6 +200,112 @@
     </xsl:apply-templates>
     <xsl:value-of select="'} ; '"/>
   </xsl:template>
+
+  <!-- in the packed layout, the node structures themselves are united, so
+       that a node ends right after the structure of its type -->
+  <xsl:template match="syntaxtree" mode="generate-packed-union">
+    <xsl:text>
+/*****************************************************************************
+ * This union holds the packed structure of every node type inline. Its
+ * members are called N_nodename.
+ ****************************************************************************/
+    </xsl:text>
+    <xsl:value-of select="'struct SONUNION { union { '"/>
+    <xsl:text>
+    </xsl:text>
+    <xsl:apply-templates select="node" mode="generate-packed-union">
+      <xsl:sort select="@name"/>
+    </xsl:apply-templates>
+    <xsl:value-of select="'} ; } ; '"/>
+  </xsl:template>
+
+  <xsl:template match="node" mode="generate-packed-union">
+    <xsl:value-of select="'struct NODE_N_'"/>
+    <xsl:call-template name="uppercase" >
+      <xsl:with-param name="string">
+        <xsl:value-of select="@name" />
+      </xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="' '" />
+    <xsl:call-template name="name-to-nodeenum">
+      <xsl:with-param name="name">
+        <xsl:value-of select="@name" />
+      </xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="'; '"/>
+  </xsl:template>
+
+  <xsl:template match="syntaxtree" mode="generate-packed-structs">
+     <xsl:text>
+/******************************************************************************
+ * For each node a packed structure of its sons, attributes and flags is
+ * defined, named NODE_&lt;nodename&gt;. Pointers come first and bitfields
+ * last, to keep padding small; with handles, the sons follow the pointer
+ * attributes.
+ *****************************************************************************/
+     </xsl:text>
+     <xsl:apply-templates select="node" mode="generate-packed-structs">
+       <xsl:sort select="@name"/>
+     </xsl:apply-templates>
+  </xsl:template>
+
+  <xsl:template match="node" mode="generate-packed-structs">
+    <xsl:value-of select="'struct NODE_N_'"/>
+    <xsl:call-template name="uppercase" >
+      <xsl:with-param name="string">
+        <xsl:value-of select="@name" />
+      </xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="' { '"/>
+    <xsl:if test="$layout != 'handles'">
+      <xsl:apply-templates select="sons/son" mode="generate-sons-structs"/>
+    </xsl:if>
+    <xsl:apply-templates select="attributes/attribute[contains( key( &quot;types&quot;, ./type/@name)/@ctype, '*')]" mode="generate-packed-structs"/>
+    <xsl:if test="$layout = 'handles'">
+      <xsl:apply-templates select="sons/son" mode="generate-sons-structs"/>
+    </xsl:if>
+    <xsl:apply-templates select="attributes/attribute[not( contains( key( &quot;types&quot;, ./type/@name)/@ctype, '*'))][not( key( &quot;types&quot;, ./type/@name)/@bits)]" mode="generate-packed-structs"/>
+    <xsl:apply-templates select="attributes/attribute[key( &quot;types&quot;, ./type/@name)/@bits]" mode="generate-packed-structs"/>
+    <xsl:apply-templates select="flags/flag" mode="generate-packed-structs"/>
+    <xsl:value-of select="' } ;'"/>
+  </xsl:template>
+
+  <xsl:template match="attribute" mode="generate-packed-structs">
+    <xsl:value-of select="key( &quot;types&quot;, ./type/@name)/@ctype"/>
+    <xsl:value-of select="' '"/>
+    <xsl:value-of select="@name"/>
+    <xsl:if test="key( &quot;arraytypes&quot;, ./type/@name)">
+      <xsl:value-of select="'['" />
+      <xsl:value-of select="key( &quot;types&quot;, ./type/@name)/@size"/>
+      <xsl:value-of select="']'" />
+    </xsl:if>
+    <xsl:value-of select="'; '"/>
+  </xsl:template>
+
+  <!-- bitfields are unsigned, as a signed one bit field cannot hold TRUE;
+       all enumerations stored this way are non-negative. One bit fields
+       are _Bool, so that any non-zero value is stored as TRUE rather than
+       cut to its lowest bit -->
+  <xsl:template match="attribute[key( &quot;types&quot;, ./type/@name)/@bits]" mode="generate-packed-structs">
+    <xsl:choose>
+      <xsl:when test="key( &quot;types&quot;, ./type/@name)/@bits = 1">
+        <xsl:value-of select="'_Bool '"/>
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="'unsigned int '"/>
+      </xsl:otherwise>
+    </xsl:choose>
+    <xsl:value-of select="@name"/>
+    <xsl:value-of select="' : '"/>
+    <xsl:value-of select="key( &quot;types&quot;, ./type/@name)/@bits"/>
+    <xsl:value-of select="'; '"/>
+  </xsl:template>
+
+  <xsl:template match="flag" mode="generate-packed-structs">
+    <xsl:value-of select="'unsigned int '" />
+    <xsl:value-of select="@name" />
+    <xsl:value-of select="' : 1;'" />
+  </xsl:template>
  
   <!-- generate an entry for each node within the union -->
   <xsl:template match="node" mode="generate-sons-union">
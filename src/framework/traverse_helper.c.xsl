@@ -80,12 +80,23 @@
     </xsl:call-template>
     <xsl:text>
 
+#include &lt;string.h&gt;
+
 #include "traverse_helper.h"
+#include "traverse_tables.h"
 #include "dbug.h"
+#include "memory.h"
 #include "tree_basic.h"
 #include "traverse.h"
 
-#define TRAV( son, info)    if (son != NULL) { son = TRAVdo( son, info); }
+#define WALK_FRAMES 64
+
+typedef struct WALKFRAME {
+  node *node;
+  int son;
+  int sons;
+  bool removed;
+} walkframe;
 
 node *TRAVnone(node *arg_node, info *arg_info)
 {
@@ -101,7 +112,14 @@ node *TRAVerror(node *arg_node, info *arg_info)
 
 node *TRAVsons(node *arg_node, info *arg_info)
 { 
-  switch (NODE_TYPE( arg_node)) {
+  </xsl:text>
+  <xsl:if test="/definition/syntaxtree/node/sons/son[@list = 'yes']">
+    <xsl:text>int i;
+  node *item;
+
+  </xsl:text>
+  </xsl:if>
+  <xsl:text>switch (NODE_TYPE( arg_node)) {
   </xsl:text>
   <xsl:apply-templates select="/definition/syntaxtree" mode="travsons" />
   <xsl:text>
@@ -114,6 +132,109 @@ node *TRAVsons(node *arg_node, info *arg_info)
   return( arg_node);
 }
 
+static sonslot *SonRef( int no, node *parent)
+{
+  sonslot *result = NULL;
+
+  switch (NODE_TYPE( parent)) {
+  </xsl:text>
+  <xsl:apply-templates select="/definition/syntaxtree" mode="sonref" />
+  <xsl:text>
+    default:
+      DBUG_ASSERT( (FALSE),
+         "Illegal nodetype found!" );
+      break;
+  }
+
+  return( result);
+}
+
+/*
+ * Does for the default nodes of a traversal what TRAVsons does, without
+ * recursing: a son that the traversal would only hand to its default again
+ * is put on an explicit stack instead of being passed to TRAVdo, so long
+ * lists and deeply nested expressions take no C stack between two user
+ * functions. The nodes are visited in the same order as by TRAVsons. The
+ * items of a list son are sons as well; a user function may append to the
+ * list, so the son is looked up again after it returns.
+ */
+node *TRAVwalk( node *arg_node, info *arg_info, trav_t trav)
+{
+  walkframe local[WALK_FRAMES];
+  walkframe *stack = local;
+  walkframe *grown;
+  int size = WALK_FRAMES;
+  int top = 0;
+  travfun_p walk;
+  node *son;
+  node *result;
+  int no;
+
+  DBUG_ENTER("TRAVwalk");
+
+  if ((pretable[trav] != NULL) || (posttable[trav] != NULL)) {
+    DBUG_RETURN( TRAVsons( arg_node, arg_info));
+  }
+
+  walk = travtables[trav][NODE_TYPE( arg_node)];
+  stack[0].node = arg_node;
+  stack[0].son = 0;
+  stack[0].sons = TRAVnumSons( arg_node);
+  stack[0].removed = FALSE;
+
+  while (top >= 0) {
+    if (stack[top].son == stack[top].sons) {
+      stack[top].sons = TRAVnumSons( stack[top].node);
+      if (stack[top].son == stack[top].sons) {
+        if (stack[top].removed) {
+          TBcompact( stack[top].node);
+        }
+        top--;
+        continue;
+      }
+    }
+
+    no = stack[top].son++;
+    son = TBnode( *SonRef( no, stack[top].node));
+
+    if (son == NULL) {
+      continue;
+    }
+
+    if (travtables[trav][NODE_TYPE( son)] != walk) {
+      result = TRAVdo( son, arg_info);
+      *SonRef( no, stack[top].node) = TBhandle( result);
+      stack[top].removed = stack[top].removed || (result == NULL);
+      continue;
+    }
+
+    if (top + 1 == size) {
+      grown = MEMmalloc( 2 * size * sizeof( walkframe));
+      memcpy( grown, stack, size * sizeof( walkframe));
+      if (stack != local) {
+        stack = MEMfree( stack);
+      }
+      stack = grown;
+      size *= 2;
+    }
+
+    top++;
+    stack[top].node = son;
+    stack[top].son = 0;
+    stack[top].sons = TRAVnumSons( son);
+    stack[top].removed = FALSE;
+  }
+
+  if (stack != local) {
+    stack = MEMfree( stack);
+  }
+
+  DBUG_RETURN( arg_node);
+}
+  </xsl:text>
+  <xsl:apply-templates select="/definition/phases//traversal[@default = 'sons' or travsons/node]" mode="travwalk" />
+  <xsl:text>
+
 int TRAVnumSons( node *node)
 {
   int result = 0;
@@ -165,21 +286,54 @@ node *TRAVgetSon( int no, node *parent)
   </xsl:template>
 
   <xsl:template match="sons/son" mode="travsons" >
-    <xsl:value-of select="'TRAV( '" />
+    <xsl:variable name="son">
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node" select="'arg_node'" />
+        <xsl:with-param name="nodetype" select="../../@name" />
+        <xsl:with-param name="field" select="@name" />
+      </xsl:call-template>
+    </xsl:variable>
+    <xsl:value-of select="concat( 'if (', $son, ' != NULL) { ')" />
+    <xsl:call-template name="node-set">
+      <xsl:with-param name="node" select="'arg_node'" />
+      <xsl:with-param name="nodetype" select="../../@name" />
+      <xsl:with-param name="field" select="@name" />
+      <xsl:with-param name="value" select="concat( 'TRAVdo( ', $son, ', arg_info)')" />
+    </xsl:call-template>
+    <xsl:value-of select="'; } '" />
+  </xsl:template>
+
+  <!-- the items of a list son are traversed in order; those returned as
+       NULL are removed afterwards -->
+  <xsl:template match="sons/son[@list = 'yes']" mode="travsons" >
+    <xsl:variable name="item">
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node" select="'arg_node'" />
+        <xsl:with-param name="nodetype" select="../../@name" />
+        <xsl:with-param name="field" select="@name" />
+        <xsl:with-param name="index" select="'i'" />
+      </xsl:call-template>
+    </xsl:variable>
+    <xsl:value-of select="'for (i = 0; i &lt; '" />
     <xsl:call-template name="node-access">
-      <xsl:with-param name="node">
-        <xsl:value-of select="'arg_node'" />
-      </xsl:with-param>
-      <xsl:with-param name="nodetype">
-        <xsl:value-of select="../../@name" />
-      </xsl:with-param>
-      <xsl:with-param name="field">
-        <xsl:value-of select="@name" />
-      </xsl:with-param>
+      <xsl:with-param name="node" select="'arg_node'" />
+      <xsl:with-param name="nodetype" select="../../@name" />
+      <xsl:with-param name="field" select="'Count'" />
     </xsl:call-template>
-    <xsl:value-of select="', arg_info);'" />
+    <xsl:value-of select="concat( '; i++) { item = ', $item, '; ')" />
+    <xsl:value-of select="'if (item != NULL) { '" />
+    <xsl:call-template name="node-set">
+      <xsl:with-param name="node" select="'arg_node'" />
+      <xsl:with-param name="nodetype" select="../../@name" />
+      <xsl:with-param name="field" select="@name" />
+      <xsl:with-param name="index" select="'i'" />
+      <xsl:with-param name="value" select="'TRAVdo( item, arg_info)'" />
+    </xsl:call-template>
+    <xsl:value-of select="'; } } '" />
+    <xsl:value-of select="'TBcompact( arg_node);'" />
   </xsl:template>
 
+  <!-- a list son counts as many sons as it has items -->
   <xsl:template match="node" mode="travnumsons" >
     <xsl:value-of select="'case '" />
     <xsl:call-template name="name-to-nodeenum">
@@ -187,19 +341,118 @@ node *TRAVgetSon( int no, node *parent)
     </xsl:call-template>
     <xsl:value-of select="': '" />
     <xsl:value-of select="'result = '" />
-    <xsl:value-of select="count( sons/son)" />
+    <xsl:value-of select="count( sons/son[not( @list = 'yes')])" />
+    <xsl:if test="sons/son[@list = 'yes']">
+      <xsl:value-of select="' + '" />
+      <xsl:call-template name="node-access">
+        <xsl:with-param name="node" select="'node'" />
+        <xsl:with-param name="nodetype" select="@name" />
+        <xsl:with-param name="field" select="'Count'" />
+      </xsl:call-template>
+    </xsl:if>
     <xsl:value-of select="';'" />
     <xsl:value-of select="'break;'" />
   </xsl:template>
 
+  <!-- the default case of TRAVgetSon and SonRef: the items of a list son
+       follow the other sons. SonRef takes the address of their slots -->
+  <xsl:template name="list-default">
+    <xsl:param name="parent" />
+    <xsl:param name="slot" select="false()" />
+    <xsl:variable name="list" select="sons/son[@list = 'yes']" />
+    <xsl:variable name="item">
+      <xsl:value-of select="'no'" />
+      <xsl:if test="$list/preceding-sibling::son">
+        <xsl:value-of select="concat( ' - ', count( $list/preceding-sibling::son))" />
+      </xsl:if>
+    </xsl:variable>
+    <xsl:choose>
+      <xsl:when test="$list">
+        <xsl:value-of select="concat( 'default: DBUG_ASSERT( ((', $item, ' &lt; ')" />
+        <xsl:call-template name="node-access">
+          <xsl:with-param name="node" select="$parent" />
+          <xsl:with-param name="nodetype" select="@name" />
+          <xsl:with-param name="field" select="'Count'" />
+        </xsl:call-template>
+        <xsl:value-of select="')), &quot;index out of range!&quot;); '" />
+        <xsl:value-of select="'result = '" />
+        <xsl:choose>
+          <xsl:when test="$slot">
+            <xsl:value-of select="'&amp;'" />
+            <xsl:call-template name="son-slot">
+              <xsl:with-param name="node" select="$parent" />
+              <xsl:with-param name="nodetype" select="@name" />
+              <xsl:with-param name="field" select="$list/@name" />
+              <xsl:with-param name="index" select="$item" />
+            </xsl:call-template>
+          </xsl:when>
+          <xsl:otherwise>
+            <xsl:call-template name="node-access">
+              <xsl:with-param name="node" select="$parent" />
+              <xsl:with-param name="nodetype" select="@name" />
+              <xsl:with-param name="field" select="$list/@name" />
+              <xsl:with-param name="index" select="$item" />
+            </xsl:call-template>
+          </xsl:otherwise>
+        </xsl:choose>
+        <xsl:value-of select="'; break; } break;'" />
+      </xsl:when>
+      <xsl:otherwise>
+        <xsl:value-of select="'default: DBUG_ASSERT( (FALSE), &quot;index out of range!&quot;); break; } break;'" />
+      </xsl:otherwise>
+    </xsl:choose>
+  </xsl:template>
+
   <xsl:template match="node" mode="travgetson" >
     <xsl:value-of select="'case '" />
     <xsl:call-template name="name-to-nodeenum">
       <xsl:with-param name="name" select="@name" />
     </xsl:call-template>
     <xsl:value-of select="': switch (no) { '" />
-    <xsl:apply-templates select="sons/son" mode="travgetson" />
-    <xsl:value-of select="'default: DBUG_ASSERT( (FALSE), &quot;index out of range!&quot;); break; } break;'" />
+    <xsl:apply-templates select="sons/son[not( @list = 'yes')]" mode="travgetson" />
+    <xsl:call-template name="list-default">
+      <xsl:with-param name="parent" select="'parent'" />
+    </xsl:call-template>
+  </xsl:template>
+
+  <xsl:template match="node" mode="sonref" >
+    <xsl:value-of select="'case '" />
+    <xsl:call-template name="name-to-nodeenum">
+      <xsl:with-param name="name" select="@name" />
+    </xsl:call-template>
+    <xsl:value-of select="': switch (no) { '" />
+    <xsl:apply-templates select="sons/son[not( @list = 'yes')]" mode="sonref" />
+    <xsl:call-template name="list-default">
+      <xsl:with-param name="parent" select="'parent'" />
+      <xsl:with-param name="slot" select="true()" />
+    </xsl:call-template>
+  </xsl:template>
+
+  <xsl:template match="son" mode="sonref" >
+    <xsl:value-of select="'case '" />
+    <xsl:value-of select="position()-1" />
+    <xsl:value-of select="': result = &amp;'" />
+    <xsl:call-template name="son-slot">
+      <xsl:with-param name="node" select="'parent'" />
+      <xsl:with-param name="nodetype" select="../../@name" />
+      <xsl:with-param name="field" select="@name" />
+    </xsl:call-template>
+    <xsl:value-of select="'; break;'" />
+  </xsl:template>
+
+  <xsl:template match="traversal" mode="travwalk" >
+    <xsl:text>
+node *TRAVwalk</xsl:text>
+    <xsl:value-of select="@id" />
+    <xsl:text>(node *arg_node, info *arg_info)
+{
+  return( TRAVwalk( arg_node, arg_info, TR_</xsl:text>
+    <xsl:call-template name="lowercase">
+      <xsl:with-param name="string" select="@id" />
+    </xsl:call-template>
+    <xsl:text>));
+}
+</xsl:text>
   </xsl:template>
 
   <xsl:template match="son" mode="travgetson" >
@@ -63,12 +63,14 @@
   <xsl:import href="common-key-tables.xsl"/>
   <xsl:import href="common-travfun.xsl"/>
   <xsl:import href="common-name-to-nodeenum.xsl"/>
+  <xsl:import href="common-node-access.xsl"/>
 
   <xsl:output method="text" indent="no"/>
   <xsl:strip-space elements="*"/>
 
   <!-- starting template -->
   <xsl:template match="/">
+    <xsl:apply-templates select="/definition/phases//traversal[fuse]" mode="check-fusion" />
     <xsl:call-template name="travfun-file">
       <xsl:with-param name="file">
         <xsl:value-of select="'traverse_tables.c'"/>
@@ -83,6 +85,7 @@
     <xsl:text>
 #include "traverse_tables.h"
 #include "traverse_helper.h"
+#include "tree_basic.h"
     </xsl:text>
       <xsl:apply-templates select="/definition/phases//traversal" mode="include" />
     <xsl:text>
@@ -119,6 +122,170 @@ const char *travnames[ </xsl:text><xsl:value-of select="count(/definition/phases
 };
 
     </xsl:text>
+    <xsl:apply-templates select="/definition/phases//traversal[@dispatch = 'direct'][not( @prefun) and not( @postfun)]" mode="dispatch" />
+  </xsl:template>
+
+  <!--
+    For a traversal with dispatch="direct", a dispatcher that switches on
+    the node type and calls the traversal functions directly, without the
+    traversal stack and the tables. The sons of a node of the sons default
+    are walked inline; the last son is walked by the loop instead of a
+    call, so that lists take no C stack. The items of a list son are
+    dispatched one after the other, and those returned as NULL removed.
+  -->
+  <xsl:template match="traversal" mode="dispatch">
+    <xsl:variable name="phase" select="@id" />
+    <xsl:variable name="dispatcher" select="concat( 'TRAVdispatch', @id)" />
+    <xsl:text>
+node *</xsl:text>
+    <xsl:value-of select="$dispatcher" />
+    <xsl:text>( node *arg_node, info *arg_info)
+{
+  sonslot result = TBhandle( arg_node);
+  sonslot *link = &amp;result;
+  node *current;
+    </xsl:text>
+    <xsl:if test="/definition/syntaxtree/node/sons/son[@list = 'yes']">
+      <xsl:text>node *item;
+  int i;
+    </xsl:text>
+    </xsl:if>
+    <xsl:text>
+  while ((current = TBnode( *link)) != NULL) {
+    switch (NODE_TYPE( current)) {
+    </xsl:text>
+    <xsl:for-each select="/definition/syntaxtree/node">
+      <xsl:variable name="pass">
+        <xsl:call-template name="fused-pass">
+          <xsl:with-param name="phase" select="$phase" />
+          <xsl:with-param name="node" select="@name" />
+        </xsl:call-template>
+      </xsl:variable>
+      <xsl:variable name="style">
+        <xsl:choose>
+          <xsl:when test="$pass != ''">user</xsl:when>
+          <xsl:when test="key( &quot;traversals&quot;, $phase)/travuser/node/@name = ./@name">user</xsl:when>
+          <xsl:when test="key( &quot;traversals&quot;, $phase)/travsons/node/@name = ./@name">sons</xsl:when>
+          <xsl:when test="key( &quot;traversals&quot;, $phase)/travnone/node/@name = ./@name">none</xsl:when>
+          <xsl:when test="key( &quot;traversals&quot;, $phase)/traverror/node/@name = ./@name">error</xsl:when>
+          <xsl:otherwise>
+            <xsl:value-of select="key( &quot;traversals&quot;, $phase)/@default" />
+          </xsl:otherwise>
+        </xsl:choose>
+      </xsl:variable>
+      <xsl:value-of select="'case '" />
+      <xsl:call-template name="name-to-nodeenum">
+        <xsl:with-param name="name" select="@name" />
+      </xsl:call-template>
+      <xsl:value-of select="': '" />
+      <xsl:choose>
+        <xsl:when test="$style = 'sons' and sons/son[@list = 'yes']">
+          <xsl:for-each select="sons/son[not( @list = 'yes')]">
+            <xsl:call-template name="dispatch-son">
+              <xsl:with-param name="dispatcher" select="$dispatcher" />
+            </xsl:call-template>
+          </xsl:for-each>
+          <xsl:variable name="item">
+            <xsl:call-template name="node-access">
+              <xsl:with-param name="node" select="'current'" />
+              <xsl:with-param name="nodetype" select="@name" />
+              <xsl:with-param name="field" select="sons/son[@list = 'yes']/@name" />
+              <xsl:with-param name="index" select="'i'" />
+            </xsl:call-template>
+          </xsl:variable>
+          <xsl:value-of select="'for (i = 0; i &lt; '" />
+          <xsl:call-template name="node-access">
+            <xsl:with-param name="node" select="'current'" />
+            <xsl:with-param name="nodetype" select="@name" />
+            <xsl:with-param name="field" select="'Count'" />
+          </xsl:call-template>
+          <xsl:value-of select="concat( '; i++) { item = ', $dispatcher, '( ', $item, ', arg_info); ')" />
+          <xsl:call-template name="node-set">
+            <xsl:with-param name="node" select="'current'" />
+            <xsl:with-param name="nodetype" select="@name" />
+            <xsl:with-param name="field" select="sons/son[@list = 'yes']/@name" />
+            <xsl:with-param name="index" select="'i'" />
+            <xsl:with-param name="value" select="'item'" />
+          </xsl:call-template>
+          <xsl:value-of select="'; } '" />
+          <xsl:value-of select="'TBcompact( current); break;'" />
+        </xsl:when>
+        <xsl:when test="$style = 'sons'">
+          <xsl:for-each select="sons/son[position() != last()]">
+            <xsl:call-template name="dispatch-son">
+              <xsl:with-param name="dispatcher" select="$dispatcher" />
+            </xsl:call-template>
+          </xsl:for-each>
+          <xsl:choose>
+            <xsl:when test="sons/son">
+              <xsl:value-of select="'link = &amp;'" />
+              <xsl:call-template name="son-slot">
+                <xsl:with-param name="node" select="'current'" />
+                <xsl:with-param name="nodetype" select="@name" />
+                <xsl:with-param name="field" select="sons/son[last()]/@name" />
+              </xsl:call-template>
+              <xsl:value-of select="'; continue;'" />
+            </xsl:when>
+            <xsl:otherwise>
+              <xsl:value-of select="'break;'" />
+            </xsl:otherwise>
+          </xsl:choose>
+        </xsl:when>
+        <xsl:when test="$style = 'none'">
+          <xsl:value-of select="'break;'" />
+        </xsl:when>
+        <xsl:otherwise>
+          <xsl:value-of select="'*link = TBhandle( '" />
+          <xsl:call-template name="travtab-to-travname">
+            <xsl:with-param name="phase">
+              <xsl:choose>
+                <xsl:when test="$pass != ''">
+                  <xsl:value-of select="$pass" />
+                </xsl:when>
+                <xsl:otherwise>
+                  <xsl:value-of select="$phase" />
+                </xsl:otherwise>
+              </xsl:choose>
+            </xsl:with-param>
+            <xsl:with-param name="node" select="@name" />
+            <xsl:with-param name="style" select="$style" />
+          </xsl:call-template>
+          <xsl:value-of select="'( current, arg_info)); break;'" />
+        </xsl:otherwise>
+      </xsl:choose>
+      <xsl:call-template name="newline" />
+    </xsl:for-each>
+    <xsl:text>
+    default:
+      *link = TBhandle( TRAVerror( current, arg_info));
+      break;
+    }
+    break;
+  }
+
+  return( TBnode( result));
+}
+    </xsl:text>
+  </xsl:template>
+
+  <!-- a son that the dispatcher walks inline -->
+  <xsl:template name="dispatch-son">
+    <xsl:param name="dispatcher" />
+    <xsl:call-template name="node-set">
+      <xsl:with-param name="node" select="'current'" />
+      <xsl:with-param name="nodetype" select="../../@name" />
+      <xsl:with-param name="field" select="@name" />
+      <xsl:with-param name="value">
+        <xsl:value-of select="concat( $dispatcher, '( ')" />
+        <xsl:call-template name="node-access">
+          <xsl:with-param name="node" select="'current'" />
+          <xsl:with-param name="nodetype" select="../../@name" />
+          <xsl:with-param name="field" select="@name" />
+        </xsl:call-template>
+        <xsl:value-of select="', arg_info)'" />
+      </xsl:with-param>
+    </xsl:call-template>
+    <xsl:value-of select="'; '" />
   </xsl:template>
 
   <xsl:template match="node" mode="errortraversal" >
@@ -152,9 +319,22 @@ const char *travnames[ </xsl:text><xsl:value-of select="count(/definition/phases
     </xsl:if>
     <xsl:value-of select="', { &amp;TRAVerror'" />
     <xsl:for-each select="/definition/syntaxtree/node" >
+      <xsl:variable name="pass">
+        <xsl:call-template name="fused-pass">
+          <xsl:with-param name="phase" select="$phase" />
+          <xsl:with-param name="node" select="@name" />
+        </xsl:call-template>
+      </xsl:variable>
       <xsl:value-of select="', '" />
       <xsl:value-of select="'&amp;'" />
       <xsl:choose>
+        <xsl:when test="$pass != ''" >
+          <xsl:call-template name="travtab-to-travname">
+            <xsl:with-param name="phase" select="$pass" />
+            <xsl:with-param name="node" select="@name" />
+            <xsl:with-param name="style">user</xsl:with-param>
+          </xsl:call-template>
+        </xsl:when>
         <xsl:when test="key( &quot;traversals&quot;, $phase)/travuser/node/@name = ./@name" >
           <xsl:call-template name="travtab-to-travname">
             <xsl:with-param name="phase">
@@ -230,6 +410,58 @@ const char *travnames[ </xsl:text><xsl:value-of select="count(/definition/phases
     </xsl:if>
   </xsl:template>
 
+  <!--
+    The traversal of a fused traversal that has the node in travuser, or
+    nothing if there is none.
+  -->
+  <xsl:template name="fused-pass">
+    <xsl:param name="phase" />
+    <xsl:param name="node" />
+    <xsl:for-each select="key( &quot;traversals&quot;, $phase)/fuse/pass">
+      <xsl:if test="key( &quot;traversals&quot;, @id)/travuser/node/@name = $node">
+        <xsl:value-of select="@id" />
+      </xsl:if>
+    </xsl:for-each>
+  </xsl:template>
+
+  <!--
+    Rejects a fused traversal whose traversals cannot share a walk, see
+    the description of fuse in ast.xml.
+  -->
+  <xsl:template match="traversal" mode="check-fusion">
+    <xsl:variable name="fused" select="." />
+    <xsl:for-each select="fuse/pass">
+      <xsl:variable name="p" select="key( &quot;traversals&quot;, @id)" />
+      <xsl:variable name="p-reads" select="$p/travuser/node/@name | $p/reads/node/@name | key( &quot;nodesets&quot;, $p/reads/set/@name)/target/node/@name" />
+      <xsl:variable name="p-writes" select="$p/writes/node/@name | key( &quot;nodesets&quot;, $p/writes/set/@name)/target/node/@name" />
+      <xsl:if test="not( $p)">
+        <xsl:message terminate="yes">
+          <xsl:value-of select="concat( 'fused traversal ', $fused/@id, ': unknown traversal ', @id)" />
+        </xsl:message>
+      </xsl:if>
+      <xsl:if test="$p/fuse or not( $p/writes) or $p/@prefun or $p/@postfun or $p/@default != $fused/@default">
+        <xsl:message terminate="yes">
+          <xsl:value-of select="concat( 'fused traversal ', $fused/@id, ': ', @id, ' must have writes, default ', $fused/@default, ' and no fuse, prefun or postfun')" />
+        </xsl:message>
+      </xsl:if>
+      <xsl:for-each select="following-sibling::pass">
+        <xsl:variable name="q" select="key( &quot;traversals&quot;, @id)" />
+        <xsl:variable name="q-reads" select="$q/travuser/node/@name | $q/reads/node/@name | key( &quot;nodesets&quot;, $q/reads/set/@name)/target/node/@name" />
+        <xsl:variable name="q-writes" select="$q/writes/node/@name | key( &quot;nodesets&quot;, $q/writes/set/@name)/target/node/@name" />
+        <xsl:if test="$p/travuser/node/@name = $q/travuser/node/@name">
+          <xsl:message terminate="yes">
+            <xsl:value-of select="concat( 'fused traversal ', $fused/@id, ': ', $p/@id, ' and ', $q/@id, ' both have user functions for the same node')" />
+          </xsl:message>
+        </xsl:if>
+        <xsl:if test="$p-writes = $q-reads or $q-writes = $p-reads">
+          <xsl:message terminate="yes">
+            <xsl:value-of select="concat( 'fused traversal ', $fused/@id, ': ', $p/@id, ' and ', $q/@id, ' write nodes that the other reads')" />
+          </xsl:message>
+        </xsl:if>
+      </xsl:for-each>
+    </xsl:for-each>
+  </xsl:template>
+
   <xsl:template name="travtab-to-travname">
     <xsl:param name="phase" />
     <xsl:param name="node" />
@@ -248,7 +480,8 @@ const char *travnames[ </xsl:text><xsl:value-of select="count(/definition/phases
         </xsl:call-template>
       </xsl:when>
       <xsl:when test="$style = &quot;sons&quot;">
-        <xsl:value-of select="'TRAVsons'" />
+        <xsl:value-of select="'TRAVwalk'" />
+        <xsl:value-of select="$phase" />
       </xsl:when>
       <xsl:when test="$style = &quot;none&quot;">
         <xsl:value-of select="'TRAVnone'" />
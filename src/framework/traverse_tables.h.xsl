@@ -94,8 +94,28 @@ extern preposttable_t pretable;
 extern preposttable_t posttable;
 extern const char *travnames[</xsl:text><xsl:value-of select="count(//traversal)+1" /><xsl:text>];
 
+extern node *TRAVwalk( node *arg_node, info *arg_info, trav_t trav);
+</xsl:text>
+    <xsl:apply-templates select="/definition/phases//traversal[@default = 'sons' or travsons/node]" mode="travwalk" />
+    <xsl:apply-templates select="/definition/phases//traversal[@dispatch = 'direct'][not( @prefun) and not( @postfun)]" mode="dispatch" />
+    <xsl:text>
+
 #endif /* _SAC_TRAVERSE_TABLES_H_ */
     </xsl:text>
   </xsl:template>
 
+  <xsl:template match="traversal" mode="dispatch" >
+    <xsl:value-of select="'extern node *TRAVdispatch'" />
+    <xsl:value-of select="@id" />
+    <xsl:text>( node *arg_node, info *arg_info);
+</xsl:text>
+  </xsl:template>
+
+  <xsl:template match="traversal" mode="travwalk" >
+    <xsl:value-of select="'extern node *TRAVwalk'" />
+    <xsl:value-of select="@id" />
+    <xsl:text>( node *arg_node, info *arg_info);
+</xsl:text>
+  </xsl:template>
+
 </xsl:stylesheet>
@@ -1,6 +1,9 @@
 #include "types.h"
 #include "helpers.h"
 
+#include "tree_basic.h"
+#include "memory.h"
+
 char *HprintType(type type)
 {
     switch (type)
@@ -83,3 +86,95 @@ bool HisBooleanOperator(binop operator)
     operator== BO_and ||
     operator== BO_or;
 }
+
+/*
+ * Returns the type of an expression, as stored in the expression by type
+ * checking and kept by the passes that rewrite expressions.
+ */
+type HexprType(node *expr)
+{
+    switch (NODE_TYPE(expr))
+    {
+    case N_binop:
+        return BINOP_TYPE(expr);
+    case N_monop:
+        return MONOP_TYPE(expr);
+    case N_funcall:
+        return FUNCALL_TYPE(expr);
+    case N_cast:
+        return CAST_TYPE(expr);
+    case N_var:
+        return VAR_TYPE(expr);
+    case N_num:
+        return NUM_TYPE(expr);
+    case N_float:
+        return FLOAT_TYPE(expr);
+    case N_bool:
+        return BOOL_TYPE(expr);
+    case N_arrexpr:
+        return ARREXPR_TYPE(expr);
+    case N_ternary:
+        return TERNARY_TYPE(expr);
+    default:
+        return T_unknown;
+    }
+}
+
+/*
+ * Collects the chain of BinOps that are nested through their left operand,
+ * as in a + b + c + d, so that such chains can be handled in a loop instead
+ * of one recursive call per operator. The result starts with binop itself
+ * and ends with the innermost BinOp, whose left operand is not a BinOp.
+ * The caller frees the result.
+ */
+node **HbinopSpine(node *binop, int *count)
+{
+    node **spine;
+    node *current;
+    int i;
+
+    *count = 0;
+    for (current = binop; current != NULL && NODE_TYPE(current) == N_binop; current = BINOP_LEFT(current))
+    {
+        (*count)++;
+    }
+
+    spine = MEMmalloc(*count * sizeof(node *));
+    current = binop;
+    for (i = 0; i < *count; i++)
+    {
+        spine[i] = current;
+        current = BINOP_LEFT(current);
+    }
+
+    return spine;
+}
+
+/*
+ * Collects the chain of Ternaries that are nested through their condition,
+ * as produced for a || b || c by the boolean disjunction phase. The result
+ * starts with ternary itself and ends with the innermost Ternary.
+ * The caller frees the result.
+ */
+node **HternarySpine(node *ternary, int *count)
+{
+    node **spine;
+    node *current;
+    int i;
+
+    *count = 0;
+    for (current = ternary; current != NULL && NODE_TYPE(current) == N_ternary; current = TERNARY_COND(current))
+    {
+        (*count)++;
+    }
+
+    spine = MEMmalloc(*count * sizeof(node *));
+    current = ternary;
+    for (i = 0; i < *count; i++)
+    {
+        spine[i] = current;
+        current = TERNARY_COND(current);
+    }
+
+    return spine;
+}
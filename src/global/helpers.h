@@ -9,4 +9,9 @@ extern char *HprintMonOp(monop op);
 
 extern bool HisBooleanOperator(binop operator);
 
+extern type HexprType(node *expr);
+
+extern node **HbinopSpine(node *binop, int *count);
+extern node **HternarySpine(node *ternary, int *count);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "location.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dbug.h"
+#include "globals.h"
+#include "memory.h"
+
+/*
+ * Source positions. Nodes and tokens only carry the byte offset of where
+ * they start in the scanned text, in NODE_OFFSET and global.line respectively.
+ * The offsets are turned into line and column numbers when a diagnostic
+ * needs them, with a table of line start offsets that is built on the
+ * first such request by reading the input file once more.
+ *
+ * When the preprocessor rewrites the input, it provides the table itself,
+ * along with the line in the original file of every line it produced.
+ */
+
+static int *line_starts = NULL;
+static int *line_numbers = NULL;
+static int line_count = 0;
+
+/**
+ * Builds the line table from the input file. If the file cannot be read,
+ * the table has a single line, so every offset maps to line 1.
+ */
+static void BuildLineTable(void)
+{
+    FILE *file;
+    char *text = NULL;
+    char *p;
+    char *end;
+    long size = 0;
+    int capacity = 1;
+
+    DBUG_ENTER("BuildLineTable");
+
+    file = global.infile != NULL ? fopen(global.infile, "rb") : NULL;
+    if (file != NULL)
+    {
+        if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0
+            && fseek(file, 0, SEEK_SET) == 0)
+        {
+            text = MEMmalloc(size);
+            size = (long)fread(text, 1, size, file);
+        }
+        fclose(file);
+    }
+
+    end = text + size;
+    for (p = text; p != NULL && (p = memchr(p, '\n', end - p)) != NULL; p++)
+    {
+        capacity++;
+    }
+
+    line_starts = MEMmalloc(capacity * sizeof(int));
+    line_starts[0] = 0;
+    line_count = 1;
+    for (p = text; p != NULL && (p = memchr(p, '\n', end - p)) != NULL; p++)
+    {
+        line_starts[line_count++] = (int)(p + 1 - text);
+    }
+
+    if (text != NULL)
+    {
+        MEMfree(text);
+    }
+
+    DBUG_VOID_RETURN;
+}
+
+/**
+ * Sets the line table for text that is not the input file as is.
+ *
+ * @param starts Offsets of the starts of the lines, in increasing order
+ *               and starting with 0. Taken over by this module.
+ * @param lines Line number to report for each line. Taken over by this
+ *              module.
+ * @param count Number of lines, at least 1.
+ */
+void LOCsetLineMap(int *starts, int *lines, int count)
+{
+    DBUG_ENTER("LOCsetLineMap");
+
+    if (line_starts != NULL)
+    {
+        MEMfree(line_starts);
+    }
+    if (line_numbers != NULL)
+    {
+        MEMfree(line_numbers);
+    }
+
+    line_starts = starts;
+    line_numbers = lines;
+    line_count = count;
+
+    DBUG_VOID_RETURN;
+}
+
+/**
+ * Gets the line table, building it from the input file if there is none.
+ *
+ * @param starts Set to the offsets of the starts of the lines.
+ * @param lines Set to the line number to report for each line, or NULL if
+ *              line i is reported as line i + 1.
+ * @return Number of lines.
+ */
+int LOCgetLineMap(const int **starts, const int **lines)
+{
+    DBUG_ENTER("LOCgetLineMap");
+
+    if (line_starts == NULL)
+    {
+        BuildLineTable();
+    }
+
+    *starts = line_starts;
+    *lines = line_numbers;
+
+    DBUG_RETURN(line_count);
+}
+
+/**
+ * @return Index of the line that contains offset in the line table.
+ */
+static int LineIndex(int offset)
+{
+    int lo = 0;
+    int hi;
+    int mid;
+
+    if (line_starts == NULL)
+    {
+        BuildLineTable();
+    }
+
+    hi = line_count - 1;
+    while (lo < hi)
+    {
+        mid = (lo + hi + 1) / 2;
+        if (line_starts[mid] <= offset)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+
+    return lo;
+}
+
+/**
+ * @param offset Byte offset in the scanned text.
+ * @return Line number of offset, counting from 1.
+ */
+int LOCline(int offset)
+{
+    int index = LineIndex(offset);
+
+    return line_numbers != NULL ? line_numbers[index] : index + 1;
+}
+
+/**
+ * @param offset Byte offset in the scanned text.
+ * @return Column number of offset, counting from 1.
+ */
+int LOCcol(int offset)
+{
+    int index = LineIndex(offset);
+
+    return offset - line_starts[index] + 1;
+}
@@ -0,0 +1,11 @@
+#ifndef _LOCATION_H_
+#define _LOCATION_H_
+
+#include "types.h"
+
+extern void LOCsetLineMap(int *starts, int *lines, int count);
+extern int LOCgetLineMap(const int **starts, const int **lines);
+extern int LOCline(int offset);
+extern int LOCcol(int offset);
+
+#endif
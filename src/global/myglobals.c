@@ -4,6 +4,8 @@
 
 myglobals_t myglobal;
 
+__thread const int *parse_offset = NULL;
+
 
 /*
  * Initialize my global variables from myglobals.mac
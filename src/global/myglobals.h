@@ -13,6 +13,12 @@ typedef struct MYGLOBALS_T {
 
 extern myglobals_t myglobal;
 
+/*
+ * Source offset new nodes are tagged with while a parser runs on this
+ * thread. NULL otherwise, in which case global.line is used.
+ */
+extern __thread const int *parse_offset;
+
 extern void MYGLBinitializeGlobals( void);
 
 #endif /* _CIVCC_MYGLOBALS_H_ */
@@ -50,4 +50,13 @@ typedef enum
     I_unknown
 } pseudo_instruct;
 
+/*
+ * A run of characters in the scanner's source buffer
+ */
+typedef struct
+{
+    int offset;
+    int length;
+} slice;
+
 #endif /* _CIVCC_MYTYPES_H_ */
@@ -0,0 +1,166 @@
+#include "names.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#include "dbug.h"
+#include "memory.h"
+
+/*
+ * Interned names. Every identifier is stored exactly once for the whole
+ * compilation, so two names are equal if and only if their pointers are.
+ * Names are never freed; the attributes that hold them are of the literal
+ * Name type in ast.xml, so neither FREE nor COPY touches them.
+ *
+ * The table is shared by the parser threads, so it is guarded by a mutex.
+ */
+
+#define CHUNK_SIZE 65536
+#define INITIAL_SLOTS 1024
+
+typedef struct CHUNK
+{
+    struct CHUNK *next;
+    int used;
+    char data[CHUNK_SIZE];
+} chunk;
+
+static chunk *chunks = NULL;
+
+static char **slots = NULL;
+static unsigned int slot_count = 0;
+static unsigned int name_count = 0;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * FNV-1a hash of the first length characters of name.
+ */
+static unsigned int Hash(const char *name, int length)
+{
+    unsigned int hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * Copies a name into chunk storage. Names too long for a chunk get a
+ * chunk of their own.
+ */
+static char *Store(const char *name, int length)
+{
+    chunk *target = chunks;
+    char *result;
+
+    if (target == NULL || target->used + length + 1 > CHUNK_SIZE)
+    {
+        int data_size = length + 1 > CHUNK_SIZE ? length + 1 : CHUNK_SIZE;
+
+        target = MEMmalloc(sizeof(chunk) - CHUNK_SIZE + data_size);
+        target->used = 0;
+        target->next = chunks;
+        chunks = target;
+    }
+
+    result = target->data + target->used;
+    memcpy(result, name, length);
+    result[length] = '\0';
+    target->used += length + 1;
+
+    return result;
+}
+
+/**
+ * Doubles the slot array and reinserts all interned names.
+ */
+static void Grow(void)
+{
+    char **old_slots = slots;
+    unsigned int old_count = slot_count;
+    unsigned int i;
+
+    slot_count = old_count == 0 ? INITIAL_SLOTS : old_count * 2;
+    slots = MEMmalloc(slot_count * sizeof(char *));
+    memset(slots, 0, slot_count * sizeof(char *));
+
+    for (i = 0; i < old_count; i++)
+    {
+        if (old_slots[i] != NULL)
+        {
+            unsigned int slot = Hash(old_slots[i], strlen(old_slots[i])) & (slot_count - 1);
+
+            while (slots[slot] != NULL)
+            {
+                slot = (slot + 1) & (slot_count - 1);
+            }
+            slots[slot] = old_slots[i];
+        }
+    }
+
+    if (old_slots != NULL)
+    {
+        MEMfree(old_slots);
+    }
+}
+
+/**
+ * Returns the unique interned copy of the first length characters of name.
+ *
+ * @param name Characters of the name, not necessarily zero terminated.
+ * @param length Number of characters.
+ * @return The interned name.
+ */
+char *NAMEinternN(const char *name, int length)
+{
+    unsigned int slot;
+    char *result;
+
+    DBUG_ENTER("NAMEinternN");
+
+    pthread_mutex_lock(&lock);
+
+    if (2 * (name_count + 1) > slot_count)
+    {
+        Grow();
+    }
+
+    slot = Hash(name, length) & (slot_count - 1);
+
+    while (slots[slot] != NULL)
+    {
+        if (strncmp(slots[slot], name, length) == 0 && slots[slot][length] == '\0')
+        {
+            break;
+        }
+        slot = (slot + 1) & (slot_count - 1);
+    }
+
+    if (slots[slot] == NULL)
+    {
+        slots[slot] = Store(name, length);
+        name_count++;
+    }
+    result = slots[slot];
+
+    pthread_mutex_unlock(&lock);
+
+    DBUG_RETURN(result);
+}
+
+/**
+ * Returns the unique interned copy of name.
+ *
+ * @param name Zero terminated name.
+ * @return The interned name.
+ */
+char *NAMEintern(const char *name)
+{
+    return NAMEinternN(name, strlen(name));
+}
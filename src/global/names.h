@@ -0,0 +1,9 @@
+#ifndef _NAMES_H_
+#define _NAMES_H_
+
+#include "types.h"
+
+extern char *NAMEintern(const char *name);
+extern char *NAMEinternN(const char *name, int length);
+
+#endif
@@ -1,12 +1,31 @@
 #include "main_args.h"
 #include "dbug.h"
 #include "str.h"
+#include "memory.h"
 #include "globals.h"
+#include "myglobals.h"
 #include "usage.h"
 #include "ctinfo.h"
 #include "phase_options.h"
 
 
+/*
+ * Appends a directory to the colon separated #include search path.
+ */
+static void AddIncludeDir( char *dir)
+{
+  char *path;
+
+  if (myglobal.include_path == NULL) {
+    myglobal.include_path = STRcpy( dir);
+  }
+  else {
+    path = STRcatn( 3, myglobal.include_path, ":", dir);
+    MEMfree( myglobal.include_path);
+    myglobal.include_path = path;
+  }
+}
+
 void OPTcheckOptions( int argc, char **argv)
 {
   DBUG_ENTER("OPTcheckOptions");
@@ -23,6 +42,44 @@ void OPTcheckOptions( int argc, char **argv)
 
   ARGS_FLAG( "tc", global.treecheck = TRUE);
 
+  ARGS_FLAG( "mmap", myglobal.mmap_input = TRUE);
+
+  ARGS_FLAG( "lexer=fast", myglobal.fast_lexer = TRUE);
+
+  ARGS_FLAG( "lexer=flex", myglobal.fast_lexer = FALSE);
+
+  ARGS_FLAG( "dump-tokens", myglobal.dump_tokens = TRUE);
+
+  ARGS_FLAG( "parser=rd", myglobal.rd_parser = TRUE);
+
+  ARGS_FLAG( "parser=bison", myglobal.rd_parser = FALSE);
+
+  ARGS_OPTION( "parse-threads", ARG_RANGE(myglobal.parse_threads, 1, 256));
+
+  ARGS_FLAG( "cpp=builtin", myglobal.builtin_cpp = TRUE);
+
+  ARGS_FLAG( "cpp=none", myglobal.builtin_cpp = FALSE);
+
+  ARGS_OPTION( "I", AddIncludeDir( ARG));
+
+  ARGS_OPTION( "emit-pch", myglobal.pch_output = STRcpy( ARG));
+
+  ARGS_FLAG( "pch=use", myglobal.use_pch = TRUE);
+
+  ARGS_FLAG( "pch=none", myglobal.use_pch = FALSE);
+
+  ARGS_FLAG( "dispatch=direct", myglobal.direct_dispatch = TRUE);
+
+  ARGS_FLAG( "dispatch=table", myglobal.direct_dispatch = FALSE);
+
+  ARGS_FLAG( "traversals=fused", myglobal.fuse_traversals = TRUE);
+
+  ARGS_FLAG( "traversals=separate", myglobal.fuse_traversals = FALSE);
+
+  ARGS_FLAG( "hashcons", myglobal.hashcons = TRUE);
+
+  ARGS_OPTION( "snapshot-after", myglobal.snapshot_after = STRcpy( ARG));
+
   ARGS_OPTION( "#", DBUG_PUSH( STRcpy( ARG)));
 
   ARGS_ARGUMENT( global.infile = STRcpy( ARG); );
@@ -35,5 +92,11 @@ void OPTcheckOptions( int argc, char **argv)
     CTIabort( "No input file given.");
   }
 
+  /* the flex scanner and the bison parser keep their state in globals */
+  if (myglobal.parse_threads > 1
+      && !(myglobal.fast_lexer && myglobal.rd_parser)) {
+    CTIabort( "-parse-threads requires -lexer=fast and -parser=rd.");
+  }
+
   DBUG_VOID_RETURN;
 }
@@ -0,0 +1,305 @@
+/*
+ * Snapshots of the syntax tree, to restart the compiler part way.
+ *
+ * Compiling with -snapshot-after <subphase> -o <file> runs the subphases up
+ * to and including <subphase>, writes the syntax tree with its symbol
+ * tables to <file> and stops. Compiling <file> instead of a program skips
+ * reading and parsing, maps the snapshot, and continues with the subphase
+ * after the one it was taken after.
+ *
+ * The tree itself is encoded by the generated functions of snapshot_node.c,
+ * whose images hold no pointers, so a mapped file only needs the nodes to
+ * be made and their fields set. Images are tied to the node layout of
+ * ast.xml they were made with.
+ *
+ * Snapshots can be taken from context analysis on: the precompiled headers
+ * the preprocessor asks for are loaded by context analysis and are not part
+ * of the tree before.
+ *
+ * File layout, in host byte order:
+ *
+ *   header   magic "CSNP", version, name of the subphase the snapshot was
+ *            taken after, number of lines, whether the line table has line
+ *            numbers, size of the image
+ *   lines    the line table of location.c: offsets of the line starts,
+ *            then, if it has them, the line numbers to report
+ *   image    as made by SNPencodeTree
+ */
+
+#include "snapshot.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ctinfo.h"
+#include "dbug.h"
+#include "globals.h"
+#include "location.h"
+#include "memory.h"
+#include "myglobals.h"
+#include "snapshot_node.h"
+
+#define SNAP_VERSION 3
+
+typedef struct SNAP_HEADER
+{
+    char magic[4];
+    int32_t version;
+    char subphase[16];
+    int32_t line_count;
+    int32_t has_line_numbers;
+    int64_t image_size;
+} snap_header;
+
+/* The names of all subphases, in the order they run. */
+static const char *const subphases[] = {
+#define SUBPHASEname(name) #name,
+#include "phase.mac"
+#undef SUBPHASEname
+};
+
+#define SUBPHASE_COUNT ((int)(sizeof(subphases) / sizeof(subphases[0])))
+
+/*
+ * Positions in subphases of the subphase the input was taken after, and
+ * of the one to take a snapshot after; -1 if there is none. Set on the
+ * first call of SNAPrun.
+ */
+static bool initialised = FALSE;
+static int taken_after = -1;
+static int take_after = -1;
+
+static int Position(const char *subphase)
+{
+    int i;
+
+    for (i = 0; i < SUBPHASE_COUNT; i++)
+    {
+        if (strcmp(subphases[i], subphase) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Reads the file header of a snapshot.
+ *
+ * @return TRUE if the file starts with a header of the current version.
+ */
+static bool ReadHeader(const char *path, snap_header *hdr)
+{
+    FILE *file;
+    bool ok;
+
+    file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return FALSE;
+    }
+
+    ok = fread(hdr, sizeof(snap_header), 1, file) == 1 && memcmp(hdr->magic, "CSNP", 4) == 0
+         && hdr->version == SNAP_VERSION && memchr(hdr->subphase, '\0', sizeof(hdr->subphase)) != NULL;
+    fclose(file);
+
+    return ok;
+}
+
+static void Initialise(void)
+{
+    snap_header hdr;
+
+    if (global.infile != NULL && ReadHeader(global.infile, &hdr))
+    {
+        taken_after = Position(hdr.subphase);
+        if (taken_after < 0)
+        {
+            CTIabort("%s was taken after subphase '%s', which this compiler does not have",
+                     global.infile, hdr.subphase);
+        }
+    }
+
+    if (myglobal.snapshot_after != NULL)
+    {
+        take_after = Position(myglobal.snapshot_after);
+        if (take_after < Position("ca") || take_after >= Position("snp") || take_after <= taken_after)
+        {
+            CTIabort("Cannot take a snapshot after subphase '%s'", myglobal.snapshot_after);
+        }
+    }
+
+    initialised = TRUE;
+}
+
+/**
+ * Decides whether a subphase runs: only those after the one a snapshot
+ * given as input was taken after, and only those up to the one to take a
+ * snapshot after. Loading and writing a snapshot run when there is one to
+ * load or write.
+ */
+bool SNAPrun(const char *subphase)
+{
+    int position;
+
+    DBUG_ENTER("SNAPrun");
+
+    if (!initialised)
+    {
+        Initialise();
+    }
+
+    if (strcmp(subphase, "lds") == 0)
+    {
+        DBUG_RETURN(taken_after >= 0);
+    }
+
+    if (strcmp(subphase, "snp") == 0)
+    {
+        DBUG_RETURN(take_after >= 0);
+    }
+
+    position = Position(subphase);
+
+    DBUG_ASSERT(position >= 0, "SNAPrun called for an unknown subphase");
+
+    DBUG_RETURN(position > taken_after && (take_after < 0 || position <= take_after));
+}
+
+static void Corrupt(void)
+{
+    CTIabort("%s is corrupt or was made by a different build of the compiler", global.infile);
+}
+
+/**
+ * Loads the snapshot given as input file. The syntax tree is NULL, as the
+ * input was not parsed.
+ *
+ * @return The syntax tree of the snapshot.
+ */
+node *SNAPdoLoad(node *syntaxtree)
+{
+    snap_header hdr;
+    struct stat st;
+    const int *table;
+    int *starts;
+    int *lines = NULL;
+    void *base;
+    off_t table_size;
+    int fd;
+
+    DBUG_ENTER("SNAPdoLoad");
+
+    fd = open(global.infile, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        CTIabort("Cannot read snapshot %s", global.infile);
+    }
+
+    if (st.st_size < (off_t)sizeof(snap_header))
+    {
+        Corrupt();
+    }
+
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        CTIabort("Cannot read snapshot %s", global.infile);
+    }
+
+    memcpy(&hdr, base, sizeof(snap_header));
+    table = (const int *)((const char *)base + sizeof(snap_header));
+    table_size = hdr.line_count * (off_t)(hdr.has_line_numbers ? 2 : 1) * sizeof(int);
+
+    if (hdr.line_count < 1 || hdr.image_size < 0
+        || (off_t)sizeof(snap_header) + table_size + hdr.image_size != st.st_size)
+    {
+        Corrupt();
+    }
+
+    starts = MEMmalloc(hdr.line_count * sizeof(int));
+    memcpy(starts, table, hdr.line_count * sizeof(int));
+    if (hdr.has_line_numbers)
+    {
+        lines = MEMmalloc(hdr.line_count * sizeof(int));
+        memcpy(lines, table + hdr.line_count, hdr.line_count * sizeof(int));
+    }
+    LOCsetLineMap(starts, lines, hdr.line_count);
+
+    syntaxtree = SNPdecodeTree((const char *)table + table_size, hdr.image_size);
+
+    munmap(base, st.st_size);
+
+    if (syntaxtree == NULL)
+    {
+        Corrupt();
+    }
+
+    DBUG_RETURN(syntaxtree);
+}
+
+/**
+ * Writes the syntax tree to the output file and stops the compiler after
+ * this subphase, as -b does.
+ */
+node *SNAPdoWrite(node *syntaxtree)
+{
+    snap_header hdr;
+    const int *starts;
+    const int *lines;
+    void *image;
+    size_t image_size;
+    FILE *file;
+    bool ok;
+
+    DBUG_ENTER("SNAPdoWrite");
+
+    if (global.outfile == NULL)
+    {
+        CTIabort("A snapshot is only written to a file given with -o");
+    }
+
+    image = SNPencodeTree(syntaxtree, &image_size);
+
+    memset(&hdr, 0, sizeof(snap_header));
+    memcpy(hdr.magic, "CSNP", 4);
+    hdr.version = SNAP_VERSION;
+    strncpy(hdr.subphase, myglobal.snapshot_after, sizeof(hdr.subphase) - 1);
+    hdr.line_count = LOCgetLineMap(&starts, &lines);
+    hdr.has_line_numbers = lines != NULL;
+    hdr.image_size = (int64_t)image_size;
+
+    file = fopen(global.outfile, "wb");
+    if (file == NULL)
+    {
+        CTIabort("Cannot write snapshot %s", global.outfile);
+    }
+
+    ok = fwrite(&hdr, sizeof(snap_header), 1, file) == 1;
+    ok = ok && fwrite(starts, sizeof(int), hdr.line_count, file) == (size_t)hdr.line_count;
+    if (lines != NULL)
+    {
+        ok = ok && fwrite(lines, sizeof(int), hdr.line_count, file) == (size_t)hdr.line_count;
+    }
+    ok = ok && fwrite(image, 1, image_size, file) == image_size;
+    ok = fclose(file) == 0 && ok;
+
+    image = MEMfree(image);
+
+    if (!ok)
+    {
+        remove(global.outfile);
+        CTIabort("Cannot write snapshot %s", global.outfile);
+    }
+
+    global.break_after_subphase = global.compiler_subphase;
+
+    DBUG_RETURN(syntaxtree);
+}
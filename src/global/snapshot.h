@@ -0,0 +1,11 @@
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include "types.h"
+
+extern bool SNAPrun(const char *subphase);
+
+extern node *SNAPdoLoad(node *syntaxtree);
+extern node *SNAPdoWrite(node *syntaxtree);
+
+#endif
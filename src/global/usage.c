@@ -28,6 +28,40 @@ void PrintGeneralInfo(void)
           "    -o <filename>   Name of output file.\n\n"
           "    -v <n>          Verbosity level (default: %d).\n\n"
           "    -tc             Apply syntax tree consistency checks.\n\n"
+          "    -mmap           Map the input file into memory and scan it in place.\n\n"
+          "    -lexer=fast     Use the hand-written lexer instead of flex.\n"
+          "    -lexer=flex     Use the flex generated scanner (default).\n\n"
+          "    -dump-tokens    Print the token stream and stop.\n\n"
+          "    -parser=rd      Use the hand-written recursive-descent parser.\n"
+          "    -parser=bison   Use the bison generated parser (default).\n\n"
+          "    -parse-threads <n>\n"
+          "                    Parse large inputs on up to <n> threads (default: 1).\n"
+          "                    Requires -lexer=fast and -parser=rd.\n\n"
+          "    -cpp=builtin    Run the built-in preprocessor on the input.\n"
+          "    -cpp=none       Do not preprocess the input (default).\n\n"
+          "    -I <dir>        Search <dir> for files to #include.\n\n"
+          "    -emit-pch <filename>\n"
+          "                    Precompile a header of extern declarations into\n"
+          "                    <filename> and stop. Macros are not kept.\n\n"
+          "    -pch=use        Make the built-in preprocessor load <header>.pch\n"
+          "                    instead of an #included header when it is up\n"
+          "                    to date.\n"
+          "    -pch=none       Always read #included headers as text (default).\n\n"
+          "    -dispatch=direct\n"
+          "                    Call the functions of type checking through a\n"
+          "                    switch.\n"
+          "    -dispatch=table Call them through the traversal tables (default).\n\n"
+          "    -traversals=fused\n"
+          "                    Run the traversals fused in ast.xml in a single\n"
+          "                    walk of the syntax tree.\n"
+          "    -traversals=separate\n"
+          "                    Run them one after the other (default).\n\n"
+          "    -hashcons       Share equal expressions made by the compiler, such\n"
+          "                    as the loop conditions of for-loops.\n\n"
+          "    -snapshot-after <subphase>\n"
+          "                    Write the syntax tree to the file given with -o\n"
+          "                    after <subphase>, from ca to tbc, and stop.\n"
+          "                    Compiling the snapshot continues after <subphase>.\n\n"
           "    -#d,<id>        Print debugging information for tag <id>.\n"
           "                    Supported tags are:\n\n"
           
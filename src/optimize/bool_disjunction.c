@@ -1,32 +1,88 @@
 #include "bool_disjunction.h"
 
-#include "copy.h"
 #include "dbug.h"
 #include "free.h"
+#include "helpers.h"
+#include "memory.h"
 #include "traverse.h"
 #include "tree_basic.h"
 #include "types.h"
 
-extern node *BDCbinop(node *arg_node, info *arg_info)
+/*
+ * Makes a constant of the ternary that replaces a BinOp, typed as type
+ * checking would have typed it.
+ */
+static node *MakeBool(bool value)
 {
-    DBUG_ENTER("BDCbinop");
+    node *constant = TBmakeBool(value);
+
+    BOOL_TYPE(constant) = T_bool;
+
+    return constant;
+}
+
+/*
+ * Rewrites a BinOp whose operands have been transformed. The operands of
+ * || and && are moved into the Ternary that replaces the BinOp.
+ */
+static node *TransformBinop(node *arg_node, info *arg_info)
+{
+    node *result = arg_node;
+    node *left;
+    node *right;
+
+    DBUG_ENTER("TransformBinop");
 
-    BINOP_LEFT(arg_node) = TRAVopt(BINOP_LEFT(arg_node), arg_info);
-    BINOP_RIGHT(arg_node) = TRAVopt(BINOP_RIGHT(arg_node), arg_info);
+    L_BINOP_RIGHT(arg_node, TRAVopt(BINOP_RIGHT(arg_node), arg_info));
 
     if (BINOP_OP(arg_node) == BO_or)
     {
-        node *binop_right = COPYdoCopy(BINOP_RIGHT(arg_node));
-        DBUG_RETURN(TBmakeTernary(COPYdoCopy(BINOP_LEFT(arg_node)), TBmakeBool(TRUE), binop_right));
+        /* one after the other, as a shared operand can be both sons */
+        left = TBdetachSon(arg_node, BINOP_LEFT(arg_node));
+        right = TBdetachSon(arg_node, BINOP_RIGHT(arg_node));
+        result = TBmakeTernary(left, MakeBool(TRUE), right);
+    }
+    else if (BINOP_OP(arg_node) == BO_and)
+    {
+        left = TBdetachSon(arg_node, BINOP_LEFT(arg_node));
+        right = TBdetachSon(arg_node, BINOP_RIGHT(arg_node));
+        result = TBmakeTernary(left, right, MakeBool(FALSE));
     }
 
-    if (BINOP_OP(arg_node) == BO_and)
+    if (result != arg_node)
     {
-        node *binop_right = COPYdoCopy(BINOP_RIGHT(arg_node));
-        DBUG_RETURN(TBmakeTernary(COPYdoCopy(BINOP_LEFT(arg_node)), binop_right, TBmakeBool(FALSE)));
+        TERNARY_TYPE(result) = T_bool;
+        arg_node = FREEdoFreeTree(arg_node);
     }
 
-    DBUG_RETURN(arg_node);
+    DBUG_RETURN(result);
+}
+
+/*
+ * Chains nested through the left operand, such as a || b || ... || z, are
+ * transformed innermost first in a loop rather than by recursion.
+ */
+extern node *BDCbinop(node *arg_node, info *arg_info)
+{
+    node **spine;
+    node *result;
+    int count;
+
+    DBUG_ENTER("BDCbinop");
+
+    spine = HbinopSpine(arg_node, &count);
+
+    result = TRAVopt(BINOP_LEFT(spine[count - 1]), arg_info);
+
+    for (int i = count - 1; i >= 0; i--)
+    {
+        L_BINOP_LEFT(spine[i], result);
+        result = TransformBinop(spine[i], arg_info);
+    }
+
+    spine = MEMfree(spine);
+
+    DBUG_RETURN(result);
 }
 
 extern node *BDCdoBoolDisjunction(node *syntaxtree)
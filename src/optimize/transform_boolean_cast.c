@@ -1,142 +1,117 @@
 #include "transform_boolean_cast.h"
 
-#include "copy.h"
 #include "ctinfo.h"
 #include "dbug.h"
 #include "helpers.h"
 #include "free.h"
 #include "memory.h"
-#include "symbol_table.h"
 #include "types.h"
 #include "tree_basic.h"
 #include "traverse.h"
 
-struct INFO
+/*
+ * The nodes that replace a cast get the types that type checking would
+ * have given them.
+ */
+static node *MakeNum(int value)
 {
-  type type;
-};
+  node *constant = TBmakeNum(value);
 
-#define INFO_TYPE(n) ((n)->type)
+  NUM_TYPE(constant) = T_int;
 
-static info *MakeInfo(void)
-{
-  info *result;
-
-  DBUG_ENTER("MakeInfo");
-
-  result = (info *)MEMmalloc(sizeof(info));
-
-  INFO_TYPE(result) = T_unknown;
-
-  DBUG_RETURN(result);
+  return constant;
 }
 
-static info *FreeInfo(info *info)
+static node *MakeFloat(float value)
 {
-  DBUG_ENTER("FreeInfo");
+  node *constant = TBmakeFloat(value);
 
-  info = MEMfree(info);
+  FLOAT_TYPE(constant) = T_float;
 
-  DBUG_RETURN(info);
+  return constant;
 }
 
+/*
+ * Chains nested through the left operand are handled innermost first in a
+ * loop rather than by recursion.
+ */
 node *TBCbinop(node *arg_node, info *arg_info)
 {
+  int count;
+  node **spine;
+
   DBUG_ENTER("TBCbinop");
 
-  BINOP_LEFT(arg_node) = TRAVdo(BINOP_LEFT(arg_node), arg_info);
-  BINOP_RIGHT(arg_node) = TRAVdo(BINOP_RIGHT(arg_node), arg_info);
+  spine = HbinopSpine(arg_node, &count);
+
+  L_BINOP_LEFT(spine[count - 1], TRAVdo(BINOP_LEFT(spine[count - 1]), arg_info));
 
-  if (HisBooleanOperator(BINOP_OP(arg_node)))
+  for (int i = count - 1; i >= 0; i--)
   {
-    INFO_TYPE(arg_info) = T_bool;
+    L_BINOP_RIGHT(spine[i], TRAVdo(BINOP_RIGHT(spine[i]), arg_info));
   }
 
+  spine = MEMfree(spine);
+
   DBUG_RETURN(arg_node);
 }
 
+/*
+ * The cast expression is moved into the node that replaces the cast, and
+ * only the cast itself is freed.
+ */
 node *TBCcast(node *arg_node, info *arg_info)
 {
+  node *result = arg_node;
+
   DBUG_ENTER("TBCcast");
   
-  CAST_EXPR(arg_node) = TRAVdo(CAST_EXPR(arg_node), arg_info);
-  
+  L_CAST_EXPR(arg_node, TRAVdo(CAST_EXPR(arg_node), arg_info));
+
+  type expr_type = HexprType(CAST_EXPR(arg_node));
+
   if (CAST_TYPE(arg_node) == T_bool)
   {
-    node *cast_expression = COPYdoCopy(CAST_EXPR(arg_node));
-    FREEdoFreeTree(arg_node);
-
-    if (INFO_TYPE(arg_info) == T_int)
+    if (expr_type == T_int)
     {
-      arg_node = TBmakeBinop(BO_ne, cast_expression, TBmakeNum(FALSE));
+      result = TBmakeBinop(BO_ne, TBdetachSon(arg_node, CAST_EXPR(arg_node)), MakeNum(FALSE));
+      BINOP_TYPE(result) = T_bool;
     }
-    else if (INFO_TYPE(arg_info) == T_float)
+    else if (expr_type == T_float)
     {
-      arg_node = TBmakeBinop(BO_ne, cast_expression, TBmakeFloat(0.0));
+      result = TBmakeBinop(BO_ne, TBdetachSon(arg_node, CAST_EXPR(arg_node)), MakeFloat(0.0));
+      BINOP_TYPE(result) = T_bool;
     }
   }
-  else if (INFO_TYPE(arg_info) == T_bool)
+  else if (expr_type == T_bool)
   {
-    node *cast_expression = COPYdoCopy(CAST_EXPR(arg_node));
-    
     if (CAST_TYPE(arg_node) == T_int)
     {
-      FREEdoFreeTree(arg_node);
-      arg_node = TBmakeTernary(cast_expression, TBmakeNum(TRUE), TBmakeNum(FALSE));
+      result = TBmakeTernary(TBdetachSon(arg_node, CAST_EXPR(arg_node)), MakeNum(TRUE), MakeNum(FALSE));
+      TERNARY_TYPE(result) = T_int;
     }
     else if (CAST_TYPE(arg_node) == T_float)
     {
-      FREEdoFreeTree(arg_node);
-      arg_node = TBmakeTernary(cast_expression, TBmakeFloat(1.0), TBmakeFloat(0.0));
+      result = TBmakeTernary(TBdetachSon(arg_node, CAST_EXPR(arg_node)), MakeFloat(1.0), MakeFloat(0.0));
+      TERNARY_TYPE(result) = T_float;
     }
   }
 
-  DBUG_RETURN(arg_node);
-}
-
-node *TBCvar(node *arg_node, info *arg_info)
-{
-  DBUG_ENTER("TBCvar");
-
-  node *node = STfindInParents(VAR_SYMBOLTABLE(arg_node), VAR_NAME(arg_node));
-
-  INFO_TYPE(arg_info) = SYMBOLTABLEENTRY_TYPE(node);
-
-  DBUG_RETURN(arg_node);
-}
-
-node *TBCnum(node *arg_node, info *arg_info)
-{
-  DBUG_ENTER("TBCint");
-  INFO_TYPE(arg_info) = T_int;
-  DBUG_RETURN(arg_node);
-}
-
-node *TBCfloat(node *arg_node, info *arg_info)
-{
-  DBUG_ENTER("TBCfloat");
-  INFO_TYPE(arg_info) = T_float;
-  DBUG_RETURN(arg_node);
-}
+  if (result != arg_node)
+  {
+    arg_node = FREEdoFreeTree(arg_node);
+  }
 
-node *TBCbool(node *arg_node, info *arg_info)
-{
-  DBUG_ENTER("TBCbool");
-  INFO_TYPE(arg_info) = T_bool;
-  DBUG_RETURN(arg_node);
+  DBUG_RETURN(result);
 }
 
 node *TBCtransformBooleanCast(node *syntaxtree)
 {
   DBUG_ENTER("TBCtransformBooleanCast");
 
-  info *info = MakeInfo();
-
   TRAVpush(TR_tbc);
-  syntaxtree = TRAVdo(syntaxtree, info);
+  syntaxtree = TRAVdo(syntaxtree, NULL);
   TRAVpop();
 
-  FreeInfo(info);
-
   DBUG_RETURN(syntaxtree);
 }
@@ -65,8 +65,10 @@ node *PRTstmts(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTstmts");
 
-  STMTS_STMT(arg_node) = TRAVdo(STMTS_STMT(arg_node), arg_info);
-  STMTS_NEXT(arg_node) = TRAVopt(STMTS_NEXT(arg_node), arg_info);
+  for (int i = 0; i < STMTS_COUNT(arg_node); i++)
+  {
+    L_STMTS_STMT(arg_node, i, TRAVdo(STMTS_STMT(arg_node, i), arg_info));
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -77,11 +79,11 @@ node *PRTassign(node *arg_node, info *arg_info)
 
   if (ASSIGN_LET(arg_node))
   {
-    ASSIGN_LET(arg_node) = TRAVdo(ASSIGN_LET(arg_node), arg_info);
+    L_ASSIGN_LET(arg_node, TRAVdo(ASSIGN_LET(arg_node), arg_info));
     printf(" = ");
   }
 
-  ASSIGN_EXPR(arg_node) = TRAVdo(ASSIGN_EXPR(arg_node), arg_info);
+  L_ASSIGN_EXPR(arg_node, TRAVdo(ASSIGN_EXPR(arg_node), arg_info));
 
   printf(";\n");
 
@@ -105,11 +107,11 @@ node *PRTprogram(node *arg_node, info *arg_info)
   if (PROGRAM_SYMBOLTABLE(arg_node))
   {
     printf("/**\n");
-    PROGRAM_SYMBOLTABLE(arg_node) = TRAVdo(PROGRAM_SYMBOLTABLE(arg_node), arg_info);
+    L_PROGRAM_SYMBOLTABLE(arg_node, TRAVdo(PROGRAM_SYMBOLTABLE(arg_node), arg_info));
     printf("\n*/\n\n");
   }
 
-  PROGRAM_DECLS(arg_node) = TRAVdo(PROGRAM_DECLS(arg_node), arg_info);
+  L_PROGRAM_DECLS(arg_node, TRAVdo(PROGRAM_DECLS(arg_node), arg_info));
 
   DBUG_RETURN(arg_node);
 }
@@ -123,7 +125,7 @@ node *PRTreturn(node *arg_node, info *arg_info)
   if (RETURN_EXPR(arg_node))
   {
     printf(" ");
-    RETURN_EXPR(arg_node) = TRAVopt(RETURN_EXPR(arg_node), arg_info);
+    L_RETURN_EXPR(arg_node, TRAVopt(RETURN_EXPR(arg_node), arg_info));
   }
 
   printf(";\n");
@@ -137,7 +139,7 @@ node *PRTexprstmt(node *arg_node, info *arg_info)
 
   printIndentations(arg_info);
 
-  EXPRSTMT_EXPR(arg_node) = TRAVdo(EXPRSTMT_EXPR(arg_node), arg_info);
+  L_EXPRSTMT_EXPR(arg_node, TRAVdo(EXPRSTMT_EXPR(arg_node), arg_info));
 
   printf(";\n");
 
@@ -148,24 +150,37 @@ node *PRTarrexpr(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTarrexpr");
 
-  ARREXPR_EXPRS(arg_node) = TRAVdo(ARREXPR_EXPRS(arg_node), arg_info);
+  L_ARREXPR_EXPRS(arg_node, TRAVdo(ARREXPR_EXPRS(arg_node), arg_info));
 
   DBUG_RETURN(arg_node);
 }
 
 node *PRTbinop(node *arg_node, info *arg_info)
 {
+  node **spine;
+  int count;
+
   DBUG_ENTER("PRTbinop");
 
-  printf("( ");
+  spine = HbinopSpine(arg_node, &count);
+
+  for (int i = 0; i < count; i++)
+  {
+    printf("( ");
+  }
+
+  L_BINOP_LEFT(spine[count - 1], TRAVdo(BINOP_LEFT(spine[count - 1]), arg_info));
 
-  BINOP_LEFT(arg_node) = TRAVdo(BINOP_LEFT(arg_node), arg_info);
+  for (int i = count - 1; i >= 0; i--)
+  {
+    printf(" %s ", HprintBinOp(BINOP_OP(spine[i])));
 
-  printf(" %s ", HprintBinOp(BINOP_OP(arg_node)));
+    L_BINOP_RIGHT(spine[i], TRAVdo(BINOP_RIGHT(spine[i]), arg_info));
 
-  BINOP_RIGHT(arg_node) = TRAVdo(BINOP_RIGHT(arg_node), arg_info);
+    printf(" )");
+  }
 
-  printf(" )");
+  spine = MEMfree(spine);
 
   DBUG_RETURN(arg_node);
 }
@@ -174,12 +189,14 @@ node *PRTexprs(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTexprs");
 
-  EXPRS_EXPR(arg_node) = TRAVdo(EXPRS_EXPR(arg_node), arg_info);
-
-  if (EXPRS_NEXT(arg_node))
+  for (int i = 0; i < EXPRS_COUNT(arg_node); i++)
   {
-    printf(", ");
-    EXPRS_NEXT(arg_node) = TRAVopt(EXPRS_NEXT(arg_node), arg_info);
+    if (i > 0)
+    {
+      printf(", ");
+    }
+
+    L_EXPRS_EXPR(arg_node, i, TRAVdo(EXPRS_EXPR(arg_node, i), arg_info));
   }
 
   DBUG_RETURN(arg_node);
@@ -191,7 +208,7 @@ node *PRTmonop(node *arg_node, info *arg_info)
 
   printf("%s", HprintMonOp(MONOP_OP(arg_node)));
 
-  MONOP_OPERAND(arg_node) = TRAVdo(MONOP_OPERAND(arg_node), arg_info);
+  L_MONOP_OPERAND(arg_node, TRAVdo(MONOP_OPERAND(arg_node), arg_info));
 
   DBUG_RETURN(arg_node);
 }
@@ -200,19 +217,20 @@ node *PRTvardecl(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTvardecl");
 
-  printIndentations(arg_info);
-
-  printf("%s %s", HprintType(VARDECL_TYPE(arg_node)), VARDECL_NAME(arg_node));
-
-  if (VARDECL_INIT(arg_node) != NULL)
+  for (node *vardecl = arg_node; vardecl != NULL; vardecl = VARDECL_NEXT(vardecl))
   {
-    printf(" = ");
-    VARDECL_INIT(arg_node) = TRAVdo(VARDECL_INIT(arg_node), arg_info);
-  }
+    printIndentations(arg_info);
 
-  printf(";\n");
+    printf("%s %s", HprintType(VARDECL_TYPE(vardecl)), VARDECL_NAME(vardecl));
+
+    if (VARDECL_INIT(vardecl) != NULL)
+    {
+      printf(" = ");
+      L_VARDECL_INIT(vardecl, TRAVdo(VARDECL_INIT(vardecl), arg_info));
+    }
 
-  VARDECL_NEXT(arg_node) = TRAVopt(VARDECL_NEXT(arg_node), arg_info);
+    printf(";\n");
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -224,7 +242,7 @@ node *PRTfundecl(node *arg_node, info *arg_info)
   printf("extern %s %s", HprintType(FUNDECL_TYPE(arg_node)), FUNDECL_NAME(arg_node));
 
   printf(" ( ");
-  FUNDECL_PARAMS(arg_node) = TRAVopt(FUNDECL_PARAMS(arg_node), arg_info);
+  L_FUNDECL_PARAMS(arg_node, TRAVopt(FUNDECL_PARAMS(arg_node), arg_info));
   printf(" );\n");
 
   DBUG_RETURN(arg_node);
@@ -234,8 +252,10 @@ node *PRTfundefs(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTfundefs");
 
-  FUNDEFS_FUNDEF(arg_node) = TRAVdo(FUNDEFS_FUNDEF(arg_node), arg_info);
-  FUNDEFS_NEXT(arg_node) = TRAVopt(FUNDEFS_FUNDEF(arg_node), arg_info);
+  for (node *fundefs = arg_node; fundefs != NULL; fundefs = FUNDEFS_NEXT(fundefs))
+  {
+    L_FUNDEFS_FUNDEF(fundefs, TRAVdo(FUNDEFS_FUNDEF(fundefs), arg_info));
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -259,7 +279,7 @@ node *PRTfundef(node *arg_node, info *arg_info)
   printf("%s %s", HprintType(FUNDEF_TYPE(arg_node)), FUNDEF_NAME(arg_node));
 
   printf(" ( ");
-  FUNDEF_PARAMS(arg_node) = TRAVopt(FUNDEF_PARAMS(arg_node), arg_info);
+  L_FUNDEF_PARAMS(arg_node, TRAVopt(FUNDEF_PARAMS(arg_node), arg_info));
   printf(" ) ");
 
   if (!FUNDEF_FUNBODY(arg_node))
@@ -272,7 +292,7 @@ node *PRTfundef(node *arg_node, info *arg_info)
 
     INFO_INDENTATION_LEVEL(arg_info) += 1;
 
-    FUNDEF_FUNBODY(arg_node) = TRAVopt(FUNDEF_FUNBODY(arg_node), arg_info);
+    L_FUNDEF_FUNBODY(arg_node, TRAVopt(FUNDEF_FUNBODY(arg_node), arg_info));
 
     INFO_INDENTATION_LEVEL(arg_info) -= 1;
     print(arg_info, "}\n");
@@ -285,9 +305,9 @@ node *PRTfunbody(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTfunbody");
 
-  FUNBODY_VARDECLS(arg_node) = TRAVopt(FUNBODY_VARDECLS(arg_node), arg_info);
-  FUNBODY_LOCALFUNDEFS(arg_node) = TRAVopt(FUNBODY_LOCALFUNDEFS(arg_node), arg_info);
-  FUNBODY_STMTS(arg_node) = TRAVopt(FUNBODY_STMTS(arg_node), arg_info);
+  L_FUNBODY_VARDECLS(arg_node, TRAVopt(FUNBODY_VARDECLS(arg_node), arg_info));
+  L_FUNBODY_LOCALFUNDEFS(arg_node, TRAVopt(FUNBODY_LOCALFUNDEFS(arg_node), arg_info));
+  L_FUNBODY_STMTS(arg_node, TRAVopt(FUNBODY_STMTS(arg_node), arg_info));
 
   DBUG_RETURN(arg_node);
 }
@@ -297,13 +317,13 @@ node *PRTifelse(node *arg_node, info *arg_info)
   DBUG_ENTER("PRTifelse");
 
   print(arg_info, "if ( ");
-  IFELSE_COND(arg_node) = TRAVdo(IFELSE_COND(arg_node), arg_info);
+  L_IFELSE_COND(arg_node, TRAVdo(IFELSE_COND(arg_node), arg_info));
   printf(" )\n");
   print(arg_info, "{\n");
 
   INFO_INDENTATION_LEVEL(arg_info) += 1;
 
-  IFELSE_THEN(arg_node) = TRAVopt(IFELSE_THEN(arg_node), arg_info);
+  L_IFELSE_THEN(arg_node, TRAVopt(IFELSE_THEN(arg_node), arg_info));
 
   INFO_INDENTATION_LEVEL(arg_info) -= 1;
 
@@ -315,7 +335,7 @@ node *PRTifelse(node *arg_node, info *arg_info)
     print(arg_info, "{\n");
     INFO_INDENTATION_LEVEL(arg_info) += 1;
 
-    IFELSE_ELSE(arg_node) = TRAVopt(IFELSE_ELSE(arg_node), arg_info);
+    L_IFELSE_ELSE(arg_node, TRAVopt(IFELSE_ELSE(arg_node), arg_info));
 
     INFO_INDENTATION_LEVEL(arg_info) -= 1;
     print(arg_info, "}\n");
@@ -326,15 +346,30 @@ node *PRTifelse(node *arg_node, info *arg_info)
 
 node *PRTternary(node *arg_node, info *arg_info)
 {
+  node **spine;
+  int count;
+
   DBUG_ENTER("PRTternary");
 
-  printf("( ");
-  TERNARY_COND(arg_node) = TRAVdo(TERNARY_COND(arg_node), arg_info);
-  printf(" ? ");
-  TERNARY_THEN(arg_node) = TRAVdo(TERNARY_THEN(arg_node), arg_info);
-  printf(" : ");
-  TERNARY_ELSE(arg_node) = TRAVdo(TERNARY_ELSE(arg_node), arg_info);
-  printf(" )");
+  spine = HternarySpine(arg_node, &count);
+
+  for (int i = 0; i < count; i++)
+  {
+    printf("( ");
+  }
+
+  L_TERNARY_COND(spine[count - 1], TRAVdo(TERNARY_COND(spine[count - 1]), arg_info));
+
+  for (int i = count - 1; i >= 0; i--)
+  {
+    printf(" ? ");
+    L_TERNARY_THEN(spine[i], TRAVdo(TERNARY_THEN(spine[i]), arg_info));
+    printf(" : ");
+    L_TERNARY_ELSE(spine[i], TRAVdo(TERNARY_ELSE(spine[i]), arg_info));
+    printf(" )");
+  }
+
+  spine = MEMfree(spine);
 
   DBUG_RETURN(arg_node);
 }
@@ -343,8 +378,10 @@ node *PRTdecls(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTdecls");
 
-  DECLS_DECL(arg_node) = TRAVdo(DECLS_DECL(arg_node), arg_info);
-  DECLS_NEXT(arg_node) = TRAVopt(DECLS_NEXT(arg_node), arg_info);
+  for (int i = 0; i < DECLS_COUNT(arg_node); i++)
+  {
+    L_DECLS_DECL(arg_node, i, TRAVdo(DECLS_DECL(arg_node, i), arg_info));
+  }
 
   DBUG_RETURN(arg_node);
 }
@@ -369,12 +406,12 @@ node *PRTglobdef(node *arg_node, info *arg_info)
 
   printf("%s %s", HprintType(GLOBDEF_TYPE(arg_node)), GLOBDEF_NAME(arg_node));
 
-  GLOBDEF_DIMS(arg_node) = TRAVopt(GLOBDEF_DIMS(arg_node), arg_info);
+  L_GLOBDEF_DIMS(arg_node, TRAVopt(GLOBDEF_DIMS(arg_node), arg_info));
 
   if (GLOBDEF_INIT(arg_node) != NULL)
   {
     printf(" = ");
-    GLOBDEF_INIT(arg_node) = TRAVopt(GLOBDEF_INIT(arg_node), arg_info);
+    L_GLOBDEF_INIT(arg_node, TRAVopt(GLOBDEF_INIT(arg_node), arg_info));
   }
 
   printf(";\n");
@@ -388,15 +425,15 @@ node *PRTfor(node *arg_node, info *arg_info)
 
   print(arg_info, "for ( int %s = ", FOR_LOOPVAR(arg_node));
 
-  FOR_START(arg_node) = TRAVdo(FOR_START(arg_node), arg_info);
+  L_FOR_START(arg_node, TRAVdo(FOR_START(arg_node), arg_info));
 
   printf(", ");
-  FOR_STOP(arg_node) = TRAVdo(FOR_STOP(arg_node), arg_info);
+  L_FOR_STOP(arg_node, TRAVdo(FOR_STOP(arg_node), arg_info));
 
   if (FOR_STEP(arg_node) != NULL)
   {
     printf(", ");
-    FOR_STEP(arg_node) = TRAVopt(FOR_STEP(arg_node), arg_info);
+    L_FOR_STEP(arg_node, TRAVopt(FOR_STEP(arg_node), arg_info));
   }
 
   printf(")\n");
@@ -406,7 +443,7 @@ node *PRTfor(node *arg_node, info *arg_info)
   INFO_INDENTATION_LEVEL(arg_info)
   ++;
 
-  FOR_BLOCK(arg_node) = TRAVopt(FOR_BLOCK(arg_node), arg_info);
+  L_FOR_BLOCK(arg_node, TRAVopt(FOR_BLOCK(arg_node), arg_info));
 
   INFO_INDENTATION_LEVEL(arg_info)
   --;
@@ -479,7 +516,7 @@ node *PRTfuncall(node *arg_node, info *arg_info)
 
   printf("%s(", FUNCALL_NAME(arg_node));
 
-  FUNCALL_ARGS(arg_node) = TRAVopt(FUNCALL_ARGS(arg_node), arg_info);
+  L_FUNCALL_ARGS(arg_node, TRAVopt(FUNCALL_ARGS(arg_node), arg_info));
 
   printf(")");
 
@@ -492,7 +529,7 @@ node *PRTcast(node *arg_node, info *arg_info)
 
   printf("(%s)", HprintType(CAST_TYPE(arg_node)));
 
-  CAST_EXPR(arg_node) = TRAVdo(CAST_EXPR(arg_node), arg_info);
+  L_CAST_EXPR(arg_node, TRAVdo(CAST_EXPR(arg_node), arg_info));
 
   DBUG_RETURN(arg_node);
 }
@@ -503,7 +540,7 @@ node *PRTwhile(node *arg_node, info *arg_info)
 
   print(arg_info, "while ( ");
 
-  WHILE_COND(arg_node) = TRAVdo(WHILE_COND(arg_node), arg_info);
+  L_WHILE_COND(arg_node, TRAVdo(WHILE_COND(arg_node), arg_info));
 
   printf(" )\n");
   print(arg_info, "{\n");
@@ -511,7 +548,7 @@ node *PRTwhile(node *arg_node, info *arg_info)
   INFO_INDENTATION_LEVEL(arg_info)
   ++;
 
-  WHILE_BLOCK(arg_node) = TRAVopt(WHILE_BLOCK(arg_node), arg_info);
+  L_WHILE_BLOCK(arg_node, TRAVopt(WHILE_BLOCK(arg_node), arg_info));
 
   INFO_INDENTATION_LEVEL(arg_info)
   --;
@@ -531,7 +568,7 @@ node *PRTdowhile(node *arg_node, info *arg_info)
   INFO_INDENTATION_LEVEL(arg_info)
   ++;
 
-  DOWHILE_BLOCK(arg_node) = TRAVopt(DOWHILE_BLOCK(arg_node), arg_info);
+  L_DOWHILE_BLOCK(arg_node, TRAVopt(DOWHILE_BLOCK(arg_node), arg_info));
 
   INFO_INDENTATION_LEVEL(arg_info)
   --;
@@ -539,7 +576,7 @@ node *PRTdowhile(node *arg_node, info *arg_info)
   print(arg_info, "}\n");
   print(arg_info, "while ( ");
 
-  DOWHILE_COND(arg_node) = TRAVdo(DOWHILE_COND(arg_node), arg_info);
+  L_DOWHILE_COND(arg_node, TRAVdo(DOWHILE_COND(arg_node), arg_info));
 
   printf(" );\n");
 
@@ -550,12 +587,14 @@ node *PRTparam(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTparam");
 
-  printf("%s %s", HprintType(PARAM_TYPE(arg_node)), PARAM_NAME(arg_node));
-
-  if (PARAM_NEXT(arg_node))
+  for (node *param = arg_node; param != NULL; param = PARAM_NEXT(param))
   {
-    printf(", ");
-    PARAM_NEXT(arg_node) = TRAVopt(PARAM_NEXT(arg_node), arg_info);
+    printf("%s %s", HprintType(PARAM_TYPE(param)), PARAM_NAME(param));
+
+    if (PARAM_NEXT(param))
+    {
+      printf(", ");
+    }
   }
 
   DBUG_RETURN(arg_node);
@@ -567,7 +606,7 @@ node *PRTsymboltable(node *arg_node, info *arg_info)
 
   printf("Symbol Table:\n\n");
   printf("\t%-15s %-10s %-15s %-15s %-15s\n", "Symbol:", "Type:", "Is Function:", "Is Export:", "Is Parameter:");
-  SYMBOLTABLE_ENTRIES(arg_node) = TRAVopt(SYMBOLTABLE_ENTRIES(arg_node), arg_info);
+  L_SYMBOLTABLE_ENTRIES(arg_node, TRAVopt(SYMBOLTABLE_ENTRIES(arg_node), arg_info));
 
   DBUG_RETURN(arg_node);
 }
@@ -576,16 +615,20 @@ node *PRTsymboltableentry(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTsymboltableentry");
 
-  printf("\t%-15s %-10s %-15s %-15s %-15s\n", SYMBOLTABLEENTRY_NAME(arg_node), HprintType(SYMBOLTABLEENTRY_TYPE(arg_node)), SYMBOLTABLEENTRY_ISFUNCTION(arg_node) ? "True" : "False", SYMBOLTABLEENTRY_ISEXPORT(arg_node) ? "True" : "False", SYMBOLTABLEENTRY_ISPARAMETER(arg_node) ? "True" : "False");
-
-  if (SYMBOLTABLEENTRY_NEXT(arg_node) != NULL)
+  for (node *entry = arg_node; entry != NULL; entry = SYMBOLTABLEENTRY_NEXT(entry))
   {
-    SYMBOLTABLEENTRY_NEXT(arg_node) = TRAVdo(SYMBOLTABLEENTRY_NEXT(arg_node), arg_info);
+    printf("\t%-15s %-10s %-15s %-15s %-15s\n", SYMBOLTABLEENTRY_NAME(entry), HprintType(SYMBOLTABLEENTRY_TYPE(entry)), SYMBOLTABLEENTRY_ISFUNCTION(entry) ? "True" : "False", SYMBOLTABLEENTRY_ISEXPORT(entry) ? "True" : "False", SYMBOLTABLEENTRY_ISPARAMETER(entry) ? "True" : "False");
   }
 
   DBUG_RETURN(arg_node);
 }
 
+node *PRTsignature(node *arg_node, info *arg_info)
+{
+  DBUG_ENTER("PRTsignature");
+  DBUG_RETURN(arg_node);
+}
+
 node *PRTnum(node *arg_node, info *arg_info)
 {
   DBUG_ENTER("PRTnum");
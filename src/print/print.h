@@ -47,6 +47,7 @@ extern node *PRTcast(node *arg_node, info *arg_info);
 
 extern node *PRTsymboltable(node *arg_node, info *arg_info);
 extern node *PRTsymboltableentry(node *arg_node, info *arg_info);
+extern node *PRTsignature(node *arg_node, info *arg_info);
 
 extern node *PRTnum(node *arg_node, info *arg_info);
 extern node *PRTfloat(node *arg_node, info *arg_info);
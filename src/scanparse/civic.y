@@ -13,16 +13,27 @@
 #include "ctinfo.h"
 #include "free.h"
 #include "globals.h"
-
-static node *parseresult = NULL;
-extern int yylex();
-static int yyerror( char *errname);
+#include "myglobals.h"
+#include "location.h"
+#include "source.h"
+#include "lexer.h"
+#include "parser.h"
+#include "parallel_parse.h"
+#include "preprocess.h"
+
+static lexer fast_lexer;
+static int yylex( void);
+extern int YYflexLex( void);
+extern void YYscanSource( void);
+static int yyerror( node **result, char *errname);
 
 %}
 
+%parse-param { node **result }
+
 %union {
  nodetype            nodetype;
- char               *id;
+ slice               id;
  int                 cint;
  float               cflt;
  bool                cbool;
@@ -30,6 +41,10 @@ static int yyerror( char *errname);
  monop               cmonop;
  type                ctype;
  node               *node;
+ struct {
+   node *first;
+   node *last;
+ }                   list;
 }
 
 %token PARENTHESIS_L PARENTHESIS_R CURLY_L CURLY_R BRACKET_L BRACKET_R COMMA SEMICOLON
@@ -45,11 +60,12 @@ static int yyerror( char *errname);
 %token <cbool> BOOLVAL
 
 %type <node> constant expr
-%type <node> stmts stmt assign varlet program
-%type <node> return exprstmt binop exprs monop
+%type <node> stmt assign varlet program
+%type <node> return exprstmt binop monop
 %type <node> vardecl fundecl fundef funbody block ifelse
-%type <node> decl decls globdecl globdef for dowhile
-%type <node> param while
+%type <node> decl globdecl globdef for dowhile
+%type <node> while stmts decls exprs
+%type <list> params vardecls
 
 %type <ctype> type
 
@@ -73,17 +89,23 @@ static int yyerror( char *errname);
 
 program: decls 
          {
-           parseresult = TBmakeProgram($1, NULL);
+           *result = TBmakeProgram($1, NULL);
          }
         ;
 
-decls: decl decls
+/*
+ * Lists are left-recursive, so that the parser stack stays flat however
+ * long they get. Decls, stmts and exprs are list nodes that every item is
+ * appended to. The semantic value of the other lists holds both ends of
+ * the chain built so far, and every item is appended at the last one.
+ */
+decls: decls decl
         {
-            $$ = TBmakeDecls( $1, $2);
+            $$ = TBappend( $1, $2);
         }
     |   decl
         {
-            $$ = TBmakeDecls( $1, NULL);
+            $$ = TBappend( TBmakeDecls(), $1);
         }
     ;
 
@@ -108,67 +130,69 @@ decl:   fundecl
 
 globdecl: EXTERN type ID SEMICOLON
         {
-            $$ = TBmakeGlobdecl($2, STRcpy( $3), NULL);
+            $$ = TBmakeGlobdecl($2, SRCsliceName( $3), NULL);
         }
       ;
 
 globdef: type ID SEMICOLON
         {
-            $$ = TBmakeGlobdef($1, STRcpy( $2), NULL, NULL);
+            $$ = TBmakeGlobdef($1, SRCsliceName( $2), NULL, NULL);
         }
     |   type ID LET expr SEMICOLON
         {
-            $$ = TBmakeGlobdef($1, STRcpy( $2), NULL, $4);
+            $$ = TBmakeGlobdef($1, SRCsliceName( $2), NULL, $4);
         }
     |   EXPORT type ID SEMICOLON
         {
-            $$ = TBmakeGlobdef($2, STRcpy( $3), NULL, NULL);
+            $$ = TBmakeGlobdef($2, SRCsliceName( $3), NULL, NULL);
             GLOBDEF_ISEXPORT($$) = 1;
         }
     |   EXPORT type ID LET expr SEMICOLON
         {
-            $$ = TBmakeGlobdef($2, STRcpy( $3), NULL, $5);
+            $$ = TBmakeGlobdef($2, SRCsliceName( $3), NULL, $5);
             GLOBDEF_ISEXPORT($$) = 1;
         }
     ;
 
 fundecl: EXTERN type ID PARENTHESIS_L PARENTHESIS_R SEMICOLON
         {
-            $$ = TBmakeFundecl( $2, STRcpy( $3), NULL);
+            $$ = TBmakeFundecl( $2, SRCsliceName( $3), NULL);
         }
-    |   EXTERN type ID PARENTHESIS_L param PARENTHESIS_R SEMICOLON
+    |   EXTERN type ID PARENTHESIS_L params PARENTHESIS_R SEMICOLON
         {
-            $$ = TBmakeFundecl( $2, STRcpy( $3), $5);
+            $$ = TBmakeFundecl( $2, SRCsliceName( $3), $5.first);
         }
     ;
 
 fundef: type ID PARENTHESIS_L PARENTHESIS_R  CURLY_L funbody CURLY_R
         {
-            $$ = TBmakeFundef( $1, STRcpy( $2), $6, NULL);
+            $$ = TBmakeFundef( $1, SRCsliceName( $2), $6, NULL);
         }
-    |   type ID PARENTHESIS_L param PARENTHESIS_R CURLY_L funbody CURLY_R
+    |   type ID PARENTHESIS_L params PARENTHESIS_R CURLY_L funbody CURLY_R
         {
-            $$ = TBmakeFundef( $1, STRcpy( $2), $7, $4);
+            $$ = TBmakeFundef( $1, SRCsliceName( $2), $7, $4.first);
         }
     |   EXPORT type ID PARENTHESIS_L PARENTHESIS_R CURLY_L funbody CURLY_R
         {
-            $$ = TBmakeFundef( $2, STRcpy( $3), $7, NULL);
+            $$ = TBmakeFundef( $2, SRCsliceName( $3), $7, NULL);
             FUNDEF_ISEXPORT($$) = 1;
         }
-    |   EXPORT type ID PARENTHESIS_L param PARENTHESIS_R CURLY_L funbody CURLY_R
+    |   EXPORT type ID PARENTHESIS_L params PARENTHESIS_R CURLY_L funbody CURLY_R
         {
-            $$ = TBmakeFundef( $2, STRcpy( $3), $8, $5);
+            $$ = TBmakeFundef( $2, SRCsliceName( $3), $8, $5.first);
             FUNDEF_ISEXPORT($$) = 1;
         }
     ;
 
-param: type ID COMMA param
+params: params COMMA type ID
         {
-            $$ = TBmakeParam( STRcpy( $2), $1, NULL, $4);
+            L_PARAM_NEXT( $1.last, TBmakeParam( SRCsliceName( $4), $3, NULL, NULL));
+            $$.first = $1.first;
+            $$.last = PARAM_NEXT( $1.last);
         }
     |   type ID
         {
-            $$ = TBmakeParam( STRcpy( $2), $1, NULL, NULL);
+            $$.first = $$.last = TBmakeParam( SRCsliceName( $2), $1, NULL, NULL);
         }
     ;
 
@@ -176,45 +200,49 @@ funbody:
         {
             $$ = TBmakeFunbody( NULL, NULL, NULL);
         }
-    |   vardecl
+    |   vardecls
         {
-            $$ = TBmakeFunbody( $1, NULL, NULL);
+            $$ = TBmakeFunbody( $1.first, NULL, NULL);
         }
     |   stmts
         {
             $$ = TBmakeFunbody( NULL, NULL, $1);
         }
-    |   vardecl stmts
+    |   vardecls stmts
         {
-            $$ = TBmakeFunbody( $1, NULL, $2);
+            $$ = TBmakeFunbody( $1.first, NULL, $2);
         }
     ;
 
-vardecl: type ID SEMICOLON
+vardecls: vardecls vardecl
         {
-            $$ = TBmakeVardecl( STRcpy( $2), $1, NULL, NULL, NULL);
+            L_VARDECL_NEXT( $1.last, $2);
+            $$.first = $1.first;
+            $$.last = $2;
         }
-    |   type ID LET expr SEMICOLON
+    |   vardecl
         {
-            $$ = TBmakeVardecl( STRcpy( $2), $1, NULL, $4, NULL);
+            $$.first = $$.last = $1;
         }
-    |   type ID SEMICOLON vardecl
+    ;
+
+vardecl: type ID SEMICOLON
         {
-            $$ = TBmakeVardecl( STRcpy( $2), $1, NULL, NULL, $4);
+            $$ = TBmakeVardecl( SRCsliceName( $2), $1, NULL, NULL, NULL);
         }
-    |   type ID LET expr SEMICOLON vardecl
+    |   type ID LET expr SEMICOLON
         {
-            $$ = TBmakeVardecl( STRcpy( $2), $1, NULL, $4, $6);
+            $$ = TBmakeVardecl( SRCsliceName( $2), $1, NULL, $4, NULL);
         }
     ;
 
-stmts: stmt stmts
+stmts: stmts stmt
         {
-          $$ = TBmakeStmts( $1, $2);
+          $$ = TBappend( $1, $2);
         }
       | stmt
         {
-          $$ = TBmakeStmts( $1, NULL);
+          $$ = TBappend( TBmakeStmts(), $1);
         }
         ;
 
@@ -272,11 +300,11 @@ dowhile: DO block WHILE PARENTHESIS_L expr PARENTHESIS_R SEMICOLON
 
 for: FOR PARENTHESIS_L INT ID LET expr COMMA expr PARENTHESIS_R block
         {
-            $$ = TBmakeFor( STRcpy( $4), $6, $8, NULL, $10);
+            $$ = TBmakeFor( SRCsliceName( $4), $6, $8, NULL, $10);
         }
     |   FOR PARENTHESIS_L INT ID LET expr COMMA expr COMMA expr PARENTHESIS_R block
         {
-            $$ = TBmakeFor( STRcpy( $4), $6, $8, $10, $12);
+            $$ = TBmakeFor( SRCsliceName( $4), $6, $8, $10, $12);
         }
     ;
 
@@ -290,7 +318,7 @@ block: CURLY_L CURLY_R
         }
     |   stmt
         {
-            $$ = TBmakeStmts($1, NULL);
+            $$ = TBappend( TBmakeStmts(), $1);
         }
     ;
 
@@ -318,17 +346,17 @@ assign: varlet LET expr SEMICOLON
 
 varlet: ID
         {
-          $$ = TBmakeVarlet( STRcpy( $1), NULL, NULL);
+          $$ = TBmakeVarlet( SRCsliceName( $1), NULL, NULL);
         }
         ;
 
-exprs:  expr COMMA exprs
+exprs:  exprs COMMA expr
         {
-            $$ = TBmakeExprs($1, $3);
+            $$ = TBappend( $1, $3);
         }
     |   expr
         {
-            $$ = TBmakeExprs($1, NULL);
+            $$ = TBappend( TBmakeExprs(), $1);
         }
     ;
 
@@ -339,7 +367,7 @@ expr:
         }
     |   ID
         {
-            $$ = TBmakeVar( STRcpy( $1), NULL, NULL);
+            $$ = TBmakeVar( SRCsliceName( $1), NULL, NULL);
         }
     |   binop
         {
@@ -359,11 +387,11 @@ expr:
         }
     |   ID PARENTHESIS_L exprs PARENTHESIS_R
         {
-            $$ = TBmakeFuncall( STRcpy( $1), NULL, $3);
+            $$ = TBmakeFuncall( SRCsliceName( $1), NULL, $3);
         }
     |   ID PARENTHESIS_L PARENTHESIS_R
         {
-            $$ = TBmakeFuncall( STRcpy( $1), NULL, NULL);
+            $$ = TBmakeFuncall( SRCsliceName( $1), NULL, NULL);
         }
     ;
 
@@ -411,20 +439,110 @@ type:
 
 %%
 
-static int yyerror( char *error)
+static int yyerror( node **result, char *error)
 {
   CTIabort( "line %d, col %d\nError parsing source code: %s\n", 
-            global.line, global.col, error);
+            LOCline( global.line), LOCcol( global.line), error);
 
   return( 0);
 }
 
+/*
+ * Hands the parser the next token from either the flex scanner or, with
+ * -lexer=fast, the hand-written lexer.
+ */
+static int yylex( void)
+{
+  int token;
+
+  if (!myglobal.fast_lexer) {
+    return( YYflexLex());
+  }
+
+  token = LEXnext( &fast_lexer, &yylval);
+  global.line = fast_lexer.offset;
+
+  return( token);
+}
+
+/*
+ * Prints the token stream with source offsets and semantic values, one
+ * token per line. Used to compare the two lexers.
+ */
+static void DumpTokens( void)
+{
+  int token;
+
+  while ((token = yylex()) != 0) {
+    printf( "%d %d", global.line, token);
+
+    switch (token) {
+    case ID:
+      printf( " %s", SRCsliceName( yylval.id));
+      break;
+    case INTVAL:
+      printf( " %d", yylval.cint);
+      break;
+    case FLOATVAL:
+      printf( " %.9g", yylval.cflt);
+      break;
+    case BOOLVAL:
+      printf( " %d", yylval.cbool);
+      break;
+    default:
+      break;
+    }
+    printf( "\n");
+  }
+}
+
 node *YYparseTree( void)
 {
-  DBUG_ENTER("YYparseTree");
+  node *result = NULL;
 
-  yyparse();
+  DBUG_ENTER("YYparseTree");
 
-  DBUG_RETURN( parseresult);
+  if (myglobal.fast_lexer || myglobal.builtin_cpp) {
+    if (!(myglobal.mmap_input && SRCmapFile( global.infile))
+        && !SRCreadFile( global.infile)) {
+      CTIabort( "Cannot read input file %s", global.infile);
+    }
+    if (myglobal.builtin_cpp) {
+      PPpreprocessSource( global.infile);
+    }
+    if (myglobal.fast_lexer) {
+      LEXinit( &fast_lexer, SRCtext(), SRCtext(), SRCtext() + SRCsize());
+    }
+    else {
+      YYscanSource();
+    }
+  }
+  else if (myglobal.mmap_input && SRCmapFile( global.infile)) {
+    YYscanSource();
+  }
+
+  /*
+   * The dump leaves the lexer at the end of the input, so there is nothing
+   * left to parse: compilation stops after this subphase with an empty
+   * program.
+   */
+  if (myglobal.dump_tokens) {
+    DumpTokens();
+    global.break_after_subphase = global.compiler_subphase;
+    result = TBmakeProgram( NULL, NULL);
+  }
+  else if (myglobal.rd_parser && myglobal.fast_lexer && myglobal.parse_threads > 1) {
+    result = PRLparseProgram( &fast_lexer, myglobal.parse_threads);
+  }
+  else if (myglobal.rd_parser) {
+    result = RDPparseProgram( myglobal.fast_lexer ? &fast_lexer : NULL);
+  }
+  else {
+    yyparse( &result);
+  }
+
+  SRCrelease();
+
+  DBUG_RETURN( result);
 }
 
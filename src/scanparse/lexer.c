@@ -0,0 +1,617 @@
+/*
+ * Hand-written lexer for CiviC, selected with -lexer=fast.
+ *
+ * It produces exactly the token stream, semantic values and token offsets
+ * of the flex scanner in civic.l, but works on the whole source
+ * text in memory. Identifier, number and whitespace runs as well as comment
+ * bodies are classified 16 (SSE2) or 32 (AVX2) bytes at a time; keywords are
+ * recognised with a perfect hash instead of a DFA.
+ */
+
+#include "lexer.h"
+
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "civic.tab.h"
+#include "ctinfo.h"
+#include "dbug.h"
+#include "location.h"
+#include "memory.h"
+#include "source.h"
+
+#define IS_ALPHA(c) (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z'))
+#define IS_DIGIT(c) ((c) >= '0' && (c) <= '9')
+#define IS_IDENT(c) (IS_ALPHA(c) || IS_DIGIT(c) || (c) == '_')
+#define IS_SPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\n')
+
+/*
+ * Vector primitives. Loads are unaligned and may run past the end of the
+ * lexed range; SRC_PADDING guarantees they stay within readable memory,
+ * because every scan stops at the first zero byte.
+ */
+#if defined(__AVX2__)
+
+typedef __m256i vec;
+#define VEC_WIDTH 32
+#define VEC_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define VEC_SPLAT(c) _mm256_set1_epi8(c)
+#define VEC_EQ(a, b) _mm256_cmpeq_epi8(a, b)
+#define VEC_GT(a, b) _mm256_cmpgt_epi8(a, b)
+#define VEC_OR(a, b) _mm256_or_si256(a, b)
+#define VEC_AND(a, b) _mm256_and_si256(a, b)
+#define VEC_MASK(v) ((unsigned int)_mm256_movemask_epi8(v))
+#define VEC_ALL 0xFFFFFFFFu
+
+#elif defined(__SSE2__)
+
+typedef __m128i vec;
+#define VEC_WIDTH 16
+#define VEC_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define VEC_SPLAT(c) _mm_set1_epi8(c)
+#define VEC_EQ(a, b) _mm_cmpeq_epi8(a, b)
+#define VEC_GT(a, b) _mm_cmpgt_epi8(a, b)
+#define VEC_OR(a, b) _mm_or_si128(a, b)
+#define VEC_AND(a, b) _mm_and_si128(a, b)
+#define VEC_MASK(v) ((unsigned int)_mm_movemask_epi8(v))
+#define VEC_ALL 0xFFFFu
+
+#endif
+
+#ifdef VEC_WIDTH
+
+/**
+ * Byte mask of lo <= v <= hi. The compares are signed, so bytes >= 0x80
+ * are never in an ASCII range.
+ */
+static inline vec InRange(vec v, char lo, char hi)
+{
+    return VEC_AND(VEC_GT(v, VEC_SPLAT(lo - 1)), VEC_GT(VEC_SPLAT(hi + 1), v));
+}
+
+/**
+ * Bit mask of the bytes at p that are not [A-Za-z0-9_].
+ */
+static inline unsigned int NotIdentMask(const char *p)
+{
+    vec v = VEC_LOAD(p);
+    vec m = VEC_OR(VEC_OR(InRange(v, 'a', 'z'), InRange(v, 'A', 'Z')),
+                   VEC_OR(InRange(v, '0', '9'), VEC_EQ(v, VEC_SPLAT('_'))));
+
+    return ~VEC_MASK(m) & VEC_ALL;
+}
+
+/**
+ * Bit mask of the bytes at p that are not [0-9].
+ */
+static inline unsigned int NotDigitMask(const char *p)
+{
+    return ~VEC_MASK(InRange(VEC_LOAD(p), '0', '9')) & VEC_ALL;
+}
+
+#endif
+
+/**
+ * @return Length of the [A-Za-z0-9_]* run at p, limited to end.
+ */
+static int SpanIdent(const char *p, const char *end)
+{
+    int n = 0;
+
+#ifdef VEC_WIDTH
+    unsigned int mask;
+
+    while ((mask = NotIdentMask(p + n)) == 0)
+    {
+        n += VEC_WIDTH;
+    }
+    n += __builtin_ctz(mask);
+#else
+    while (IS_IDENT(p[n]))
+    {
+        n++;
+    }
+#endif
+
+    return p + n > end ? (int)(end - p) : n;
+}
+
+/**
+ * @return Length of the [0-9]* run at p, limited to end.
+ */
+static int SpanDigits(const char *p, const char *end)
+{
+    int n = 0;
+
+#ifdef VEC_WIDTH
+    unsigned int mask;
+
+    while ((mask = NotDigitMask(p + n)) == 0)
+    {
+        n += VEC_WIDTH;
+    }
+    n += __builtin_ctz(mask);
+#else
+    while (IS_DIGIT(p[n]))
+    {
+        n++;
+    }
+#endif
+
+    return p + n > end ? (int)(end - p) : n;
+}
+
+/**
+ * @return Length of the [ \t\n]* run at p, limited to end.
+ */
+static int SpanSpace(const char *p, const char *end)
+{
+    int n = 0;
+
+#ifdef VEC_WIDTH
+    unsigned int mask;
+
+    for (;;)
+    {
+        vec v = VEC_LOAD(p + n);
+
+        mask = ~VEC_MASK(VEC_OR(VEC_OR(VEC_EQ(v, VEC_SPLAT(' ')), VEC_EQ(v, VEC_SPLAT('\t'))),
+                                VEC_EQ(v, VEC_SPLAT('\n'))))
+               & VEC_ALL;
+        if (mask != 0)
+        {
+            n += __builtin_ctz(mask);
+            break;
+        }
+        n += VEC_WIDTH;
+    }
+#else
+    while (IS_SPACE(p[n]))
+    {
+        n++;
+    }
+#endif
+
+    return p + n > end ? (int)(end - p) : n;
+}
+
+/**
+ * @return Offset of the first byte at p that is a, b or c.
+ */
+static int FindAny(const char *p, char a, char b, char c)
+{
+    int n = 0;
+
+#ifdef VEC_WIDTH
+    unsigned int mask;
+
+    for (;;)
+    {
+        vec v = VEC_LOAD(p + n);
+
+        mask = VEC_MASK(VEC_OR(VEC_OR(VEC_EQ(v, VEC_SPLAT(a)), VEC_EQ(v, VEC_SPLAT(b))),
+                               VEC_EQ(v, VEC_SPLAT(c))));
+        if (mask != 0)
+        {
+            return n + __builtin_ctz(mask);
+        }
+        n += VEC_WIDTH;
+    }
+#else
+    while (p[n] != a && p[n] != b && p[n] != c)
+    {
+        n++;
+    }
+    return n;
+#endif
+}
+
+/**
+ * Skips the body of a line comment.
+ *
+ * @return Position of the terminating newline, or end.
+ */
+static const char *SkipLineComment(const char *p, const char *end)
+{
+    for (;;)
+    {
+        p += FindAny(p, '\n', '\0', '\n');
+        if (p >= end)
+        {
+            return end;
+        }
+        if (*p == '\n')
+        {
+            return p;
+        }
+        p++;
+    }
+}
+
+/**
+ * Skips a block comment that starts at p.
+ *
+ * @return Position after the closing delimiter, or NULL if there is none.
+ */
+static const char *SkipBlockComment(const char *p, const char *end)
+{
+    p += 2;
+
+    for (;;)
+    {
+        p += FindAny(p, '*', '\0', '\0');
+        if (p >= end)
+        {
+            return NULL;
+        }
+        if (*p == '*' && p + 1 < end && p[1] == '/')
+        {
+            return p + 2;
+        }
+        p++;
+    }
+}
+
+/*
+ * Keywords, placed by a perfect hash over their length and their first and
+ * last characters.
+ */
+typedef struct KEYWORD
+{
+    const char *name;
+    int length;
+    int token;
+} keyword;
+
+#define KEYWORD_SLOTS 32
+#define KEYWORD_HASH(p, len)                                                             \
+    (((unsigned int)(len) + 4 * (unsigned char)(p)[0] + (unsigned char)(p)[(len)-1]) \
+     & (KEYWORD_SLOTS - 1))
+
+static const keyword keywords[KEYWORD_SLOTS] = {
+    [0] = {"void", 4, VOID},
+    [1] = {"do", 2, DO},
+    [2] = {"false", 5, BOOLVAL},
+    [6] = {"while", 5, WHILE},
+    [8] = {"extern", 6, EXTERN},
+    [12] = {"if", 2, IF},
+    [13] = {"for", 3, FOR},
+    [14] = {"export", 6, EXPORT},
+    [17] = {"float", 5, FLOAT},
+    [24] = {"bool", 4, BOOL},
+    [25] = {"true", 4, BOOLVAL},
+    [27] = {"int", 3, INT},
+    [28] = {"return", 6, RETURN},
+    [29] = {"else", 4, ELSE},
+};
+
+/**
+ * Converts a number token like flex's yytext, by copying it into a
+ * zero terminated buffer.
+ */
+static char *TokenText(const char *p, int length, char *buffer, int buffer_size)
+{
+    char *result = length < buffer_size ? buffer : MEMmalloc(length + 1);
+
+    memcpy(result, p, length);
+    result[length] = '\0';
+
+    return result;
+}
+
+/**
+ * Initialises a lexer for the text between begin and end. The lexer
+ * reports diagnostics right away until deferring is set.
+ *
+ * @param base Start of the source, which offsets are relative to.
+ */
+void LEXinit(lexer *lx, const char *base, const char *begin, const char *end)
+{
+    DBUG_ENTER("LEXinit");
+
+    lx->base = base;
+    lx->cursor = begin;
+    lx->end = end;
+    lx->offset = (int)(begin - base);
+    lx->deferring = FALSE;
+    lx->diagnostics = NULL;
+    lx->last_diagnostic = NULL;
+
+    DBUG_VOID_RETURN;
+}
+
+/**
+ * Reports a diagnostic the way the sequential compiler does: errors through
+ * CTIerrorLine, aborts through CTIabort with the line and column in front,
+ * and fatal scanner errors like flex's yy_fatal_error.
+ */
+static void Report(diagkind kind, int offset, const char *message)
+{
+    switch (kind)
+    {
+    case DIAG_error:
+        CTIerrorLine(LOCline(offset), "%s", message);
+        break;
+    case DIAG_abort:
+        CTIabort("line %d, col %d\n%s", LOCline(offset), LOCcol(offset), message);
+        break;
+    case DIAG_fatal:
+        fprintf(stderr, "%s\n", message);
+        exit(2);
+        break;
+    }
+}
+
+/**
+ * Reports a diagnostic, or records it if the lexer is deferring. A deferred
+ * abort or fatal error ends the work of the lexer by jumping to its bail
+ * point.
+ *
+ * @param offset Source offset the diagnostic refers to; ignored for
+ *               DIAG_fatal.
+ */
+void LEXreport(lexer *lx, diagkind kind, int offset, const char *format, ...)
+{
+    va_list args;
+    diagnostic *diag;
+    char *message;
+    int length;
+
+    va_start(args, format);
+    length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    message = MEMmalloc(length + 1);
+    va_start(args, format);
+    vsnprintf(message, length + 1, format, args);
+    va_end(args);
+
+    if (!lx->deferring)
+    {
+        Report(kind, offset, message);
+        MEMfree(message);
+        return;
+    }
+
+    diag = MEMmalloc(sizeof(diagnostic));
+    diag->kind = kind;
+    diag->offset = offset;
+    diag->message = message;
+    diag->next = NULL;
+
+    if (lx->last_diagnostic == NULL)
+    {
+        lx->diagnostics = diag;
+    }
+    else
+    {
+        lx->last_diagnostic->next = diag;
+    }
+    lx->last_diagnostic = diag;
+
+    if (kind != DIAG_error)
+    {
+        longjmp(lx->bail, 1);
+    }
+}
+
+/**
+ * Reports the deferred diagnostics of a lexer in the order they arose,
+ * or just drops them.
+ */
+void LEXflushDiagnostics(lexer *lx, bool report)
+{
+    diagnostic *diag;
+
+    DBUG_ENTER("LEXflushDiagnostics");
+
+    while (lx->diagnostics != NULL)
+    {
+        diag = lx->diagnostics;
+        lx->diagnostics = diag->next;
+
+        if (report)
+        {
+            Report(diag->kind, diag->offset, diag->message);
+        }
+        MEMfree(diag->message);
+        MEMfree(diag);
+    }
+    lx->last_diagnostic = NULL;
+
+    DBUG_VOID_RETURN;
+}
+
+#define TOKEN(tok, len)                  \
+    lx->cursor = p + (len);              \
+    lx->offset = (int)(p - lx->base);    \
+    return (tok);
+
+/**
+ * Lexes the next token.
+ *
+ * @param lval Receives the semantic value of ID, INTVAL, FLOATVAL and
+ *             BOOLVAL tokens.
+ * @return The token, or 0 at the end of the text.
+ */
+int LEXnext(lexer *lx, union YYSTYPE *lval)
+{
+    const char *p = lx->cursor;
+    const char *end = lx->end;
+    int length;
+
+    for (;;)
+    {
+        if (p >= end)
+        {
+            lx->cursor = end;
+            return 0;
+        }
+
+        switch (*p)
+        {
+        case ' ':
+        case '\t':
+        case '\n':
+            p += SpanSpace(p, end);
+            continue;
+
+        case '(':
+            TOKEN(PARENTHESIS_L, 1);
+        case ')':
+            TOKEN(PARENTHESIS_R, 1);
+        case '{':
+            TOKEN(CURLY_L, 1);
+        case '}':
+            TOKEN(CURLY_R, 1);
+        case '[':
+            TOKEN(BRACKET_L, 1);
+        case ']':
+            TOKEN(BRACKET_R, 1);
+        case ',':
+            TOKEN(COMMA, 1);
+        case ';':
+            TOKEN(SEMICOLON, 1);
+        case '-':
+            TOKEN(MINUS, 1);
+        case '+':
+            TOKEN(PLUS, 1);
+        case '*':
+            TOKEN(STAR, 1);
+        case '%':
+            TOKEN(PERCENT, 1);
+
+        case '/':
+            if (p + 1 < end && p[1] == '/')
+            {
+                p = SkipLineComment(p + 2, end);
+                continue;
+            }
+            if (p + 1 < end && p[1] == '*')
+            {
+                p = SkipBlockComment(p, end);
+                if (p == NULL)
+                {
+                    lx->cursor = end;
+                    LEXreport(lx, DIAG_fatal, 0, "Unterminated comment");
+                }
+                continue;
+            }
+            TOKEN(SLASH, 1);
+
+        case '<':
+            if (p + 1 < end && p[1] == '=')
+            {
+                TOKEN(LE, 2);
+            }
+            TOKEN(LT, 1);
+        case '>':
+            if (p + 1 < end && p[1] == '=')
+            {
+                TOKEN(GE, 2);
+            }
+            TOKEN(GT, 1);
+        case '=':
+            if (p + 1 < end && p[1] == '=')
+            {
+                TOKEN(EQ, 2);
+            }
+            TOKEN(LET, 1);
+        case '!':
+            if (p + 1 < end && p[1] == '=')
+            {
+                TOKEN(NE, 2);
+            }
+            TOKEN(NOT, 1);
+        case '&':
+            if (p + 1 < end && p[1] == '&')
+            {
+                TOKEN(AND, 2);
+            }
+            break;
+        case '|':
+            if (p + 1 < end && p[1] == '|')
+            {
+                TOKEN(OR, 2);
+            }
+            break;
+
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case '.':
+        {
+            char buffer[64];
+            char *digits;
+            int fraction;
+
+            length = SpanDigits(p, end);
+            if (p + length + 1 < end && p[length] == '.' && IS_DIGIT(p[length + 1]))
+            {
+                fraction = SpanDigits(p + length + 1, end);
+                length += 1 + fraction;
+                digits = TokenText(p, length, buffer, sizeof(buffer));
+                lval->cflt = atof(digits);
+                if (digits != buffer)
+                {
+                    MEMfree(digits);
+                }
+                TOKEN(FLOATVAL, length);
+            }
+            if (length == 0)
+            {
+                /* A '.' not followed by a digit. */
+                break;
+            }
+
+            digits = TokenText(p, length, buffer, sizeof(buffer));
+            {
+                long integer = strtol(digits, NULL, 10);
+                if (integer < INT_MIN || integer > INT_MAX)
+                {
+                    LEXreport(lx, DIAG_error, (int)(p - lx->base), "Integer %s out of range", digits);
+                }
+            }
+            lval->cint = atoi(digits);
+            if (digits != buffer)
+            {
+                MEMfree(digits);
+            }
+            TOKEN(INTVAL, length);
+        }
+
+        default:
+            if (IS_ALPHA(*p))
+            {
+                const keyword *kw;
+
+                length = SpanIdent(p, end);
+                kw = &keywords[KEYWORD_HASH(p, length)];
+                if (kw->length == length && memcmp(kw->name, p, length) == 0)
+                {
+                    if (kw->token == BOOLVAL)
+                    {
+                        lval->cbool = kw->name[0] == 't';
+                    }
+                    TOKEN(kw->token, length);
+                }
+
+                lval->id = SRCslice(p, length);
+                TOKEN(ID, length);
+            }
+            break;
+        }
+
+        /* No rule matches: flex's default rule echoes the character. */
+        fputc(*p, stdout);
+        p++;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef _LEXER_H_
+#define _LEXER_H_
+
+#include <setjmp.h>
+
+#include "types.h"
+
+typedef enum
+{
+    DIAG_error,
+    DIAG_abort,
+    DIAG_fatal
+} diagkind;
+
+/*
+ * A diagnostic held back by a lexer that defers them, to be reported later
+ * in source order.
+ */
+typedef struct DIAGNOSTIC
+{
+    diagkind kind;
+    int offset;
+    char *message;
+    struct DIAGNOSTIC *next;
+} diagnostic;
+
+/*
+ * State of the hand-written lexer. It only ever looks at the text between
+ * cursor and end, so several lexers can work on the same source at once.
+ * The text must be followed by SRC_PADDING readable bytes. Offsets are
+ * relative to base, the start of the whole source.
+ *
+ * A deferring lexer records diagnostics instead of reporting them, and
+ * jumps to bail on aborts and fatal errors.
+ */
+typedef struct LEXER
+{
+    const char *base;
+    const char *cursor;
+    const char *end;
+    int offset;
+    bool deferring;
+    diagnostic *diagnostics;
+    diagnostic *last_diagnostic;
+    jmp_buf bail;
+} lexer;
+
+union YYSTYPE;
+
+extern void LEXinit(lexer *lx, const char *base, const char *begin, const char *end);
+extern int LEXnext(lexer *lx, union YYSTYPE *lval);
+
+extern void LEXreport(lexer *lx, diagkind kind, int offset, const char *format, ...);
+extern void LEXflushDiagnostics(lexer *lx, bool report);
+
+#endif
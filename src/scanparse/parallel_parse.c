@@ -0,0 +1,328 @@
+/*
+ * Parallel parsing of a single source file, selected with -parse-threads.
+ *
+ * A first pass runs the fast lexer over the whole source and cuts it into
+ * chunks at top-level declaration boundaries, that is after a ';' or '}'
+ * outside any curly brackets. For every cut it keeps the lexer state, so
+ * each chunk can be lexed and parsed on its own, with the same offsets as
+ * in a sequential parse. The chunks are parsed by a pool of threads and the
+ * resulting Decls lists are joined in source order.
+ *
+ * Diagnostics are deferred per chunk and reported afterwards in chunk
+ * order. If any chunk has a syntax or fatal scanner error, the input is not
+ * a valid program, and it is parsed again sequentially to report exactly
+ * what the sequential parser reports.
+ *
+ * Only the fast lexer and the recursive-descent parser are reentrant, so
+ * -parse-threads is rejected with the flex scanner or the bison parser.
+ *
+ * The state of DBUG is global and not thread safe. In debug builds the
+ * workers still run on threads of their own, with their own lexers and
+ * arena chunks, but they take turns: each parses a whole chunk holding
+ * dbug_lock. Release builds parse the chunks concurrently.
+ */
+
+#include "parallel_parse.h"
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include "civic.tab.h"
+#include "tree_basic.h"
+#include "dbug.h"
+#include "free.h"
+#include "memory.h"
+#include "globals.h"
+#include "myglobals.h"
+#include "parser.h"
+
+#define CHUNKS_PER_THREAD 4
+#define MIN_CHUNK_SIZE 16384
+
+#ifndef DBUG_OFF
+static pthread_mutex_t dbug_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+typedef struct CHUNK
+{
+    lexer lx;
+    node *decls;
+    bool failed;
+} chunk;
+
+typedef struct POOL
+{
+    chunk *chunks;
+    int count;
+    int next;
+    pthread_mutex_t lock;
+} pool;
+
+/*
+ * State of the pass that cuts the source into chunks.
+ */
+typedef struct SPLITTER
+{
+    lexer skim;
+    chunk *chunks;
+    int count;
+    int capacity;
+    int target;
+} splitter;
+
+/**
+ * Starts a new chunk at the current state of the skimming lexer.
+ */
+static void StartChunk(splitter *sp)
+{
+    chunk *grown;
+
+    if (sp->count == sp->capacity)
+    {
+        sp->capacity *= 2;
+        grown = MEMmalloc(sp->capacity * sizeof(chunk));
+        memcpy(grown, sp->chunks, sp->count * sizeof(chunk));
+        MEMfree(sp->chunks);
+        sp->chunks = grown;
+    }
+
+    sp->chunks[sp->count].lx = sp->skim;
+    sp->chunks[sp->count].lx.diagnostics = NULL;
+    sp->chunks[sp->count].lx.last_diagnostic = NULL;
+    sp->count++;
+}
+
+/**
+ * Lexes the source, starting a new chunk after every top-level declaration
+ * that ends at least target bytes after the start of the current chunk.
+ */
+static void SkimTokens(splitter *sp)
+{
+    YYSTYPE value;
+    int depth = 0;
+    int token;
+
+    while ((token = LEXnext(&sp->skim, &value)) != 0)
+    {
+        if (token == CURLY_L)
+        {
+            depth++;
+        }
+        else if (token == CURLY_R)
+        {
+            depth--;
+        }
+
+        if (depth == 0 && (token == SEMICOLON || token == CURLY_R)
+            && sp->skim.cursor < sp->skim.end
+            && sp->skim.cursor - sp->chunks[sp->count - 1].lx.cursor >= sp->target)
+        {
+            sp->chunks[sp->count - 1].lx.end = sp->skim.cursor;
+            StartChunk(sp);
+        }
+    }
+}
+
+/**
+ * Runs SkimTokens. An unterminated comment ends the skim early; the last
+ * chunk then contains it and fails to parse.
+ */
+static void Skim(splitter *sp)
+{
+    if (setjmp(sp->skim.bail) == 0)
+    {
+        SkimTokens(sp);
+    }
+}
+
+/**
+ * Cuts the source of lx into chunks of at least target bytes.
+ *
+ * @param count Set to the number of chunks.
+ * @return The chunks, with deferring lexers set up for each.
+ */
+static chunk *Split(lexer *lx, int target, int *count)
+{
+    splitter sp;
+
+    DBUG_ENTER("Split");
+
+    sp.skim = *lx;
+    sp.skim.deferring = TRUE;
+    sp.skim.diagnostics = NULL;
+    sp.skim.last_diagnostic = NULL;
+    sp.capacity = 16;
+    sp.chunks = MEMmalloc(sp.capacity * sizeof(chunk));
+    sp.count = 0;
+    sp.target = target;
+
+    StartChunk(&sp);
+    Skim(&sp);
+
+    sp.chunks[sp.count - 1].lx.end = lx->end;
+    LEXflushDiagnostics(&sp.skim, FALSE);
+
+    *count = sp.count;
+
+    DBUG_RETURN(sp.chunks);
+}
+
+/**
+ * Parses one chunk, noting instead of reporting a syntax or fatal error.
+ */
+static void ParseChunk(chunk *c)
+{
+    c->decls = NULL;
+    c->failed = FALSE;
+
+    if (setjmp(c->lx.bail) == 0)
+    {
+        c->decls = RDPparseDecls(&c->lx);
+    }
+    else
+    {
+        parse_offset = NULL;
+        c->failed = TRUE;
+    }
+}
+
+/**
+ * Takes chunks from the pool and parses them until none are left.
+ */
+static void *Worker(void *arg)
+{
+    pool *pl = arg;
+    int i;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&pl->lock);
+        i = pl->next++;
+        pthread_mutex_unlock(&pl->lock);
+
+        if (i >= pl->count)
+        {
+            break;
+        }
+
+#ifndef DBUG_OFF
+        pthread_mutex_lock(&dbug_lock);
+#endif
+        ParseChunk(&pl->chunks[i]);
+#ifndef DBUG_OFF
+        pthread_mutex_unlock(&dbug_lock);
+#endif
+    }
+
+    return NULL;
+}
+
+/**
+ * Parses the chunks of the pool on up to threads threads, including the
+ * calling one.
+ */
+static void RunPool(pool *pl, int threads)
+{
+    pthread_t *ids;
+    int started = 0;
+    int i;
+
+    if (threads > pl->count)
+    {
+        threads = pl->count;
+    }
+
+    ids = MEMmalloc(threads * sizeof(pthread_t));
+    for (i = 1; i < threads; i++)
+    {
+        if (pthread_create(&ids[started], NULL, Worker, pl) == 0)
+        {
+            started++;
+        }
+    }
+
+    Worker(pl);
+
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(ids[i], NULL);
+    }
+    MEMfree(ids);
+}
+
+/**
+ * Parses a whole program, splitting it over several threads if it is large
+ * enough.
+ *
+ * @param lx Fast lexer positioned at the start of the source.
+ * @param threads Maximum number of threads to use.
+ * @return The Program node.
+ */
+node *PRLparseProgram(lexer *lx, int threads)
+{
+    pool pl;
+    node *decls;
+    node *program;
+    bool failed = FALSE;
+    int target;
+    int i;
+
+    DBUG_ENTER("PRLparseProgram");
+
+    target = (int)(lx->end - lx->cursor) / (threads * CHUNKS_PER_THREAD);
+    if (target < MIN_CHUNK_SIZE)
+    {
+        target = MIN_CHUNK_SIZE;
+    }
+
+    pl.chunks = Split(lx, target, &pl.count);
+    pl.next = 0;
+
+    if (pl.count == 1)
+    {
+        MEMfree(pl.chunks);
+        DBUG_RETURN(RDPparseProgram(lx));
+    }
+
+    pthread_mutex_init(&pl.lock, NULL);
+    RunPool(&pl, threads);
+    pthread_mutex_destroy(&pl.lock);
+
+    for (i = 0; i < pl.count; i++)
+    {
+        failed = failed || pl.chunks[i].failed;
+    }
+
+    for (i = 0; i < pl.count; i++)
+    {
+        LEXflushDiagnostics(&pl.chunks[i].lx, !failed);
+    }
+
+    if (failed)
+    {
+        /* Reports the first error exactly as the sequential parser does. */
+        MEMfree(pl.chunks);
+        DBUG_RETURN(RDPparseProgram(lx));
+    }
+
+    decls = pl.chunks[0].decls;
+
+    for (i = 1; i < pl.count; i++)
+    {
+        TBsplice(decls, DECLS_COUNT(decls), pl.chunks[i].decls);
+        FREEdoFreeTree(pl.chunks[i].decls);
+    }
+
+    *lx = pl.chunks[pl.count - 1].lx;
+    lx->deferring = FALSE;
+    MEMfree(pl.chunks);
+
+    parse_offset = &lx->offset;
+    program = TBmakeProgram(decls, NULL);
+    parse_offset = NULL;
+
+    global.line = lx->offset;
+
+    DBUG_RETURN(program);
+}
@@ -0,0 +1,9 @@
+#ifndef _PARALLEL_PARSE_H_
+#define _PARALLEL_PARSE_H_
+
+#include "types.h"
+#include "lexer.h"
+
+extern node *PRLparseProgram(lexer *lx, int threads);
+
+#endif
@@ -0,0 +1,736 @@
+/*
+ * Recursive-descent parser for CiviC, selected with -parser=rd.
+ *
+ * It builds the same tree as the bison grammar in civic.y. Statements and
+ * declarations are parsed top-down; expressions are parsed by precedence
+ * climbing with the operator precedences and associativities civic.y
+ * declares. Tokens come from the fast lexer when one is given, otherwise
+ * from the flex scanner.
+ *
+ * With the fast lexer the parser is reentrant: positions are taken from the
+ * lexer instead of global.line, and diagnostics go through
+ * the lexer, which may defer them.
+ */
+
+#include "parser.h"
+
+#include "civic.tab.h"
+#include "tree_basic.h"
+#include "dbug.h"
+#include "ctinfo.h"
+#include "globals.h"
+#include "myglobals.h"
+#include "location.h"
+#include "source.h"
+
+extern int YYflexLex(void);
+
+/*
+ * Binding powers of the binary operators. Unary minus takes an operand of
+ * multiplicative precedence, as it shares its precedence with binary minus
+ * in civic.y; '!' and casts bind tighter than any binary operator.
+ */
+#define PREC_NONE 0
+#define PREC_OR 1
+#define PREC_AND 2
+#define PREC_EQUALITY 3
+#define PREC_RELATIONAL 4
+#define PREC_ADDITIVE 5
+#define PREC_MULTIPLICATIVE 6
+#define PREC_UNARY 7
+
+/*
+ * Parser state: the token source and up to two tokens of lookahead, which
+ * are only read when a decision needs them.
+ */
+typedef struct PARSER
+{
+    lexer *lx;
+    int count;
+    int token[2];
+    YYSTYPE value[2];
+} parser;
+
+static node *ParseExpr(parser *ps, int min_prec);
+static node *ParseStmt(parser *ps);
+
+static void SyntaxError(parser *ps)
+{
+    if (ps->lx != NULL)
+    {
+        LEXreport(ps->lx, DIAG_abort, ps->lx->offset, "Error parsing source code: %s\n",
+                  "syntax error");
+    }
+    else
+    {
+        CTIabort("line %d, col %d\nError parsing source code: %s\n",
+                 LOCline(global.line), LOCcol(global.line), "syntax error");
+    }
+}
+
+/**
+ * Appends the next token of the input to the lookahead buffer.
+ */
+static void Fetch(parser *ps)
+{
+    int i = ps->count;
+
+    if (ps->lx != NULL)
+    {
+        ps->token[i] = LEXnext(ps->lx, &ps->value[i]);
+    }
+    else
+    {
+        ps->token[i] = YYflexLex();
+        ps->value[i] = yylval;
+    }
+
+    ps->count++;
+}
+
+/**
+ * @return The current token.
+ */
+static int Peek(parser *ps)
+{
+    if (ps->count == 0)
+    {
+        Fetch(ps);
+    }
+
+    return ps->token[0];
+}
+
+/**
+ * @return The token after the current one.
+ */
+static int PeekSecond(parser *ps)
+{
+    while (ps->count < 2)
+    {
+        Fetch(ps);
+    }
+
+    return ps->token[1];
+}
+
+/**
+ * Consumes the current token.
+ *
+ * @return Its semantic value.
+ */
+static YYSTYPE Take(parser *ps)
+{
+    YYSTYPE value;
+
+    Peek(ps);
+    value = ps->value[0];
+    ps->token[0] = ps->token[1];
+    ps->value[0] = ps->value[1];
+    ps->count--;
+
+    return value;
+}
+
+/**
+ * Consumes the current token, which must be the given one.
+ */
+static YYSTYPE Expect(parser *ps, int token)
+{
+    if (Peek(ps) != token)
+    {
+        SyntaxError(ps);
+    }
+
+    return Take(ps);
+}
+
+/**
+ * Consumes the current token if it is the given one.
+ *
+ * @return TRUE if the token was consumed.
+ */
+static bool Accept(parser *ps, int token)
+{
+    if (Peek(ps) != token)
+    {
+        return FALSE;
+    }
+
+    Take(ps);
+    return TRUE;
+}
+
+static bool IsType(int token)
+{
+    return token == INT || token == FLOAT || token == BOOL || token == VOID;
+}
+
+static char *ExpectName(parser *ps)
+{
+    return SRCsliceName(Expect(ps, ID).id);
+}
+
+static type ParseType(parser *ps)
+{
+    switch (Peek(ps))
+    {
+    case INT:
+        Take(ps);
+        return T_int;
+    case FLOAT:
+        Take(ps);
+        return T_float;
+    case BOOL:
+        Take(ps);
+        return T_bool;
+    case VOID:
+        Take(ps);
+        return T_void;
+    default:
+        SyntaxError(ps);
+        return T_unknown;
+    }
+}
+
+/**
+ * Looks up a token as a binary operator.
+ *
+ * @param op Set to the operator if the token is one.
+ * @return The operator's binding power, PREC_NONE for other tokens.
+ */
+static int InfixPrecedence(int token, binop *op)
+{
+    switch (token)
+    {
+    case OR:
+        *op = BO_or;
+        return PREC_OR;
+    case AND:
+        *op = BO_and;
+        return PREC_AND;
+    case EQ:
+        *op = BO_eq;
+        return PREC_EQUALITY;
+    case NE:
+        *op = BO_ne;
+        return PREC_EQUALITY;
+    case LE:
+        *op = BO_le;
+        return PREC_RELATIONAL;
+    case LT:
+        *op = BO_lt;
+        return PREC_RELATIONAL;
+    case GE:
+        *op = BO_ge;
+        return PREC_RELATIONAL;
+    case GT:
+        *op = BO_gt;
+        return PREC_RELATIONAL;
+    case PLUS:
+        *op = BO_add;
+        return PREC_ADDITIVE;
+    case MINUS:
+        *op = BO_sub;
+        return PREC_ADDITIVE;
+    case STAR:
+        *op = BO_mul;
+        return PREC_MULTIPLICATIVE;
+    case SLASH:
+        *op = BO_div;
+        return PREC_MULTIPLICATIVE;
+    case PERCENT:
+        *op = BO_mod;
+        return PREC_MULTIPLICATIVE;
+    default:
+        return PREC_NONE;
+    }
+}
+
+/**
+ * exprs: expr [, expr]*
+ */
+static node *ParseExprs(parser *ps)
+{
+    node *exprs;
+
+    DBUG_ENTER("ParseExprs");
+
+    exprs = TBappend(TBmakeExprs(), ParseExpr(ps, PREC_OR));
+
+    while (Accept(ps, COMMA))
+    {
+        TBappend(exprs, ParseExpr(ps, PREC_OR));
+    }
+
+    DBUG_RETURN(exprs);
+}
+
+/**
+ * Parses an operand: a constant, variable, function call, parenthesised
+ * expression, cast or unary operation.
+ */
+static node *ParsePrefix(parser *ps)
+{
+    node *result = NULL;
+    node *args;
+    char *name;
+    type cast_type;
+
+    DBUG_ENTER("ParsePrefix");
+
+    switch (Peek(ps))
+    {
+    case INTVAL:
+        result = TBmakeNum(Take(ps).cint);
+        break;
+
+    case FLOATVAL:
+        result = TBmakeFloat(Take(ps).cflt);
+        break;
+
+    case BOOLVAL:
+        result = TBmakeBool(Take(ps).cbool);
+        break;
+
+    case ID:
+        name = SRCsliceName(Take(ps).id);
+        if (Accept(ps, PARENTHESIS_L))
+        {
+            args = Peek(ps) == PARENTHESIS_R ? NULL : ParseExprs(ps);
+            Expect(ps, PARENTHESIS_R);
+            result = TBmakeFuncall(name, NULL, args);
+        }
+        else
+        {
+            result = TBmakeVar(name, NULL, NULL);
+        }
+        break;
+
+    case PARENTHESIS_L:
+        Take(ps);
+        if (IsType(Peek(ps)))
+        {
+            cast_type = ParseType(ps);
+            Expect(ps, PARENTHESIS_R);
+            result = TBmakeCast(cast_type, ParseExpr(ps, PREC_UNARY));
+        }
+        else
+        {
+            result = ParseExpr(ps, PREC_OR);
+            Expect(ps, PARENTHESIS_R);
+        }
+        break;
+
+    case MINUS:
+        Take(ps);
+        result = TBmakeMonop(MO_neg, ParseExpr(ps, PREC_MULTIPLICATIVE));
+        break;
+
+    case NOT:
+        Take(ps);
+        result = TBmakeMonop(MO_not, ParseExpr(ps, PREC_UNARY));
+        break;
+
+    default:
+        SyntaxError(ps);
+        break;
+    }
+
+    DBUG_RETURN(result);
+}
+
+/**
+ * Parses an expression whose binary operators all bind at least as tightly
+ * as min_prec. Operators of equal precedence associate to the left.
+ */
+static node *ParseExpr(parser *ps, int min_prec)
+{
+    node *left;
+    binop op;
+    int prec;
+
+    DBUG_ENTER("ParseExpr");
+
+    left = ParsePrefix(ps);
+
+    for (;;)
+    {
+        prec = InfixPrecedence(Peek(ps), &op);
+        if (prec == PREC_NONE || prec < min_prec)
+        {
+            break;
+        }
+
+        Take(ps);
+        left = TBmakeBinop(op, left, ParseExpr(ps, prec + 1));
+    }
+
+    DBUG_RETURN(left);
+}
+
+/**
+ * stmts: stmt+, up to the closing curly bracket of the enclosing body.
+ */
+static node *ParseStmts(parser *ps)
+{
+    node *stmts;
+
+    DBUG_ENTER("ParseStmts");
+
+    stmts = TBappend(TBmakeStmts(), ParseStmt(ps));
+
+    while (Peek(ps) != CURLY_R)
+    {
+        TBappend(stmts, ParseStmt(ps));
+    }
+
+    DBUG_RETURN(stmts);
+}
+
+/**
+ * block: { } | { stmts } | stmt
+ */
+static node *ParseBlock(parser *ps)
+{
+    node *block;
+
+    DBUG_ENTER("ParseBlock");
+
+    if (Accept(ps, CURLY_L))
+    {
+        block = Peek(ps) == CURLY_R ? NULL : ParseStmts(ps);
+        Expect(ps, CURLY_R);
+    }
+    else
+    {
+        block = TBappend(TBmakeStmts(), ParseStmt(ps));
+    }
+
+    DBUG_RETURN(block);
+}
+
+static node *ParseStmt(parser *ps)
+{
+    node *stmt;
+    node *cond;
+    node *block;
+    node *start;
+    node *stop;
+    node *step;
+    node *varlet;
+    char *name;
+
+    DBUG_ENTER("ParseStmt");
+
+    switch (Peek(ps))
+    {
+    case IF:
+        Take(ps);
+        Expect(ps, PARENTHESIS_L);
+        cond = ParseExpr(ps, PREC_OR);
+        Expect(ps, PARENTHESIS_R);
+        block = ParseBlock(ps);
+        stmt = TBmakeIfelse(cond, block, Accept(ps, ELSE) ? ParseBlock(ps) : NULL);
+        break;
+
+    case WHILE:
+        Take(ps);
+        Expect(ps, PARENTHESIS_L);
+        cond = ParseExpr(ps, PREC_OR);
+        Expect(ps, PARENTHESIS_R);
+        stmt = TBmakeWhile(cond, ParseBlock(ps));
+        break;
+
+    case DO:
+        Take(ps);
+        block = ParseBlock(ps);
+        Expect(ps, WHILE);
+        Expect(ps, PARENTHESIS_L);
+        cond = ParseExpr(ps, PREC_OR);
+        Expect(ps, PARENTHESIS_R);
+        Expect(ps, SEMICOLON);
+        stmt = TBmakeDowhile(cond, block);
+        break;
+
+    case FOR:
+        Take(ps);
+        Expect(ps, PARENTHESIS_L);
+        Expect(ps, INT);
+        name = ExpectName(ps);
+        Expect(ps, LET);
+        start = ParseExpr(ps, PREC_OR);
+        Expect(ps, COMMA);
+        stop = ParseExpr(ps, PREC_OR);
+        step = Accept(ps, COMMA) ? ParseExpr(ps, PREC_OR) : NULL;
+        Expect(ps, PARENTHESIS_R);
+        stmt = TBmakeFor(name, start, stop, step, ParseBlock(ps));
+        break;
+
+    case RETURN:
+        Take(ps);
+        stmt = TBmakeReturn(Peek(ps) == SEMICOLON ? NULL : ParseExpr(ps, PREC_OR));
+        Expect(ps, SEMICOLON);
+        break;
+
+    case ID:
+        if (PeekSecond(ps) == LET)
+        {
+            varlet = TBmakeVarlet(ExpectName(ps), NULL, NULL);
+            Take(ps);
+            stmt = TBmakeAssign(varlet, ParseExpr(ps, PREC_OR));
+            Expect(ps, SEMICOLON);
+            break;
+        }
+        /* Otherwise an expression statement starting with a name. */
+
+    default:
+        stmt = TBmakeExprstmt(ParseExpr(ps, PREC_OR));
+        Expect(ps, SEMICOLON);
+        break;
+    }
+
+    DBUG_RETURN(stmt);
+}
+
+/**
+ * funbody: vardecl* stmts?
+ */
+static node *ParseFunbody(parser *ps)
+{
+    node *vardecls = NULL;
+    node *last = NULL;
+    node *vardecl;
+    node *init;
+    char *name;
+    type decl_type;
+
+    DBUG_ENTER("ParseFunbody");
+
+    while (IsType(Peek(ps)))
+    {
+        decl_type = ParseType(ps);
+        name = ExpectName(ps);
+        init = Accept(ps, LET) ? ParseExpr(ps, PREC_OR) : NULL;
+        Expect(ps, SEMICOLON);
+
+        vardecl = TBmakeVardecl(name, decl_type, NULL, init, NULL);
+        if (last == NULL)
+        {
+            vardecls = vardecl;
+        }
+        else
+        {
+            L_VARDECL_NEXT(last, vardecl);
+        }
+        last = vardecl;
+    }
+
+    DBUG_RETURN(TBmakeFunbody(vardecls, NULL,
+                              Peek(ps) == CURLY_R ? NULL : ParseStmts(ps)));
+}
+
+/**
+ * params: type ID [, type ID]*
+ */
+static node *ParseParams(parser *ps)
+{
+    node *params = NULL;
+    node *last = NULL;
+    node *param;
+    type param_type;
+
+    DBUG_ENTER("ParseParams");
+
+    do
+    {
+        param_type = ParseType(ps);
+        param = TBmakeParam(ExpectName(ps), param_type, NULL, NULL);
+        if (last == NULL)
+        {
+            params = param;
+        }
+        else
+        {
+            L_PARAM_NEXT(last, param);
+        }
+        last = param;
+    } while (Accept(ps, COMMA));
+
+    DBUG_RETURN(params);
+}
+
+/**
+ * Parses the parenthesised parameter list of a function.
+ */
+static node *ParseParamList(parser *ps)
+{
+    node *params;
+
+    DBUG_ENTER("ParseParamList");
+
+    Expect(ps, PARENTHESIS_L);
+    params = Peek(ps) == PARENTHESIS_R ? NULL : ParseParams(ps);
+    Expect(ps, PARENTHESIS_R);
+
+    DBUG_RETURN(params);
+}
+
+/**
+ * Parses a function or global variable definition: type ID followed by
+ * either a parameter list and body or an optional initialisation.
+ */
+static node *ParseDefinition(parser *ps)
+{
+    node *def;
+    node *params;
+    node *body;
+    node *init;
+    char *name;
+    type def_type;
+
+    DBUG_ENTER("ParseDefinition");
+
+    def_type = ParseType(ps);
+    name = ExpectName(ps);
+
+    if (Peek(ps) == PARENTHESIS_L)
+    {
+        params = ParseParamList(ps);
+        Expect(ps, CURLY_L);
+        body = ParseFunbody(ps);
+        Expect(ps, CURLY_R);
+        def = TBmakeFundef(def_type, name, body, params);
+    }
+    else
+    {
+        init = Accept(ps, LET) ? ParseExpr(ps, PREC_OR) : NULL;
+        Expect(ps, SEMICOLON);
+        def = TBmakeGlobdef(def_type, name, NULL, init);
+    }
+
+    DBUG_RETURN(def);
+}
+
+static node *ParseDecl(parser *ps)
+{
+    node *decl;
+    node *params;
+    char *name;
+    type decl_type;
+
+    DBUG_ENTER("ParseDecl");
+
+    if (Accept(ps, EXTERN))
+    {
+        decl_type = ParseType(ps);
+        name = ExpectName(ps);
+
+        if (Peek(ps) == PARENTHESIS_L)
+        {
+            params = ParseParamList(ps);
+            Expect(ps, SEMICOLON);
+            decl = TBmakeFundecl(decl_type, name, params);
+        }
+        else
+        {
+            Expect(ps, SEMICOLON);
+            decl = TBmakeGlobdecl(decl_type, name, NULL);
+        }
+    }
+    else if (Accept(ps, EXPORT))
+    {
+        decl = ParseDefinition(ps);
+
+        if (NODE_TYPE(decl) == N_fundef)
+        {
+            FUNDEF_ISEXPORT(decl) = 1;
+        }
+        else
+        {
+            GLOBDEF_ISEXPORT(decl) = 1;
+        }
+    }
+    else
+    {
+        decl = ParseDefinition(ps);
+    }
+
+    DBUG_RETURN(decl);
+}
+
+/**
+ * decls: decl+, up to the end of the input.
+ */
+static node *ParseDecls(parser *ps)
+{
+    node *decls;
+
+    DBUG_ENTER("ParseDecls");
+
+    decls = TBappend(TBmakeDecls(), ParseDecl(ps));
+
+    while (Peek(ps) != 0)
+    {
+        TBappend(decls, ParseDecl(ps));
+    }
+
+    DBUG_RETURN(decls);
+}
+
+/**
+ * Parses a whole program.
+ *
+ * @param lx Fast lexer positioned at the start of the source, or NULL to
+ *           read tokens from the flex scanner.
+ * @return The Program node.
+ */
+node *RDPparseProgram(lexer *lx)
+{
+    parser ps;
+    node *program;
+
+    DBUG_ENTER("RDPparseProgram");
+
+    ps.lx = lx;
+    ps.count = 0;
+
+    if (lx != NULL)
+    {
+        parse_offset = &lx->offset;
+    }
+
+    program = TBmakeProgram(ParseDecls(&ps), NULL);
+
+    if (lx != NULL)
+    {
+        parse_offset = NULL;
+        global.line = lx->offset;
+    }
+
+    DBUG_RETURN(program);
+}
+
+/**
+ * Parses the declarations between the lexer's cursor and its end. Safe to
+ * run on several threads at once, each with its own lexer.
+ *
+ * @param lx Fast lexer delimiting a run of whole declarations.
+ * @return The Decls list.
+ */
+node *RDPparseDecls(lexer *lx)
+{
+    parser ps;
+    node *decls;
+
+    DBUG_ENTER("RDPparseDecls");
+
+    ps.lx = lx;
+    ps.count = 0;
+
+    parse_offset = &lx->offset;
+    decls = ParseDecls(&ps);
+    parse_offset = NULL;
+
+    DBUG_RETURN(decls);
+}
@@ -0,0 +1,10 @@
+#ifndef _PARSER_H_
+#define _PARSER_H_
+
+#include "types.h"
+#include "lexer.h"
+
+extern node *RDPparseProgram(lexer *lx);
+extern node *RDPparseDecls(lexer *lx);
+
+#endif
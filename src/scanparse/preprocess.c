@@ -0,0 +1,1221 @@
+/*
+ * Built-in preprocessor, run on the input before scanning unless -cpp=none
+ * is given. It supports #include, object-like #define and #undef, and
+ * conditional compilation with #if, #ifdef, #ifndef, #elif, #else and
+ * #endif, which is all CiviC headers need.
+ *
+ * The output replaces the source text in memory; no temporary files or
+ * processes are involved. Comments are removed, lines that produce no text
+ * are dropped, and the line in the original file of every output line is
+ * handed to the location module for diagnostics.
+ *
+ * Included files are cached for the whole run by their real path, and
+ * reused as long as their modification time and size do not change. A
+ * header that turns out to be wrapped in an include guard is not even
+ * opened again once its guard macro is defined. A header with an up to date
+ * precompiled version is not read at all; its declarations are loaded by
+ * context analysis instead.
+ */
+
+#include "preprocess.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "ctinfo.h"
+#include "dbug.h"
+#include "location.h"
+#include "memory.h"
+#include "myglobals.h"
+#include "precompiled_header.h"
+#include "source.h"
+
+#define MACRO_BUCKETS 256
+#define MAX_INCLUDE_DEPTH 200
+
+#define IS_ALPHA(c) (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') || (c) == '_')
+#define IS_DIGIT(c) ((c) >= '0' && (c) <= '9')
+#define IS_IDENT(c) (IS_ALPHA(c) || IS_DIGIT(c))
+#define IS_BLANK(c) ((c) == ' ' || (c) == '\t' || (c) == '\r' || (c) == '\f' || (c) == '\v')
+
+typedef struct BUFFER
+{
+    char *text;
+    int size;
+    int capacity;
+} buffer;
+
+typedef struct MACRO
+{
+    char *name;
+    int length;
+    char *body;
+    int body_length;
+    struct MACRO *next;
+} macro;
+
+/*
+ * Macros being expanded, which are not expanded again inside themselves.
+ */
+typedef struct ACTIVE
+{
+    const macro *expanding;
+    const struct ACTIVE *next;
+} active;
+
+/*
+ * A cached include file. The cache lives as long as the process, so
+ * several compilations in one run share it.
+ */
+typedef struct HEADER
+{
+    char *path;
+    time_t mtime;
+    off_t size;
+    char *text;
+    int length;
+    char *guard;
+    struct HEADER *next;
+} header;
+
+static header *headers = NULL;
+
+/*
+ * State of an #if group: whether its enclosing group is active, whether
+ * the current branch is, and whether any branch was taken already.
+ */
+typedef struct CONDITIONAL
+{
+    bool outer;
+    bool active;
+    bool taken;
+    bool seen_else;
+    int line;
+} conditional;
+
+typedef enum
+{
+    GUARD_start,
+    GUARD_open,
+    GUARD_closed,
+    GUARD_none
+} guardstate;
+
+/*
+ * A file being preprocessed. The guard fields track whether everything in
+ * it is inside a single #ifndef group.
+ */
+typedef struct FRAME
+{
+    const char *filename;
+    const char *cursor;
+    const char *end;
+    int line;
+    bool in_comment;
+    int base;
+    guardstate guard_state;
+    char *guard;
+} frame;
+
+typedef struct PREPROCESSOR
+{
+    buffer out;
+    int *starts;
+    int *lines;
+    int line_count;
+    int line_capacity;
+    buffer line;
+    macro *macros[MACRO_BUCKETS];
+    conditional *conds;
+    int cond_count;
+    int cond_capacity;
+    int depth;
+} preprocessor;
+
+static void ProcessFile(preprocessor *pp, frame *fr);
+
+/**
+ * Makes room for extra more bytes in b.
+ */
+static void Reserve(buffer *b, int extra)
+{
+    char *grown;
+
+    if (b->size + extra <= b->capacity)
+    {
+        return;
+    }
+
+    b->capacity = b->capacity == 0 ? 256 : b->capacity;
+    while (b->size + extra > b->capacity)
+    {
+        b->capacity *= 2;
+    }
+
+    grown = MEMmalloc(b->capacity);
+    if (b->text != NULL)
+    {
+        memcpy(grown, b->text, b->size);
+        MEMfree(b->text);
+    }
+    b->text = grown;
+}
+
+static void Append(buffer *b, const char *p, int length)
+{
+    Reserve(b, length);
+    memcpy(b->text + b->size, p, length);
+    b->size += length;
+}
+
+/**
+ * Records that an output line for the given line of the input starts here.
+ */
+static void BeginLine(preprocessor *pp, int line)
+{
+    int *grown;
+
+    if (pp->line_count == pp->line_capacity)
+    {
+        pp->line_capacity = pp->line_capacity == 0 ? 1024 : 2 * pp->line_capacity;
+
+        grown = MEMmalloc(pp->line_capacity * sizeof(int));
+        if (pp->starts != NULL)
+        {
+            memcpy(grown, pp->starts, pp->line_count * sizeof(int));
+            MEMfree(pp->starts);
+        }
+        pp->starts = grown;
+
+        grown = MEMmalloc(pp->line_capacity * sizeof(int));
+        if (pp->lines != NULL)
+        {
+            memcpy(grown, pp->lines, pp->line_count * sizeof(int));
+            MEMfree(pp->lines);
+        }
+        pp->lines = grown;
+    }
+
+    pp->starts[pp->line_count] = pp->out.size;
+    pp->lines[pp->line_count] = line;
+    pp->line_count++;
+}
+
+/**
+ * FNV-1a hash of a macro name.
+ */
+static unsigned int Hash(const char *name, int length)
+{
+    unsigned int hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+
+    return hash % MACRO_BUCKETS;
+}
+
+static macro *FindMacro(preprocessor *pp, const char *name, int length)
+{
+    macro *m;
+
+    for (m = pp->macros[Hash(name, length)]; m != NULL; m = m->next)
+    {
+        if (m->length == length && memcmp(m->name, name, length) == 0)
+        {
+            return m;
+        }
+    }
+
+    return NULL;
+}
+
+static char *Copy(const char *p, int length)
+{
+    char *result = MEMmalloc(length + 1);
+
+    memcpy(result, p, length);
+    result[length] = '\0';
+
+    return result;
+}
+
+static void Define(preprocessor *pp, const char *name, int length, const char *body,
+                   int body_length)
+{
+    macro *m = FindMacro(pp, name, length);
+    unsigned int bucket;
+
+    if (m == NULL)
+    {
+        bucket = Hash(name, length);
+        m = MEMmalloc(sizeof(macro));
+        m->name = Copy(name, length);
+        m->length = length;
+        m->next = pp->macros[bucket];
+        pp->macros[bucket] = m;
+    }
+    else
+    {
+        MEMfree(m->body);
+    }
+
+    m->body = Copy(body, body_length);
+    m->body_length = body_length;
+}
+
+static void Undefine(preprocessor *pp, const char *name, int length)
+{
+    macro **link = &pp->macros[Hash(name, length)];
+    macro *m;
+
+    while ((m = *link) != NULL)
+    {
+        if (m->length == length && memcmp(m->name, name, length) == 0)
+        {
+            *link = m->next;
+            MEMfree(m->name);
+            MEMfree(m->body);
+            MEMfree(m);
+            return;
+        }
+        link = &m->next;
+    }
+}
+
+static bool IsExpanding(const active *act, const macro *m)
+{
+    for (; act != NULL; act = act->next)
+    {
+        if (act->expanding == m)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Appends text to dst with all macros replaced. Replacements are padded
+ * with spaces, so they never merge with the surrounding tokens.
+ */
+static void Expand(preprocessor *pp, const char *p, int length, const active *act, buffer *dst)
+{
+    const char *end = p + length;
+    const char *q;
+    active inner;
+    macro *m;
+
+    while (p < end)
+    {
+        q = p + 1;
+
+        if (IS_ALPHA(*p))
+        {
+            while (q < end && IS_IDENT(*q))
+            {
+                q++;
+            }
+
+            m = FindMacro(pp, p, (int)(q - p));
+            if (m != NULL && !IsExpanding(act, m))
+            {
+                inner.expanding = m;
+                inner.next = act;
+                Append(dst, " ", 1);
+                Expand(pp, m->body, m->body_length, &inner, dst);
+                Append(dst, " ", 1);
+                p = q;
+                continue;
+            }
+        }
+        else if (IS_DIGIT(*p) || (*p == '.' && q < end && IS_DIGIT(*q)))
+        {
+            /* A number, whose suffix must not be taken for a macro. */
+            while (q < end && (IS_IDENT(*q) || *q == '.'))
+            {
+                q++;
+            }
+        }
+        else
+        {
+            while (q < end && !IS_IDENT(*q) && *q != '.')
+            {
+                q++;
+            }
+        }
+
+        Append(dst, p, (int)(q - p));
+        p = q;
+    }
+}
+
+/**
+ * Appends the part of a line between p and end to dst, with every comment
+ * replaced by a space. Block comments may continue on following lines.
+ */
+static void StripComments(frame *fr, const char *p, const char *end, buffer *dst)
+{
+    const char *q;
+
+    while (p < end)
+    {
+        if (fr->in_comment)
+        {
+            for (q = p; q + 1 < end && !(q[0] == '*' && q[1] == '/'); q++)
+            {
+            }
+
+            if (q + 1 < end)
+            {
+                fr->in_comment = FALSE;
+                Append(dst, " ", 1);
+                p = q + 2;
+            }
+            else
+            {
+                p = end;
+            }
+        }
+        else if (*p == '/' && p + 1 < end && p[1] == '/')
+        {
+            p = end;
+        }
+        else if (*p == '/' && p + 1 < end && p[1] == '*')
+        {
+            fr->in_comment = TRUE;
+            p += 2;
+        }
+        else
+        {
+            q = p + 1 < end ? memchr(p + 1, '/', end - p - 1) : NULL;
+            q = q == NULL ? end : q;
+            Append(dst, p, (int)(q - p));
+            p = q;
+        }
+    }
+}
+
+static const char *SkipBlanks(const char *p, const char *end)
+{
+    while (p < end && IS_BLANK(*p))
+    {
+        p++;
+    }
+
+    return p;
+}
+
+static const char *SkipIdent(const char *p, const char *end)
+{
+    while (p < end && IS_IDENT(*p))
+    {
+        p++;
+    }
+
+    return p;
+}
+
+static bool IsBlankText(const char *p, const char *end)
+{
+    return SkipBlanks(p, end) == end;
+}
+
+/*
+ * Evaluation of #if expressions, after macro expansion and replacement of
+ * defined. Identifiers that remain evaluate to 0.
+ */
+typedef struct EVALUATOR
+{
+    const char *p;
+    const char *end;
+    bool error;
+} evaluator;
+
+/*
+ * Binary operators with their precedence. Two-character operators come
+ * first, so they are matched before their one-character prefixes.
+ */
+static const struct
+{
+    const char *op;
+    int prec;
+} binary_ops[] = {
+    {"||", 1}, {"&&", 2}, {"==", 6}, {"!=", 6}, {"<=", 7}, {">=", 7}, {"<<", 8},
+    {">>", 8}, {"|", 3},  {"^", 4},  {"&", 5},  {"<", 7},  {">", 7},  {"+", 9},
+    {"-", 9},  {"*", 10}, {"/", 10}, {"%", 10},
+};
+
+static long EvalConditional(evaluator *ev);
+
+static bool Accept(evaluator *ev, const char *op)
+{
+    int length = (int)strlen(op);
+
+    ev->p = SkipBlanks(ev->p, ev->end);
+    if (ev->end - ev->p >= length && memcmp(ev->p, op, length) == 0)
+    {
+        ev->p += length;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * Reads a decimal, octal or hexadecimal literal. The expression buffer is
+ * not NUL-terminated, so the digits are bounded by ev->end rather than
+ * handed to strtol.
+ */
+static long EvalNumber(evaluator *ev)
+{
+    unsigned long value = 0;
+    int base = 10;
+    int digit;
+
+    if (*ev->p == '0')
+    {
+        ev->p++;
+        base = 8;
+        if (ev->p < ev->end && (*ev->p == 'x' || *ev->p == 'X'))
+        {
+            ev->p++;
+            base = 16;
+        }
+    }
+
+    for (; ev->p < ev->end; ev->p++)
+    {
+        if (IS_DIGIT(*ev->p))
+        {
+            digit = *ev->p - '0';
+        }
+        else if (base == 16 && *ev->p >= 'a' && *ev->p <= 'f')
+        {
+            digit = *ev->p - 'a' + 10;
+        }
+        else if (base == 16 && *ev->p >= 'A' && *ev->p <= 'F')
+        {
+            digit = *ev->p - 'A' + 10;
+        }
+        else
+        {
+            break;
+        }
+
+        if (digit >= base)
+        {
+            ev->error = TRUE;
+            break;
+        }
+        value = value * base + digit;
+    }
+
+    /* Integer suffixes such as 1L or 1u. */
+    ev->p = SkipIdent(ev->p, ev->end);
+    return (long)value;
+}
+
+static long EvalPrimary(evaluator *ev)
+{
+    long value;
+
+    if (Accept(ev, "("))
+    {
+        value = EvalConditional(ev);
+        if (!Accept(ev, ")"))
+        {
+            ev->error = TRUE;
+        }
+        return value;
+    }
+    if (Accept(ev, "!"))
+    {
+        return !EvalPrimary(ev);
+    }
+    if (Accept(ev, "~"))
+    {
+        return ~EvalPrimary(ev);
+    }
+    if (Accept(ev, "-"))
+    {
+        return -EvalPrimary(ev);
+    }
+    if (Accept(ev, "+"))
+    {
+        return EvalPrimary(ev);
+    }
+
+    if (ev->p < ev->end && IS_DIGIT(*ev->p))
+    {
+        return EvalNumber(ev);
+    }
+    if (ev->p < ev->end && IS_ALPHA(*ev->p))
+    {
+        ev->p = SkipIdent(ev->p, ev->end);
+        return 0;
+    }
+
+    ev->error = TRUE;
+    return 0;
+}
+
+static long Apply(evaluator *ev, const char *op, long left, long right)
+{
+    switch (op[0])
+    {
+    case '|':
+        return op[1] == '|' ? left || right : left | right;
+    case '&':
+        return op[1] == '&' ? left && right : left & right;
+    case '^':
+        return left ^ right;
+    case '=':
+        return left == right;
+    case '!':
+        return left != right;
+    case '<':
+        return op[1] == '=' ? left <= right : op[1] == '<' ? left << right : left < right;
+    case '>':
+        return op[1] == '=' ? left >= right : op[1] == '>' ? left >> right : left > right;
+    case '+':
+        return left + right;
+    case '-':
+        return left - right;
+    case '*':
+        return left * right;
+    default:
+        if (right == 0)
+        {
+            ev->error = TRUE;
+            return 0;
+        }
+        return op[0] == '/' ? left / right : left % right;
+    }
+}
+
+/**
+ * @return Index in binary_ops of the operator at the current position, or
+ *         -1 if there is none.
+ */
+static int PeekBinary(evaluator *ev)
+{
+    int length;
+    int i;
+
+    ev->p = SkipBlanks(ev->p, ev->end);
+    for (i = 0; i < (int)(sizeof(binary_ops) / sizeof(binary_ops[0])); i++)
+    {
+        length = (int)strlen(binary_ops[i].op);
+        if (ev->end - ev->p >= length && memcmp(ev->p, binary_ops[i].op, length) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Evaluates a binary expression by precedence climbing.
+ */
+static long EvalBinary(evaluator *ev, int min_prec)
+{
+    long left = EvalPrimary(ev);
+    long right;
+    int i;
+
+    while (!ev->error && (i = PeekBinary(ev)) >= 0 && binary_ops[i].prec >= min_prec)
+    {
+        ev->p += strlen(binary_ops[i].op);
+        right = EvalBinary(ev, binary_ops[i].prec + 1);
+        left = Apply(ev, binary_ops[i].op, left, right);
+    }
+
+    return left;
+}
+
+static long EvalConditional(evaluator *ev)
+{
+    long condition = EvalBinary(ev, 1);
+    long then_value;
+    long else_value;
+
+    if (!Accept(ev, "?"))
+    {
+        return condition;
+    }
+
+    then_value = EvalConditional(ev);
+    if (!Accept(ev, ":"))
+    {
+        ev->error = TRUE;
+    }
+    else_value = EvalConditional(ev);
+
+    return condition ? then_value : else_value;
+}
+
+/**
+ * Evaluates the condition of an #if or #elif directive.
+ */
+static bool EvalCondition(preprocessor *pp, frame *fr, int line, const char *p, const char *end)
+{
+    buffer expr = {NULL, 0, 0};
+    evaluator ev;
+    const char *q;
+    bool parens;
+    bool value;
+
+    while (p < end)
+    {
+        q = SkipIdent(p, end);
+
+        if (q - p == 7 && memcmp(p, "defined", 7) == 0)
+        {
+            q = SkipBlanks(q, end);
+            parens = q < end && *q == '(';
+            p = SkipBlanks(parens ? q + 1 : q, end);
+            q = SkipIdent(p, end);
+            Append(&expr, FindMacro(pp, p, (int)(q - p)) != NULL ? " 1 " : " 0 ", 3);
+            q = parens ? SkipBlanks(q, end) + 1 : q;
+        }
+        else
+        {
+            q = p == q ? p + 1 : q;
+            while (q < end && !IS_ALPHA(*q))
+            {
+                q++;
+            }
+            Expand(pp, p, (int)(q - p), NULL, &expr);
+        }
+
+        p = q;
+    }
+
+    ev.p = expr.text;
+    ev.end = expr.text + expr.size;
+    ev.error = expr.size == 0;
+
+    value = EvalConditional(&ev) != 0;
+    if (ev.error || !IsBlankText(ev.p, ev.end))
+    {
+        CTIerrorLine(line, "%s: Invalid #if expression", fr->filename);
+        value = FALSE;
+    }
+
+    if (expr.text != NULL)
+    {
+        MEMfree(expr.text);
+    }
+
+    return value;
+}
+
+static bool IsActive(preprocessor *pp)
+{
+    return pp->cond_count == 0 || pp->conds[pp->cond_count - 1].active;
+}
+
+static void PushConditional(preprocessor *pp, bool value, int line)
+{
+    conditional *grown;
+    conditional *c;
+
+    if (pp->cond_count == pp->cond_capacity)
+    {
+        pp->cond_capacity = pp->cond_capacity == 0 ? 16 : 2 * pp->cond_capacity;
+        grown = MEMmalloc(pp->cond_capacity * sizeof(conditional));
+        if (pp->conds != NULL)
+        {
+            memcpy(grown, pp->conds, pp->cond_count * sizeof(conditional));
+            MEMfree(pp->conds);
+        }
+        pp->conds = grown;
+    }
+
+    c = &pp->conds[pp->cond_count];
+    c->outer = IsActive(pp);
+    c->active = c->outer && value;
+    c->taken = c->active;
+    c->seen_else = FALSE;
+    c->line = line;
+    pp->cond_count++;
+}
+
+/**
+ * Finds an include file. Quoted names are looked up next to the including
+ * file first, then in the -I directories.
+ *
+ * @return The path of the file, or NULL if there is none.
+ */
+static char *FindInclude(const frame *fr, const char *name, int length, bool quoted)
+{
+    const char *dir;
+    const char *next;
+    char *path;
+    struct stat st;
+    int dir_length;
+
+    if (name[0] == '/')
+    {
+        path = Copy(name, length);
+        if (stat(path, &st) == 0)
+        {
+            return path;
+        }
+        MEMfree(path);
+        return NULL;
+    }
+
+    dir = quoted ? fr->filename : myglobal.include_path;
+    while (dir != NULL)
+    {
+        if (quoted && dir == fr->filename)
+        {
+            next = strrchr(fr->filename, '/');
+            dir_length = next == NULL ? 0 : (int)(next - fr->filename) + 1;
+            next = myglobal.include_path;
+        }
+        else
+        {
+            next = strchr(dir, ':');
+            dir_length = next == NULL ? (int)strlen(dir) : (int)(next - dir);
+            next = next == NULL ? NULL : next + 1;
+        }
+
+        path = MEMmalloc(dir_length + length + 2);
+        memcpy(path, dir, dir_length);
+        if (dir_length > 0 && path[dir_length - 1] != '/')
+        {
+            path[dir_length++] = '/';
+        }
+        memcpy(path + dir_length, name, length);
+        path[dir_length + length] = '\0';
+
+        if (stat(path, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            return path;
+        }
+
+        MEMfree(path);
+        dir = next;
+    }
+
+    return NULL;
+}
+
+/**
+ * Looks up a file in the include cache, reading it if it is not cached or
+ * changed since.
+ *
+ * @return The cache entry, or NULL if the file cannot be read.
+ */
+static header *LoadHeader(const char *path)
+{
+    char *real;
+    header *hdr;
+    struct stat st;
+    FILE *file;
+
+    real = realpath(path, NULL);
+    if (real == NULL || stat(real, &st) != 0 || st.st_size > INT_MAX)
+    {
+        free(real);
+        return NULL;
+    }
+
+    for (hdr = headers; hdr != NULL; hdr = hdr->next)
+    {
+        if (strcmp(hdr->path, real) == 0)
+        {
+            break;
+        }
+    }
+
+    if (hdr != NULL && hdr->mtime == st.st_mtime && hdr->size == st.st_size)
+    {
+        free(real);
+        return hdr;
+    }
+
+    if (hdr == NULL)
+    {
+        hdr = MEMmalloc(sizeof(header));
+        hdr->path = Copy(real, (int)strlen(real));
+        hdr->text = NULL;
+        hdr->guard = NULL;
+        hdr->next = headers;
+        headers = hdr;
+    }
+    free(real);
+
+    if (hdr->text != NULL)
+    {
+        hdr->text = MEMfree(hdr->text);
+    }
+    if (hdr->guard != NULL)
+    {
+        hdr->guard = MEMfree(hdr->guard);
+    }
+
+    hdr->mtime = st.st_mtime;
+    hdr->size = st.st_size;
+    hdr->length = 0;
+    hdr->text = MEMmalloc(st.st_size + 1);
+
+    file = fopen(hdr->path, "rb");
+    if (file != NULL)
+    {
+        hdr->length = (int)fread(hdr->text, 1, st.st_size, file);
+        fclose(file);
+    }
+    else
+    {
+        /* Not readable: do not trust the entry next time. */
+        hdr->mtime = 0;
+        return NULL;
+    }
+
+    return hdr;
+}
+
+static void Include(preprocessor *pp, frame *fr, int line, const char *p, const char *end)
+{
+    const char *name;
+    char close;
+    char *path;
+    header *hdr;
+    frame sub;
+
+    p = SkipBlanks(p, end);
+    close = p < end && *p == '"' ? '"' : p < end && *p == '<' ? '>' : '\0';
+    name = p + 1;
+    p = close == '\0' ? NULL : memchr(name, close, end - name);
+
+    if (p == NULL || p == name)
+    {
+        CTIerrorLine(line, "%s: #include expects \"FILENAME\" or <FILENAME>", fr->filename);
+        return;
+    }
+
+    if (pp->depth >= MAX_INCLUDE_DEPTH)
+    {
+        CTIabort("%s: #include nested too deeply", fr->filename);
+    }
+
+    path = FindInclude(fr, name, (int)(p - name), close == '"');
+    if (path != NULL && myglobal.use_pch && PCHuse(path))
+    {
+        MEMfree(path);
+        return;
+    }
+
+    hdr = path == NULL ? NULL : LoadHeader(path);
+    if (path != NULL)
+    {
+        MEMfree(path);
+    }
+
+    if (hdr == NULL)
+    {
+        CTIerrorLine(line, "%s: Cannot find include file %.*s", fr->filename, (int)(p - name),
+                     name);
+        return;
+    }
+
+    if (hdr->guard != NULL && FindMacro(pp, hdr->guard, (int)strlen(hdr->guard)) != NULL)
+    {
+        return;
+    }
+
+    sub.filename = hdr->path;
+    sub.cursor = hdr->text;
+    sub.end = hdr->text + hdr->length;
+    sub.line = 1;
+    sub.in_comment = FALSE;
+    sub.base = pp->cond_count;
+    sub.guard_state = GUARD_start;
+    sub.guard = NULL;
+
+    pp->depth++;
+    ProcessFile(pp, &sub);
+    pp->depth--;
+
+    if (sub.guard_state == GUARD_closed && hdr->guard == NULL)
+    {
+        hdr->guard = sub.guard;
+    }
+    else if (sub.guard != NULL)
+    {
+        MEMfree(sub.guard);
+    }
+}
+
+/**
+ * Handles a directive, given the text after its '#' with comments removed.
+ */
+static void Directive(preprocessor *pp, frame *fr, int line, const char *p, const char *end)
+{
+    const char *name;
+    const char *body;
+    const char *q;
+    conditional *top = pp->cond_count > fr->base ? &pp->conds[pp->cond_count - 1] : NULL;
+    guardstate guard_state = fr->guard_state;
+    bool is_else;
+    int length;
+
+    fr->guard_state = guard_state == GUARD_open ? GUARD_open : GUARD_none;
+
+    p = SkipBlanks(p, end);
+    name = p;
+    p = SkipIdent(p, end);
+    length = (int)(p - name);
+    p = SkipBlanks(p, end);
+
+#define IS_DIRECTIVE(s) (length == (int)sizeof(s) - 1 && memcmp(name, s, length) == 0)
+
+    if (IS_DIRECTIVE("if"))
+    {
+        PushConditional(pp, IsActive(pp) && EvalCondition(pp, fr, line, p, end), line);
+    }
+    else if (IS_DIRECTIVE("ifdef") || IS_DIRECTIVE("ifndef"))
+    {
+        q = SkipIdent(p, end);
+        if (q == p)
+        {
+            CTIerrorLine(line, "%s: #%.*s expects a macro name", fr->filename, length, name);
+        }
+        PushConditional(pp, (FindMacro(pp, p, (int)(q - p)) != NULL) == (length == 5), line);
+
+        if (guard_state == GUARD_start && length == 6 && q > p)
+        {
+            fr->guard_state = GUARD_open;
+            fr->guard = Copy(p, (int)(q - p));
+        }
+    }
+    else if (IS_DIRECTIVE("elif") || IS_DIRECTIVE("else"))
+    {
+        if (top == NULL || top->seen_else)
+        {
+            CTIerrorLine(line, "%s: #%.*s without #if", fr->filename, length, name);
+            return;
+        }
+
+        is_else = name[2] == 's';
+        top->active = top->outer && !top->taken
+                      && (is_else || EvalCondition(pp, fr, line, p, end));
+        top->taken = top->taken || top->active;
+        top->seen_else = is_else;
+
+        if (pp->cond_count == fr->base + 1)
+        {
+            fr->guard_state = GUARD_none;
+        }
+    }
+    else if (IS_DIRECTIVE("endif"))
+    {
+        if (top == NULL)
+        {
+            CTIerrorLine(line, "%s: #endif without #if", fr->filename);
+            return;
+        }
+
+        pp->cond_count--;
+        if (guard_state == GUARD_open && pp->cond_count == fr->base)
+        {
+            fr->guard_state = GUARD_closed;
+        }
+    }
+    else if (!IsActive(pp) || length == 0 || IS_DIRECTIVE("pragma"))
+    {
+        /* Skipped, or without effect. */
+    }
+    else if (IS_DIRECTIVE("include"))
+    {
+        Include(pp, fr, line, p, end);
+    }
+    else if (IS_DIRECTIVE("define") || IS_DIRECTIVE("undef"))
+    {
+        q = SkipIdent(p, end);
+
+        if (q == p || IS_DIGIT(*p))
+        {
+            CTIerrorLine(line, "%s: #%.*s expects a macro name", fr->filename, length, name);
+        }
+        else if (length == 5)
+        {
+            Undefine(pp, p, (int)(q - p));
+        }
+        else if (q < end && *q == '(')
+        {
+            CTIerrorLine(line, "%s: Function-like macros are not supported", fr->filename);
+        }
+        else
+        {
+            body = SkipBlanks(q, end);
+            while (end > body && IS_BLANK(end[-1]))
+            {
+                end--;
+            }
+            Define(pp, p, (int)(q - p), body, (int)(end - body));
+        }
+    }
+    else if (IS_DIRECTIVE("error"))
+    {
+        CTIerrorLine(line, "%s: #error %.*s", fr->filename, (int)(end - p), p);
+    }
+    else
+    {
+        CTIerrorLine(line, "%s: Invalid preprocessing directive #%.*s", fr->filename, length,
+                     name);
+    }
+
+#undef IS_DIRECTIVE
+}
+
+/**
+ * Preprocesses the lines of a file, appending the output to pp->out.
+ */
+static void ProcessFile(preprocessor *pp, frame *fr)
+{
+    const char *start;
+    const char *eol;
+    const char *p;
+    int line;
+
+    while (fr->cursor < fr->end)
+    {
+        start = fr->cursor;
+        eol = memchr(start, '\n', fr->end - start);
+        eol = eol == NULL ? fr->end : eol;
+        line = fr->line;
+        pp->line.size = 0;
+
+        p = SkipBlanks(start, eol);
+        if (!fr->in_comment && p < eol && *p == '#')
+        {
+            /* A directive, possibly continued on following lines. */
+            p++;
+            while (eol > p && eol[-1] == '\\' && eol < fr->end)
+            {
+                StripComments(fr, p, eol - 1, &pp->line);
+                p = eol + 1;
+                eol = memchr(p, '\n', fr->end - p);
+                eol = eol == NULL ? fr->end : eol;
+                fr->line++;
+            }
+            StripComments(fr, p, eol, &pp->line);
+            Directive(pp, fr, line, pp->line.text, pp->line.text + pp->line.size);
+        }
+        else
+        {
+            StripComments(fr, start, eol, &pp->line);
+
+            if (!IsBlankText(pp->line.text, pp->line.text + pp->line.size))
+            {
+                if (fr->guard_state != GUARD_open)
+                {
+                    fr->guard_state = GUARD_none;
+                }
+
+                if (IsActive(pp))
+                {
+                    BeginLine(pp, line);
+                    Expand(pp, pp->line.text, pp->line.size, NULL, &pp->out);
+                    Append(&pp->out, "\n", 1);
+                }
+            }
+        }
+
+        fr->cursor = eol < fr->end ? eol + 1 : fr->end;
+        fr->line++;
+    }
+
+    if (fr->in_comment)
+    {
+        CTIabort("%s: Unterminated comment", fr->filename);
+    }
+
+    if (pp->cond_count > fr->base)
+    {
+        CTIerrorLine(pp->conds[pp->cond_count - 1].line, "%s: Unterminated #if",
+                     fr->filename);
+        pp->cond_count = fr->base;
+    }
+}
+
+/**
+ * Preprocesses the loaded source text, if it contains any directives, and
+ * replaces it with the result. Macros only live for one file; included
+ * files stay cached.
+ *
+ * @param filename Name of the input file, for diagnostics and for finding
+ *                 files included with quotes.
+ */
+void PPpreprocessSource(const char *filename)
+{
+    preprocessor pp;
+    frame main_file;
+    macro *m;
+    int i;
+
+    DBUG_ENTER("PPpreprocessSource");
+
+    if (memchr(SRCtext(), '#', SRCsize()) == NULL)
+    {
+        DBUG_VOID_RETURN;
+    }
+
+    memset(&pp, 0, sizeof(preprocessor));
+
+    main_file.filename = filename;
+    main_file.cursor = SRCtext();
+    main_file.end = SRCtext() + SRCsize();
+    main_file.line = 1;
+    main_file.in_comment = FALSE;
+    main_file.base = 0;
+    main_file.guard_state = GUARD_none;
+    main_file.guard = NULL;
+
+    ProcessFile(&pp, &main_file);
+
+    if (pp.line_count == 0)
+    {
+        BeginLine(&pp, 1);
+    }
+
+    Reserve(&pp.out, SRC_PADDING);
+    memset(pp.out.text + pp.out.size, 0, SRC_PADDING);
+
+    LOCsetLineMap(pp.starts, pp.lines, pp.line_count);
+    SRCreplaceText(pp.out.text, pp.out.size);
+
+    for (i = 0; i < MACRO_BUCKETS; i++)
+    {
+        while ((m = pp.macros[i]) != NULL)
+        {
+            pp.macros[i] = m->next;
+            MEMfree(m->name);
+            MEMfree(m->body);
+            MEMfree(m);
+        }
+    }
+    if (pp.line.text != NULL)
+    {
+        MEMfree(pp.line.text);
+    }
+    if (pp.conds != NULL)
+    {
+        MEMfree(pp.conds);
+    }
+
+    DBUG_VOID_RETURN;
+}
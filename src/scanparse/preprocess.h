@@ -0,0 +1,8 @@
+#ifndef _PREPROCESS_H_
+#define _PREPROCESS_H_
+
+#include "types.h"
+
+extern void PPpreprocessSource(const char *filename);
+
+#endif
@@ -0,0 +1,263 @@
+#include "source.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dbug.h"
+#include "memory.h"
+#include "names.h"
+
+/*
+ * Source text the scanner hands out slices of. When the whole input file is
+ * mapped or read into memory, text holds it and slices refer straight into
+ * it. Otherwise flex reads through its FILE* buffer, which it refills
+ * underneath us, so identifiers are appended to text as a pool instead.
+ */
+static char *text = NULL;
+static int size = 0;
+static int capacity = 0;
+static bool whole_source = FALSE;
+static size_t mapped_length = 0;
+
+/**
+ * Maps the given file into memory so the scanner can lex it in place.
+ * The mapping is followed by SRC_PADDING zero bytes.
+ *
+ * @param filename Path of the source file.
+ * @return TRUE if the file is mapped, FALSE if the caller should fall back
+ *         to buffered reading.
+ */
+bool SRCmapFile(const char *filename)
+{
+    int fd;
+    struct stat st;
+    size_t page;
+    size_t length;
+    char *base;
+
+    DBUG_ENTER("SRCmapFile");
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        DBUG_RETURN(FALSE);
+    }
+
+    if (fstat(fd, &st) != 0 || st.st_size == 0 || st.st_size > INT_MAX - SRC_PADDING)
+    {
+        close(fd);
+        DBUG_RETURN(FALSE);
+    }
+
+    page = (size_t)sysconf(_SC_PAGESIZE);
+    length = ((size_t)st.st_size + SRC_PADDING + page - 1) / page * page;
+
+    /*
+     * Reserve anonymous zero pages first and map the file over their start,
+     * so the padding exists even when the file ends on a page boundary.
+     * The mapping is private and writable because flex temporarily
+     * terminates yytext inside the buffer.
+     */
+    base = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        DBUG_RETURN(FALSE);
+    }
+
+    if (mmap(base, st.st_size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(base, length);
+        close(fd);
+        DBUG_RETURN(FALSE);
+    }
+
+    close(fd);
+    madvise(base, length, MADV_SEQUENTIAL);
+
+    SRCrelease();
+    text = base;
+    size = (int)st.st_size;
+    capacity = size;
+    whole_source = TRUE;
+    mapped_length = length;
+
+    DBUG_RETURN(TRUE);
+}
+
+/**
+ * Reads the given file into memory in one go, for scanners that need the
+ * whole source text. The text is followed by SRC_PADDING zero bytes.
+ *
+ * @param filename Path of the source file.
+ * @return TRUE if the file was read, FALSE otherwise.
+ */
+bool SRCreadFile(const char *filename)
+{
+    FILE *file;
+    long length;
+    char *buffer;
+
+    DBUG_ENTER("SRCreadFile");
+
+    file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        DBUG_RETURN(FALSE);
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < 0
+        || length > INT_MAX - SRC_PADDING || fseek(file, 0, SEEK_SET) != 0)
+    {
+        fclose(file);
+        DBUG_RETURN(FALSE);
+    }
+
+    buffer = MEMmalloc(length + SRC_PADDING);
+
+    if (fread(buffer, 1, length, file) != (size_t)length)
+    {
+        MEMfree(buffer);
+        fclose(file);
+        DBUG_RETURN(FALSE);
+    }
+
+    fclose(file);
+    memset(buffer + length, 0, SRC_PADDING);
+
+    SRCrelease();
+    text = buffer;
+    size = (int)length;
+    capacity = size;
+    whole_source = TRUE;
+
+    DBUG_RETURN(TRUE);
+}
+
+/**
+ * Replaces the source text with a rewritten version of it, such as the
+ * output of the preprocessor.
+ *
+ * @param buffer Text allocated with MEMmalloc and followed by SRC_PADDING
+ *               zero bytes. The source takes ownership of it.
+ * @param length Number of bytes of text, excluding the padding.
+ */
+void SRCreplaceText(char *buffer, int length)
+{
+    DBUG_ENTER("SRCreplaceText");
+
+    SRCrelease();
+    text = buffer;
+    size = length;
+    capacity = length;
+    whole_source = TRUE;
+
+    DBUG_VOID_RETURN;
+}
+
+/**
+ * @return Start of the current source text.
+ */
+char *SRCtext(void)
+{
+    return text;
+}
+
+/**
+ * @return Number of bytes of source text, excluding the padding.
+ */
+int SRCsize(void)
+{
+    return size;
+}
+
+/**
+ * Creates a slice for a token the scanner just matched. Tokens lexed from
+ * a fully loaded source are referenced in place; anything else is appended
+ * to the identifier pool, whose storage only grows geometrically.
+ *
+ * @param token Start of the matched text (yytext).
+ * @param length Length of the matched text (yyleng).
+ * @return Slice referring to the token text.
+ */
+slice SRCslice(const char *token, int length)
+{
+    slice s;
+    char *grown;
+
+    if (whole_source && token >= text && token + length <= text + size)
+    {
+        s.offset = (int)(token - text);
+        s.length = length;
+        return s;
+    }
+
+    if (size + length > capacity)
+    {
+        capacity = capacity == 0 ? 4096 : capacity;
+        while (size + length > capacity)
+        {
+            capacity *= 2;
+        }
+
+        grown = MEMmalloc(capacity);
+        if (text != NULL)
+        {
+            memcpy(grown, text, size);
+            text = MEMfree(text);
+        }
+        text = grown;
+    }
+
+    memcpy(text + size, token, length);
+    s.offset = size;
+    s.length = length;
+    size += length;
+
+    return s;
+}
+
+/**
+ * Resolves a slice to its interned name. Only the first occurrence of a
+ * name allocates.
+ *
+ * @param s Slice previously returned by SRCslice.
+ * @return The interned name of the slice text.
+ */
+char *SRCsliceName(slice s)
+{
+    return NAMEinternN(text + s.offset, s.length);
+}
+
+/**
+ * Unmaps the source file or frees the identifier pool. Slices handed out
+ * before are invalid afterwards.
+ */
+void SRCrelease(void)
+{
+    DBUG_ENTER("SRCrelease");
+
+    if (mapped_length > 0)
+    {
+        munmap(text, mapped_length);
+        mapped_length = 0;
+    }
+    else if (text != NULL)
+    {
+        text = MEMfree(text);
+    }
+
+    text = NULL;
+    size = 0;
+    capacity = 0;
+    whole_source = FALSE;
+
+    DBUG_VOID_RETURN;
+}
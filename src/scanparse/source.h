@@ -0,0 +1,24 @@
+#ifndef _SOURCE_H_
+#define _SOURCE_H_
+
+#include "types.h"
+
+/*
+ * Number of zero bytes following a fully loaded source text. Flex needs two
+ * of them as end-of-buffer sentinels; the fast lexer loads up to 32 bytes
+ * at a time and relies on the zeros to stop its scans.
+ */
+#define SRC_PADDING 32
+
+extern bool SRCmapFile(const char *filename);
+extern bool SRCreadFile(const char *filename);
+extern void SRCreplaceText(char *buffer, int length);
+extern char *SRCtext(void);
+extern int SRCsize(void);
+
+extern slice SRCslice(const char *token, int length);
+extern char *SRCsliceName(slice s);
+
+extern void SRCrelease(void);
+
+#endif
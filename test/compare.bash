@@ -0,0 +1,110 @@
+#!/usr/bin/env bash
+# Differential test: every test source must compile with the same exit
+# status, and to the same assembly, with two sets of flags. With bench as
+# first argument, times compiling a single file with each set instead.
+#
+#   bash compare.bash "<flags A>" "<flags B>" <dirs>
+#   bash compare.bash bench "<flags A>" "<flags B>" <file>
+#
+# COMPARE lists what must match besides the exit status: asm, the output
+# file (default), stdout and stderr.
+CIVCC=${CIVCC-../bin/civicc}
+CFLAGS=${CFLAGS-}
+COMPARE=${COMPARE-asm}
+RUNS=${RUNS-5}
+
+ALIGN=52
+
+total_tests=0
+failed_tests=0
+
+function echo_success {
+    echo -e '\E[27;32m'"\033[1mok\033[0m"
+}
+
+function echo_failed {
+    echo -e '\E[27;31m'"\033[1mfailed\033[0m"
+}
+
+# Compiles $2 with the flags $1, leaving the assembly, the standard output
+# and the standard error in tmp.$3.s, tmp.$3.stdout and tmp.$3.stderr.
+function compile {
+    $CIVCC $CFLAGS $1 -o tmp.$3.s $2 > tmp.$3.stdout 2> tmp.$3.stderr
+}
+
+function check_file {
+    file=$1
+
+    if [ ! -f $file ]; then return; fi
+
+    total_tests=$((total_tests+1))
+    printf "%-${ALIGN}s " $file:
+
+    compile "$FLAGS_A" $file a
+    a_status=$?
+    compile "$FLAGS_B" $file b
+    b_status=$?
+
+    same=1
+    [ $a_status -eq $b_status ] || same=0
+    rm -f tmp.out
+    for part in $COMPARE; do
+        case $part in
+            asm)
+                if [ -f tmp.a.s ] || [ -f tmp.b.s ]; then
+                    diff tmp.a.s tmp.b.s >> tmp.out 2>&1 || same=0
+                fi
+                ;;
+            *)
+                diff tmp.a.$part tmp.b.$part >> tmp.out 2>&1 || same=0
+                ;;
+        esac
+    done
+
+    if [ $same -eq 1 ]; then
+        echo_success
+    else
+        echo_failed
+        echo -------------------------------
+        echo "exit status: '$FLAGS_A' $a_status, '$FLAGS_B' $b_status"
+        cat tmp.out 2> /dev/null
+        echo -------------------------------
+        echo
+        failed_tests=$((failed_tests+1))
+    fi
+
+    rm -f tmp.a.* tmp.b.* tmp.out
+}
+
+# Prints the best of RUNS times of compiling $2 with the flags $1, in
+# milliseconds.
+function bench_file {
+    best=
+    for i in `seq $RUNS`; do
+        start=`date +%s%N`
+        compile "$1" $2 bench
+        end=`date +%s%N`
+        ms=$(((end - start) / 1000000))
+        if [ -z "$best" ] || [ $ms -lt $best ]; then best=$ms; fi
+    done
+    rm -f tmp.bench.s tmp.bench.stdout tmp.bench.stderr
+    printf "%-${ALIGN}s %6d ms\n" "'$1':" $best
+}
+
+if [ "$1" = "bench" ]; then
+    bench_file "$2" $4
+    bench_file "$3" $4
+    exit 0
+fi
+
+FLAGS_A=$1
+FLAGS_B=$2
+shift 2
+
+for arg in $@; do
+    for f in `find $arg -name \*.cvc`; do
+        check_file $f
+    done
+done
+
+echo $total_tests tests, $failed_tests failures
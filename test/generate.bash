@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+# Writes generated test programs to standard output.
+#
+#   bash generate.bash sources <MB> <dirs>   the test sources in <dirs>,
+#                                            repeated up to <MB> megabytes
+#   bash generate.bash statements <n>        main with <n> statements
+#   bash generate.bash functions <n>         <n> / 10 functions of ten
+#                                            statements and a global each
+#   bash generate.bash loops <n>             main with <n> nested for-loops,
+#                                            whose loop conditions are shared
+#                                            under -hashcons
+case $1 in
+    sources)
+        files=`find ${@:3} -name \*.cvc`
+        target=$(($2 * 1024 * 1024))
+        size=`cat $files | wc -c`
+        for bytes in `seq 0 $size $((target - 1))`; do
+            cat $files
+        done
+        ;;
+    statements)
+        awk -v n=$2 'BEGIN {
+            print "export int main() {"
+            print "    int x = 0;"
+            print "    bool b = false;"
+            for (i = 0; i < n; i++) print "    x = x * 2 + (b ? 1 : -1);"
+            print "    return x;"
+            print "}" }'
+        ;;
+    functions)
+        awk -v n=$2 'BEGIN {
+            for (f = 0; f < n / 10; f++) {
+                print "int g" f " = " f ";"
+                print "int f" f "() {"
+                print "    int x = g" f ";"
+                for (i = 0; i < 8; i++) print "    x = x * 2 + 1;"
+                print "    return x;"
+                print "}"
+            }
+            print "export int main() {"
+            print "    return 0;"
+            print "}" }'
+        ;;
+    loops)
+        awk -v n=$2 'BEGIN {
+            print "export int main() {"
+            print "    int x = 0;"
+            for (i = 0; i < n; i++) {
+                print "    for (int i = 0, 10) {"
+                print "        for (int j = i, 0, -1) {"
+                print "            x = x + i * j;"
+                print "        }"
+                print "    }"
+            }
+            print "    return x;"
+            print "}" }'
+        ;;
+    *)
+        echo "unknown program: $1" >&2
+        exit 1
+        ;;
+esac
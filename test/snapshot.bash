@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+# Compiles like civicc, except that with -snapshot-after <subphase> it writes
+# the snapshot next to the -o file and then compiles the snapshot to the -o
+# file, so that compare.bash can check restarting from a snapshot against
+# compiling directly. The input file must be the last argument.
+#
+#   CIVCC="bash snapshot.bash" bash compare.bash "" "-snapshot-after tc" <dirs>
+SNAPSHOT_CIVCC=${SNAPSHOT_CIVCC-../bin/civicc}
+
+flags=()
+point=
+out=a.out
+while [ $# -gt 1 ]; do
+    case $1 in
+        -snapshot-after) point=$2; shift 2 ;;
+        -o)              out=$2; shift 2 ;;
+        *)               flags+=("$1"); shift ;;
+    esac
+done
+file=$1
+
+if [ -z "$point" ]; then
+    exec $SNAPSHOT_CIVCC "${flags[@]}" -o $out $file
+fi
+
+$SNAPSHOT_CIVCC "${flags[@]}" -snapshot-after $point -o $out.snp $file
+status=$?
+if [ $status -eq 0 ]; then
+    $SNAPSHOT_CIVCC "${flags[@]}" -o $out $out.snp
+    status=$?
+fi
+rm -f $out.snp
+exit $status
@@ -0,0 +1,101 @@
+#!/usr/bin/env bash
+# Stress test for very long lists and deep expressions. Every program must
+# compile with a small C stack, and compiling ten times as many statements
+# must take about ten times as long, not a hundred.
+#
+#   bash stress.bash
+CIVCC=${CIVCC-../bin/civicc}
+CFLAGS=${CFLAGS-}
+SMALL=${SMALL-100000}
+LARGE=${LARGE-1000000}
+DEPTH=${DEPTH-100000}
+STACK_KB=${STACK_KB-1024}
+MAX_RATIO=${MAX_RATIO-20}
+
+ALIGN=52
+
+total_tests=0
+failed_tests=0
+
+function echo_success {
+    echo -e '\E[27;32m'"\033[1mok\033[0m"
+}
+
+function echo_failed {
+    echo -e '\E[27;31m'"\033[1mfailed\033[0m"
+}
+
+# A function with $1 assignments in a single statement list.
+function gen_statements {
+    echo "export int main() {"
+    echo "    int x = 0;"
+    awk -v n=$1 'BEGIN { for (i = 0; i < n; i++) print "    x = x + 1;" }'
+    echo "    return x;"
+    echo "}"
+}
+
+# A single expression of $1 left-nested additions and one of $1 chained
+# disjunctions.
+function gen_expressions {
+    echo "export int main() {"
+    echo "    int x = 1;"
+    echo "    bool b = false;"
+    awk -v n=$1 'BEGIN { printf "    x = x"; for (i = 0; i < n; i++) printf " + x"; print ";" }'
+    awk -v n=$1 'BEGIN { printf "    b = b"; for (i = 0; i < n; i++) printf " || b"; print ";" }'
+    echo "    return x;"
+    echo "}"
+}
+
+# Compiles $1 with a stack of STACK_KB kilobytes and prints the time taken
+# in milliseconds; fails if the compiler fails.
+function compile {
+    start=`date +%s%N`
+    ( ulimit -s $STACK_KB; $CIVCC $CFLAGS -o tmp.s $1 > /dev/null 2> tmp.out )
+    status=$?
+    end=`date +%s%N`
+
+    echo $(((end - start) / 1000000))
+    return $status
+}
+
+function report {
+    total_tests=$((total_tests+1))
+    printf "%-${ALIGN}s " "$1:"
+
+    if [ $2 -eq 0 ]; then
+        echo_success
+    else
+        echo_failed
+        echo -------------------------------
+        cat tmp.out
+        echo -------------------------------
+        echo
+        failed_tests=$((failed_tests+1))
+    fi
+}
+
+gen_statements $SMALL > tmp.small.cvc
+gen_statements $LARGE > tmp.large.cvc
+gen_expressions $DEPTH > tmp.deep.cvc
+
+small_ms=`compile tmp.small.cvc`
+report "$SMALL statements" $?
+
+large_ms=`compile tmp.large.cvc`
+report "$LARGE statements" $?
+
+compile tmp.deep.cvc > /dev/null
+report "expressions of depth $DEPTH" $?
+
+# Guard against timer resolution on fast machines.
+if [ $small_ms -lt 1 ]; then small_ms=1; fi
+
+ratio=$(((large_ms + small_ms - 1) / small_ms))
+limit=$((MAX_RATIO * LARGE / SMALL / 10))
+echo "ratio $ratio for ${small_ms}ms and ${large_ms}ms, at most $limit" > tmp.out
+[ $ratio -le $limit ]
+report "linear scaling" $?
+
+rm -f tmp.small.cvc tmp.large.cvc tmp.deep.cvc tmp.s tmp.out
+
+echo $total_tests tests, $failed_tests failures
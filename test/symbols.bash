@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+# Times the compilation of generated programs with 10 up to MAX symbols:
+# as many globals and functions, each used once from main. With constant
+# time symbol table lookups the time per symbol stays flat as the program
+# grows. Then times context analysis alone on a program with GLOBALS
+# globals, as the difference between breaking after it and after parsing.
+#
+#   bash symbols.bash
+CIVCC=${CIVCC-../bin/civicc}
+CFLAGS=${CFLAGS-}
+MAX=${MAX-100000}
+GLOBALS=${GLOBALS-50000}
+RUNS=${RUNS-3}
+
+ALIGN=52
+
+# A program with $1 globals, $1 functions that each read one of them, and a
+# main that calls all functions.
+function gen_symbols {
+    awk -v n=$1 'BEGIN {
+        for (i = 0; i < n; i++) {
+            print "int g" i " = " i ";"
+            print "int f" i "() {"
+            print "    return g" i ";"
+            print "}"
+        }
+        print "export int main() {"
+        print "    int x = 0;"
+        for (i = 0; i < n; i++) print "    x = x + f" i "();"
+        print "    return x;"
+        print "}" }'
+}
+
+# Prints the best of RUNS compile times of $2, a program with $1 symbols,
+# in milliseconds and in microseconds per symbol.
+function bench_symbols {
+    best=
+    for i in `seq $RUNS`; do
+        start=`date +%s%N`
+        $CIVCC $CFLAGS -o tmp.s $2 > /dev/null 2>&1
+        end=`date +%s%N`
+        us=$(((end - start) / 1000))
+        if [ -z "$best" ] || [ $us -lt $best ]; then best=$us; fi
+    done
+    printf "%-${ALIGN}s %8d ms %8d us/symbol\n" "$1 symbols:" $((best / 1000)) $((best / $1))
+}
+
+# Prints the best of RUNS times of compiling $2 up to the stage $1, in
+# milliseconds.
+function best_break {
+    best=
+    for i in `seq $RUNS`; do
+        start=`date +%s%N`
+        $CIVCC $CFLAGS -b$1 $2 > /dev/null 2>&1
+        end=`date +%s%N`
+        ms=$(((end - start) / 1000000))
+        if [ -z "$best" ] || [ $ms -lt $best ]; then best=$ms; fi
+    done
+    echo $best
+}
+
+n=10
+while [ $n -le $MAX ]; do
+    gen_symbols $n > tmp.symbols.cvc
+    bench_symbols $n tmp.symbols.cvc
+    n=$((n * 10))
+done
+
+awk -v n=$GLOBALS 'BEGIN {
+    for (i = 0; i < n; i++) print "int g" i " = " i ";"
+    print "export int main() {"
+    print "    return g0;"
+    print "}" }' > tmp.symbols.cvc
+parse_ms=`best_break ld:scp tmp.symbols.cvc`
+ca_ms=`best_break ac:ca tmp.symbols.cvc`
+printf "%-${ALIGN}s %8d ms\n" "context analysis, $GLOBALS globals:" $((ca_ms - parse_ms))
+
+rm -f tmp.symbols.cvc tmp.s